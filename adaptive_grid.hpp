@@ -0,0 +1,378 @@
+// adaptive_grid.hpp
+// Quadtree-adaptive wireframe for the spacetime-embedding grids.
+//
+// The square domain is a quadtree over an integer lattice of 2^maxDepth
+// cells per side.  Each leaf is judged by how badly a flat (bilinear) cell
+// approximates the height field: the height is sampled at the centre and at
+// the four edge midpoints and compared with the interpolated value.  Leaves
+// with the largest error are split first, and parents whose four leaf
+// children became flat are merged back, under a fixed leaf budget — so the
+// vertex count stays bounded and the resolution follows the wells.
+//
+// The tree persists between frames.  update() re-scores the current leaves,
+// then performs at most `maxOps` splits/merges, so it follows moving bodies
+// incrementally instead of rebuilding.  When the budget is exhausted, a leaf
+// can only be split after the flattest mergeable parent is collapsed.
+// updateAffected() re-scores only the cells a caller-supplied test says the
+// height change can reach; the others keep their score.
+//
+// Output is a unique-vertex list plus GL_LINES indices.  Edges of differently
+// sized neighbours are split at every lattice vertex lying on them, so there
+// are no T-junction cracks in the wireframe.
+//
+// No GL in here: callers upload vertices()/indices() themselves.
+
+#ifndef ADAPTIVE_GRID_HPP
+#define ADAPTIVE_GRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+class AdaptiveGrid {
+public:
+    // Domain [cx ± halfSize] × [cz ± halfSize].  tolerance is the height
+    // error (world units) below which a cell is considered flat.
+    AdaptiveGrid(float cx, float cz, float halfSize, size_t maxLeaves,
+                 float tolerance, int maxDepth = 10)
+        : originX(cx - halfSize), originZ(cz - halfSize),
+          maxDepth(std::min(maxDepth, 15)),
+          budget(std::max<size_t>(maxLeaves, 4)),
+          tol(tolerance) {
+        unit = 2.0f * halfSize / float(1u << this->maxDepth);
+        nodes.reserve(budget * 4 / 3 + 8);
+        nodes.push_back(Node());
+        nodes[0].size = 1u << this->maxDepth;
+        leaves = 1;
+    }
+
+    // Starts from a uniform grid of 2^depth cells per side (within budget).
+    template <class H>
+    void subdivideUniform(int depth, H&& height) {
+        for (int d = 0; d < depth; ++d) {
+            collectLeaves();
+            for (int32_t n : scratch)
+                if (leaves + 3 <= budget && nodes[n].depth < maxDepth) split(n, height);
+        }
+        topologyDirty = true;
+    }
+
+    // Re-scores leaves and applies at most maxOps splits/merges.
+    // Returns true when the topology changed (call buildSegments()).
+    template <class H>
+    bool update(H&& height, size_t maxOps = 512) {
+        return updateAffected(height, [](float, float, float, float) { return true; }, maxOps);
+    }
+
+    // Same, but only cells for which affected(x0, z0, x1, z1) holds are
+    // re-scored; it is asked about every node of the tree.  A cell's score
+    // depends only on the height at its corners, edge midpoints and centre.
+    // An internal node it flags is re-scored once it becomes mergeable.
+    template <class H, class A>
+    bool updateAffected(H&& height, A&& affected, size_t maxOps = 512) {
+        size_t ops = 0;
+        bool   changed = false;
+
+        // Re-score everything the height change may have affected.
+        markStale(affected);
+        collectLeaves();
+        for (int32_t n : scratch) rescore(n, height);
+        collectMergeable();
+        for (int32_t p : mergeable) rescore(p, height);
+        std::sort(mergeable.begin(), mergeable.end(),
+                  [&](int32_t a, int32_t b) { return nodes[a].err < nodes[b].err; });
+
+        // Parents that became flat give their leaves back.
+        size_t mi = 0;
+        for (; mi < mergeable.size() && ops < maxOps; ++mi) {
+            int32_t p = mergeable[mi];
+            if (nodes[p].err >= 0.5f * tol) break;
+            collapse(p);
+            ++ops;
+            changed = true;
+        }
+
+        // Split the worst leaves first; children are scored on creation, so
+        // a deep well is refined several levels in a single call.
+        std::priority_queue<Entry> heap;
+        collectLeaves();
+        for (int32_t n : scratch)
+            if (nodes[n].err > tol && nodes[n].depth < maxDepth)
+                heap.push({ nodes[n].err, n, nodes[n].stamp });
+
+        while (!heap.empty() && ops < maxOps) {
+            Entry e = heap.top();
+            heap.pop();
+            Node& leaf = nodes[e.node];
+            if (!leaf.alive || leaf.child >= 0 || leaf.stamp != e.stamp) continue;
+
+            if (leaves + 3 > budget) {
+                // Budget full: trade the flattest mergeable parent, if it is
+                // clearly less useful than this leaf.
+                int32_t victim = -1;
+                for (; mi < mergeable.size(); ++mi) {
+                    int32_t p = mergeable[mi];
+                    if (!isMergeable(p) || p == leaf.parent) continue;
+                    if (nodes[p].err * 2.0f < e.err) victim = p;
+                    break;
+                }
+                if (victim < 0) break;
+                ++mi;
+                collapse(victim);
+                ++ops;
+            }
+
+            split(e.node, height);
+            ++ops;
+            changed = true;
+            for (int k = 0; k < 4; ++k) {
+                int32_t c = nodes[e.node].child + k;
+                if (nodes[c].err > tol && nodes[c].depth < maxDepth)
+                    heap.push({ nodes[c].err, c, nodes[c].stamp });
+            }
+        }
+
+        topologyDirty |= changed;
+        return changed;
+    }
+
+    // Rebuilds the unique vertices and line indices from the current leaves.
+    void buildSegments() {
+        collectLeaves();
+        edges.clear();
+        for (int32_t n : scratch) {
+            const Node& c = nodes[n];
+            edges.push_back({ 0, c.iz,          c.ix, c.ix + c.size });   // along x
+            edges.push_back({ 0, c.iz + c.size, c.ix, c.ix + c.size });
+            edges.push_back({ 1, c.ix,          c.iz, c.iz + c.size });   // along z
+            edges.push_back({ 1, c.ix + c.size, c.iz, c.iz + c.size });
+        }
+        std::sort(edges.begin(), edges.end());
+
+        lattice.clear();
+        vertexKeys.clear();
+        lineIndices.clear();
+
+        size_t g = 0;
+        while (g < edges.size()) {
+            // One grid line: every edge endpoint on it becomes a vertex.
+            size_t end = g;
+            points.clear();
+            while (end < edges.size() && edges[end].axis == edges[g].axis && edges[end].line == edges[g].line) {
+                points.push_back(edges[end].a);
+                points.push_back(edges[end].b);
+                ++end;
+            }
+            std::sort(points.begin(), points.end());
+            points.erase(std::unique(points.begin(), points.end()), points.end());
+
+            // Walk merged coverage intervals, emitting point-to-point segments.
+            size_t e = g, p = 0;
+            while (e < end) {
+                uint32_t lo = edges[e].a, hi = edges[e].b;
+                while (++e < end && edges[e].a <= hi) hi = std::max(hi, edges[e].b);
+                while (p < points.size() && points[p] < lo) ++p;
+                for (; p + 1 < points.size() && points[p + 1] <= hi; ++p) {
+                    uint32_t axis = edges[g].axis, line = edges[g].line;
+                    uint32_t v0 = axis == 0 ? vertexAt(points[p], line) : vertexAt(line, points[p]);
+                    uint32_t v1 = axis == 0 ? vertexAt(points[p + 1], line) : vertexAt(line, points[p + 1]);
+                    lineIndices.push_back(v0);
+                    lineIndices.push_back(v1);
+                }
+            }
+            g = end;
+        }
+
+        xyz.resize(vertexKeys.size() * 3);
+        for (size_t v = 0; v < vertexKeys.size(); ++v) {
+            xyz[v * 3 + 0] = originX + float(vertexKeys[v] >> 16) * unit;
+            xyz[v * 3 + 2] = originZ + float(vertexKeys[v] & 0xFFFFu) * unit;
+        }
+        topologyDirty = false;
+    }
+
+    // Fills the y component of every vertex.
+    template <class H>
+    void evaluateHeights(H&& height) {
+        for (size_t v = 0; v < xyz.size(); v += 3)
+            xyz[v + 1] = height(xyz[v], xyz[v + 2]);
+    }
+
+    // Same, from heights computed elsewhere (one per vertex, in vertex order).
+    void setHeights(const float* y) {
+        for (size_t v = 0; v < xyz.size() / 3; ++v) xyz[v * 3 + 1] = y[v];
+    }
+
+    bool                         needsSegments() const { return topologyDirty; }
+    size_t                       leafCount()     const { return leaves; }
+    size_t                       vertexCount()   const { return xyz.size() / 3; }
+    const std::vector<float>&    vertices()      const { return xyz; }
+    const std::vector<uint32_t>& indices()       const { return lineIndices; }
+
+private:
+    struct Node {
+        int32_t  child  = -1;     // first of 4 consecutive children, -1 = leaf
+        int32_t  parent = -1;
+        uint32_t ix = 0, iz = 0;  // lattice origin
+        uint32_t size  = 0;       // lattice cells per side
+        uint16_t depth = 0;
+        bool     alive = true;
+        uint32_t stamp = 0;       // bumped on reuse, invalidates stale heap entries
+        float    err   = 0.0f;
+        bool     stale = false;   // err predates a height change that reached the cell
+    };
+
+    struct Entry {
+        float    err;
+        int32_t  node;
+        uint32_t stamp;
+        bool operator<(const Entry& o) const { return err < o.err; }
+    };
+
+    struct Edge {
+        uint32_t axis, line, a, b;
+        bool operator<(const Edge& o) const {
+            if (axis != o.axis) return axis < o.axis;
+            if (line != o.line) return line < o.line;
+            return a < o.a;
+        }
+    };
+
+    float wx(uint32_t ix) const { return originX + float(ix) * unit; }
+    float wz(uint32_t iz) const { return originZ + float(iz) * unit; }
+
+    // Largest deviation of the height field from the bilinear cell.
+    template <class H>
+    float cellError(const Node& c, H& height) const {
+        float x0 = wx(c.ix), x1 = wx(c.ix + c.size), xm = 0.5f * (x0 + x1);
+        float z0 = wz(c.iz), z1 = wz(c.iz + c.size), zm = 0.5f * (z0 + z1);
+        float h00 = height(x0, z0), h10 = height(x1, z0);
+        float h01 = height(x0, z1), h11 = height(x1, z1);
+        float e = std::fabs(height(xm, zm) - 0.25f * (h00 + h10 + h01 + h11));
+        e = std::max(e, std::fabs(height(xm, z0) - 0.5f * (h00 + h10)));
+        e = std::max(e, std::fabs(height(xm, z1) - 0.5f * (h01 + h11)));
+        e = std::max(e, std::fabs(height(x0, zm) - 0.5f * (h00 + h01)));
+        e = std::max(e, std::fabs(height(x1, zm) - 0.5f * (h10 + h11)));
+        return std::isfinite(e) ? e : 0.0f;
+    }
+
+    template <class H>
+    void rescore(int32_t n, H& height) {
+        if (!nodes[n].stale) return;
+        nodes[n].err   = cellError(nodes[n], height);
+        nodes[n].stale = false;
+    }
+
+    // Flags every node of the tree the height change reaches.
+    template <class A>
+    void markStale(A& affected) {
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            Node& c = nodes[stack.back()];
+            stack.pop_back();
+            if (affected(wx(c.ix), wz(c.iz), wx(c.ix + c.size), wz(c.iz + c.size))) c.stale = true;
+            if (c.child >= 0)
+                for (int k = 0; k < 4; ++k) stack.push_back(c.child + k);
+        }
+    }
+
+    template <class H>
+    void split(int32_t n, H& height) {
+        int32_t first;
+        if (!freeBlocks.empty()) {
+            first = freeBlocks.back();
+            freeBlocks.pop_back();
+        } else {
+            first = int32_t(nodes.size());
+            nodes.resize(nodes.size() + 4);
+        }
+        Node     parent = nodes[n];
+        uint32_t half   = parent.size / 2;
+        for (int k = 0; k < 4; ++k) {
+            Node& c  = nodes[first + k];
+            uint32_t stamp = c.stamp + 1;
+            c        = Node();
+            c.stamp  = stamp;
+            c.parent = n;
+            c.depth  = uint16_t(parent.depth + 1);
+            c.size   = half;
+            c.ix     = parent.ix + ((k & 1) ? half : 0);
+            c.iz     = parent.iz + ((k & 2) ? half : 0);
+            c.err    = cellError(c, height);
+        }
+        nodes[n].child = first;
+        leaves += 3;
+    }
+
+    void collapse(int32_t p) {
+        int32_t first = nodes[p].child;
+        for (int k = 0; k < 4; ++k) nodes[first + k].alive = false;
+        freeBlocks.push_back(first);
+        nodes[p].child = -1;
+        nodes[p].stamp++;
+        leaves -= 3;
+    }
+
+    bool isMergeable(int32_t p) const {
+        const Node& n = nodes[p];
+        if (!n.alive || n.child < 0) return false;
+        for (int k = 0; k < 4; ++k)
+            if (nodes[n.child + k].child >= 0) return false;
+        return true;
+    }
+
+    void collectLeaves() {
+        scratch.clear();
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            int32_t n = stack.back();
+            stack.pop_back();
+            if (nodes[n].child < 0) { scratch.push_back(n); continue; }
+            for (int k = 3; k >= 0; --k) stack.push_back(nodes[n].child + k);
+        }
+    }
+
+    void collectMergeable() {
+        mergeable.clear();
+        for (int32_t n : scratch) {
+            int32_t p = nodes[n].parent;
+            // Each parent is reached through its first child only.
+            if (p >= 0 && nodes[p].child == n && isMergeable(p)) mergeable.push_back(p);
+        }
+    }
+
+    uint32_t vertexAt(uint32_t ix, uint32_t iz) {
+        uint32_t key = (ix << 16) | iz;
+        auto it = lattice.find(key);
+        if (it != lattice.end()) return it->second;
+        uint32_t idx = uint32_t(vertexKeys.size());
+        lattice.emplace(key, idx);
+        vertexKeys.push_back(key);
+        return idx;
+    }
+
+    float  originX, originZ, unit = 1.0f;
+    int    maxDepth;
+    size_t budget;
+    float  tol;
+    size_t leaves = 0;
+    bool   topologyDirty = true;
+
+    std::vector<Node>    nodes;        // flat pool, children in blocks of 4
+    std::vector<int32_t> freeBlocks;
+    std::vector<int32_t> scratch, stack, mergeable;
+
+    std::vector<Edge>                      edges;
+    std::vector<uint32_t>                  points;
+    std::unordered_map<uint32_t, uint32_t> lattice;
+    std::vector<uint32_t>                  vertexKeys;
+    std::vector<float>                     xyz;
+    std::vector<uint32_t>                  lineIndices;
+};
+
+#endif // ADAPTIVE_GRID_HPP
@@ -1,8 +1,10 @@
 #include "common.hpp"
 #include "physics_asm.hpp"  
+#include "lensing.hpp"
+#include "lensing_recorder.hpp"
+#include <cstdint>
 
 // déclarations forward pcq sinon le compilo rage
-struct Ray;
 struct BlackHole;
 struct Engine;
 
@@ -11,7 +13,6 @@ const double G = GRAVITATIONAL_CONSTANT;
 const double c = SPEED_OF_LIGHT;
 
 // variables globales pcq flemme de refactoriser proprement mdr
-std::vector<Ray> rays;
 Engine* enginePtr = nullptr;
 
 // le trou noir, attention ça aspire tout
@@ -41,67 +42,173 @@ struct BlackHole {
 
 BlackHole SagA(glm::vec3(0.0f, 0.0f, 0.0f), 8.54e36f); // Sagittarius A*, le monstre au centre de notre galaxie
 
-// rayons de lumière qui se font courber grave par la gravité
-struct Ray {
-    // coords cartésiennes, tranquille
-    double x, y;
-    // coords polaires pour faire stylé
-    double r, phi;
-    double dr, dphi;
-    std::vector<glm::vec2> trail; // la trainée qu'on laisse derrière nous
-    double E, L;                   // grandeurs conservées (normalement)
-
-    Ray(glm::vec2 pos, glm::vec2 dir) : x(pos.x), y(pos.y) {
-        // ⚡ ASSEMBLY-OPTIMIZED: Fast distance calculation
-        float distSq = PhysicsASM::DistanceSquared(x, y, 0.0f, 0.0f, 0.0f, 0.0f);
-        this->r = std::sqrt(distSq);  // conversion en polaire
-        this->phi = atan2(y, x);
-
-        // initialisation des vitesses
-        dr = dir.x * cos(phi) + dir.y * sin(phi);
-        dphi = (-dir.x * sin(phi) + dir.y * cos(phi)) / r;
-
-        // quantités conservées selon la relativité générale
-        L = r*r * dphi;
-        double f = 1.0 - SagA.r_s/r;
-        double dt_dλ = sqrt((dr*dr)/(f*f) + (r*r*dphi*dphi)/f);
-        E = f * dt_dλ;
-
-        // on commence la traînée
-        trail.push_back(glm::vec2(x, y));
+// TRAÎNÉES DES RAYONS (mémoire et temps de frame constants, même après des heures)
+// Anneau de `capacity` lignes dans un seul VBO : la ligne s contient l'échantillon s de chaque rayon
+// (indexé par son id), tel que LensingRecorder le produit. Chaque ligne est envoyée une seule fois, écrite
+// deux fois (ligne s et s + capacity), donc la fenêtre des derniers points d'un rayon est toujours
+// contiguë dans l'index buffer statique : une strip par rayon, tous les rayons en un glMultiDrawElements.
+// L'anneau garde de l'avance sur la lecture (au plus `ahead` lignes) et le reste sert d'historique : revenir
+// en arrière ne fait que déplacer la tête de lecture. La tête de chaque rayon est interpolée dans le
+// shader entre la ligne courante et la suivante (deux attributs sur le même VBO, décalés d'une ligne).
+// Un rayon mort (capturé ou parti) garde sa traînée figée sur son dernier échantillon.
+// Contexte de compatibilité (glOrtho, immédiat ailleurs) : GLSL 1.20, VBO GL 1.5, pas de VAO.
+constexpr int    TRAIL_LENGTH        = 2048;      // points par traînée (au plus)
+constexpr int    TRAIL_HISTORY       = 16384;     // lignes gardées dans le VBO (au plus)
+constexpr size_t TRAIL_VERTEX_BUDGET = 1u << 22;  // sommets du VBO (2 × capacity × rayons) : ~48 Mo
+
+struct RayTrails {
+    struct Vertex { float x, y, seq; };
+
+    GLuint vbo = 0, ibo = 0;
+    ShaderProgram program;
+    GLint  aTrailLoc = -1, aNextLoc = -1;
+    GLint  uNewestLoc = -1, uCountLoc = -1, uHeadsLoc = -1, uFracLoc = -1;
+    size_t rays = 0;
+    int    capacity = 0, length = 0, ahead = 0;
+    uint64_t uploaded = 0;                  // lignes envoyées (échantillons 0 … uploaded - 1)
+    std::vector<uint64_t> deathSample;      // dernier échantillon d'un rayon mort, UINT64_MAX s'il vit
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+
+    void init(size_t numRays) {
+        if (!GLEW_VERSION_2_0) {
+            std::cerr << "OpenGL 2.0 required for the ray trails" << std::endl; // pas de shaders, pas de traînées
+            exit(EXIT_FAILURE);
+        }
+        const char* vertexSource = R"(
+        #version 120
+        #define SEQ_WRAP 8388608.0
+        attribute vec3 aTrail;                 // x, y, numéro de l'échantillon
+        attribute vec2 aNext;                  // même rayon, échantillon suivant (têtes)
+        uniform float uNewest;                 // échantillon affiché
+        uniform float uCount;                  // points dans la traînée d'un rayon vivant
+        uniform float uHeads;                  // 1 = on dessine juste la tête de chaque rayon
+        uniform float uFrac;                   // position entre les deux échantillons
+        varying vec4 vColor;
+        void main() {
+            float age = mod(uNewest - aTrail.z + SEQ_WRAP, SEQ_WRAP);        // 0 = point le plus récent
+            float alpha = uCount > 1.0 ? 1.0 - age / (uCount - 1.0) : 1.0;    // alpha qui augmente au fil du temps
+            vColor = uHeads > 0.5 ? vec4(1.0, 0.0, 0.0, 1.0) : vec4(1.0, 1.0, 1.0, max(alpha, 0.05));
+            gl_Position = gl_ModelViewProjectionMatrix * vec4(mix(aTrail.xy, aNext, uFrac), 0.0, 1.0);
+        })";
+        const char* fragmentSource = R"(
+        #version 120
+        varying vec4 vColor;
+        void main() {
+            gl_FragColor = vColor;
+        })";
+        program.reset(ShaderUtils::CreateProgram(vertexSource, fragmentSource));
+        aTrailLoc = glGetAttribLocation(program, "aTrail");
+        aNextLoc = glGetAttribLocation(program, "aNext");
+        uNewestLoc = program.uniform("uNewest");
+        uCountLoc = program.uniform("uCount");
+        uHeadsLoc = program.uniform("uHeads");
+        uFracLoc = program.uniform("uFrac");
+
+        // Avec beaucoup de rayons l'historique et les traînées raccourcissent, la mémoire reste dans le budget
+        rays = numRays;
+        capacity = int(std::max<size_t>(4, std::min<size_t>(TRAIL_HISTORY, TRAIL_VERTEX_BUDGET / (2 * std::max<size_t>(1, rays)))));
+        length = std::min(TRAIL_LENGTH, capacity / 2);
+        ahead = std::max(1, (capacity - length) / 2);      // l'autre moitié reste pour revenir en arrière
+        uploaded = 0;
+        deathSample.assign(rays, UINT64_MAX);
+        counts.resize(rays);
+        offsets.resize(rays);
+
+        // Index statique : le rayon i parcourt la colonne i des 2 × capacity lignes
+        std::vector<GLuint> indices(2 * size_t(capacity) * rays);
+        for (size_t i = 0; i < rays; ++i)
+            for (size_t k = 0; k < 2 * size_t(capacity); ++k)
+                indices[i * 2 * capacity + k] = GLuint(k * rays + i);
+        glGenBuffers(1, &ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, 2 * GLsizeiptr(capacity) * rays * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    void draw() {
-        // dessine la position actuelle
-        glPointSize(2.0f);
-        glColor3f(1.0f, 0.0f, 0.0f);
-        glBegin(GL_POINTS);
-        glVertex2f(x, y);
-        glEnd();
+    // Plus vieil échantillon encore dans le VBO
+    uint64_t oldest() const { return uploaded > uint64_t(capacity) ? uploaded - capacity : 0; }
+
+    // La ligne suivante peut-elle être envoyée sans écraser ce qu'on affiche au temps t ?
+    bool wants(double t) const { return uploaded <= uint64_t(std::max(0.0, t)) + uint64_t(ahead); }
+
+    void upload(const LensingRecorder::Row& row) {
+        GLsizeiptr bytes = GLsizeiptr(rays * sizeof(Vertex));
+        int slot = int(uploaded % uint64_t(capacity));
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, GLintptr(slot) * bytes, bytes, row.xyz.data());
+        glBufferSubData(GL_ARRAY_BUFFER, GLintptr(slot + capacity) * bytes, bytes, row.xyz.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        for (uint32_t id : row.died) deathSample[id] = uploaded;
+        ++uploaded;
+    }
 
-        // dessine la traînée avec fade out progressif
-        size_t N = trail.size();
-        if (N >= 2) {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glLineWidth(1.0f);
-
-            glBegin(GL_LINE_STRIP);
-            for (size_t i = 0; i < N; ++i) {
-                // alpha qui augmente au fil du temps
-                float alpha = float(i) / float(N - 1);
-                glColor4f(1.0f, 1.0f, 1.0f, std::max(alpha, 0.05f));
-                glVertex2f(trail[i].x, trail[i].y);
-            }
-            glEnd();
-
-            glDisable(GL_BLEND);
+    // Traînées jusqu'à l'échantillon floor(t) en un appel, puis les têtes interpolées en un autre
+    void draw(double t) {
+        if (!uploaded) return;
+        uint64_t now  = uint64_t(t);
+        float    frac = float(t - double(now));
+        uint64_t first = oldest();
+        for (size_t i = 0; i < rays; ++i) {
+            uint64_t end = std::min(now, deathSample[i]);
+            uint64_t start = std::max(first, end + 1 >= uint64_t(length) ? end + 1 - length : 0);
+            GLsizei  n = end >= start ? GLsizei(end - start + 1) : 0;
+            counts[i]  = n >= 2 ? n : 0;
+            offsets[i] = reinterpret_cast<const void*>((i * 2 * capacity + start % capacity) * sizeof(GLuint));
         }
+
+        GLsizei  row  = GLsizei(rays * sizeof(Vertex));
+        uint64_t slot = now % uint64_t(capacity);
+        bool     next = now + 1 < uploaded;
+
+        glUseProgram(program);
+        glUniform1f(uNewestLoc, float(now % LensingRecorder::SEQ_WRAP));
+        glUniform1f(uCountLoc, float(std::min<uint64_t>(uint64_t(length), now + 1)));
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glEnableVertexAttribArray(aTrailLoc);
+        glEnableVertexAttribArray(aNextLoc);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        glVertexAttribPointer(aTrailLoc, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glVertexAttribPointer(aNextLoc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);   // uFrac = 0 : ignoré
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glLineWidth(1.0f);
+        glUniform1f(uHeadsLoc, 0.0f);
+        glUniform1f(uFracLoc, 0.0f);
+        glMultiDrawElements(GL_LINE_STRIP, counts.data(), GL_UNSIGNED_INT, offsets.data(), GLsizei(rays));
+        glDisable(GL_BLEND);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        // Ligne slot + 1 existe toujours grâce au miroir ; si l'échantillon suivant n'est pas encore là, frac = 0
+        glVertexAttribPointer(aTrailLoc, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(slot * row));
+        glVertexAttribPointer(aNextLoc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)((slot + 1) * row));
+        glPointSize(2.0f);
+        glUniform1f(uHeadsLoc, 1.0f);
+        glUniform1f(uFracLoc, next ? frac : 0.0f);
+        glDrawArrays(GL_POINTS, 0, GLsizei(rays));
+
+        glDisableVertexAttribArray(aTrailLoc);   // pas de VAO : on rend l'état au mode immédiat
+        glDisableVertexAttribArray(aNextLoc);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glUseProgram(0);
     }
 
-    void step(double dλ, double rs);
+    void release() {
+        if (vbo) glDeleteBuffers(1, &vbo);
+        if (ibo) glDeleteBuffers(1, &ibo);
+        if (program) glDeleteProgram(program);
+        vbo = ibo = 0;
+    }
 };
 
+RayTrails trails;
+
 // moteur de rendu, c'est là que la magie opère
 struct Engine {
     GLFWwindow* window;
@@ -168,73 +275,39 @@ struct Engine {
     }
 };
 
-// fonctions physiques
-void geodesicRHS(const Ray& ray, double rhs[4], double rs) {
-    double r = ray.r;
-    double dr = ray.dr;
-    double dphi = ray.dphi;
-    double E = ray.E;
-
-    double f = 1.0 - rs/r; // facteur métrique de Schwarzschild
-
-    // dérivées première, tranquille
-    rhs[0] = dr;
-    rhs[1] = dphi;
-
-    // dérivée seconde de r selon les géodésiques nulles (équation de taré)
-    double dt_dλ = E / f;
-    rhs[2] =
-        - (rs/(2*r*r)) * f * (dt_dλ*dt_dλ)
-        + (rs/(2*r*r*f)) * (dr*dr)
-        + (r - rs) * (dphi*dphi);
-
-    // dérivée seconde de phi
-    rhs[3] = -2.0 * dr * dphi / r;
-}
-
-void addState(const double a[4], const double b[4], double factor, double out[4]) {
-    for (int i = 0; i < 4; i++)
-        out[i] = a[i] + b[i] * factor;
-}
-
-void rk4Step(Ray& ray, double dλ, double rs) {
-    double y0[4] = { ray.r, ray.phi, ray.dr, ray.dphi };
-    double k1[4], k2[4], k3[4], k4[4], temp[4];
-
-    geodesicRHS(ray, k1, rs);
-    addState(y0, k1, dλ/2.0, temp);
-    Ray r2 = ray; r2.r=temp[0]; r2.phi=temp[1]; r2.dr=temp[2]; r2.dphi=temp[3];
-    geodesicRHS(r2, k2, rs);
-
-    addState(y0, k2, dλ/2.0, temp);
-    Ray r3 = ray; r3.r=temp[0]; r3.phi=temp[1]; r3.dr=temp[2]; r3.dphi=temp[3];
-    geodesicRHS(r3, k3, rs);
-
-    addState(y0, k3, dλ, temp);
-    Ray r4 = ray; r4.r=temp[0]; r4.phi=temp[1]; r4.dr=temp[2]; r4.dphi=temp[3];
-    geodesicRHS(r4, k4, rs);
-
-    ray.r    += (dλ/6.0)*(k1[0] + 2*k2[0] + 2*k3[0] + k4[0]);
-    ray.phi  += (dλ/6.0)*(k1[1] + 2*k2[1] + 2*k3[1] + k4[1]);
-    ray.dr   += (dλ/6.0)*(k1[2] + 2*k2[2] + 2*k3[2] + k4[2]);
-    ray.dphi += (dλ/6.0)*(k1[3] + 2*k2[3] + 2*k3[3] + k4[3]);
-}
-
-void Ray::step(double dλ, double rs) {
-    // 1) on intègre (r,φ,dr,dφ)
-    if(r <= rs) return; // on arrête si on est dans l'horizon des événements (RIP le rayon)
-    rk4Step(*this, dλ, rs);
-
-    // 2) on reconvertit en coordonnées cartésiennes x,y
-    x = r * cos(phi);
-    y = r * sin(phi);
+// Options de ligne de commande
+struct Options {
+    size_t rays = 15;             // --rays N
+    std::string source = "beam";  // --source beam|fan|point
+    int substeps = 1;             // --substeps K : pas RK4 de dλ = 1 par échantillon
+    double speed = 60.0;          // --speed S : échantillons affichés par seconde
+};
 
-    // 3) on enregistre la traînée
-    trail.push_back(glm::vec2(float(x), float(y)));
+Options ParseArgs(int argc, char* argv[]) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasNext = i + 1 < argc;
+        if (a == "--rays" && hasNext) o.rays = size_t(std::max(1L, std::atol(argv[++i])));
+        else if (a == "--source" && hasNext) o.source = argv[++i];
+        else if (a == "--substeps" && hasNext) o.substeps = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--speed" && hasNext) o.speed = std::max(0.01, std::atof(argv[++i]));
+        else {
+            std::cerr << "Option inconnue : " << a << "\n"
+                      << "Usage : BlackHole_curv [--rays N] [--source beam|fan|point] [--substeps K] [--speed S]" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (o.source != "beam" && o.source != "fan" && o.source != "point") {
+        std::cerr << "Source inconnue : " << o.source << " (beam, fan ou point)" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return o;
 }
 
 // Fonction principale (let's gooo)
-int main() {
+int main(int argc, char* argv[]) {
+    Options opt = ParseArgs(argc, argv);
     Engine engine;
     enginePtr = &engine;
 
@@ -248,29 +321,78 @@ int main() {
         }
     });
 
-    // On initialise les rayons à différentes hauteurs pour voir la lentille gravitationnelle (trop stylé)
+    // On initialise les rayons pour voir la lentille gravitationnelle (trop stylé)
+    // beam : faisceau parallèle (15 rayons espacés de 1e10 m par défaut), fan : éventail pointé sur le trou,
+    // point : source isotrope. Avec 10^4–10^5 rayons on voit les caustiques et l'anneau de photons.
     double startX = -8e10;  // Position de départ (côté gauche)
-    int numRays = 15;       // Nombre de rayons de lumière
-    double spacing = 1e10;  // Espacement vertical entre les rayons
-
-    for (int i = 0; i < numRays; i++) {
-        double offsetY = (i - numRays/2.0) * spacing;  // On centre les rayons verticalement
-        rays.push_back(Ray(glm::vec2(startX, offsetY), glm::vec2(c, 0.0)));
-    }
-
+    double height = 15e10;  // Hauteur couverte par le faisceau
+    LensingRays rays;
+    rays.reset(SagA.r_s, 20.0 * engine.width);   // au-delà de 20 largeurs de vue un rayon ne revient plus
+    if (opt.source == "beam")     rays.seedBeam(opt.rays, startX, height, c);
+    else if (opt.source == "fan") rays.seedFan(opt.rays, startX, 0.0, 0.75, c);
+    else                          rays.seedPoint(opt.rays, startX, 0.0, c);
+
+    // L'intégration tourne dans son thread, l'affichage relit les échantillons à sa vitesse
+    trails.init(rays.seeded());
+    size_t staged = std::max<size_t>(2, std::min<size_t>(64, TRAIL_VERTEX_BUDGET / (4 * rays.seeded())));   // ~12 Mo d'avance côté CPU
+    LensingRecorder recorder(std::move(rays), staged, 1.0, opt.substeps);
+    std::cout << "[Rayons] " << recorder.rayCount() << " rayons (" << opt.source << "), " << opt.substeps
+              << " pas RK4/échantillon, " << opt.speed << " échantillons/s, traînées de " << trails.length
+              << " points, historique de " << trails.capacity << " échantillons" << std::endl;
+    std::cout << "[Rayons] ESPACE pause, ← / → rembobine / avance vite, ↑ / ↓ vitesse ×2 / ÷2" << std::endl;
+
+    double t = 0.0;                 // échantillon affiché (fractionnaire)
+    double speed = opt.speed;
+    bool paused = false, spaceWas = false, upWas = false, downWas = false;
+    auto last = std::chrono::steady_clock::now(), lastReport = last;
+    uint64_t reportUs = recorder.stepMicros(), reportSamples = 0;
     while(!glfwWindowShouldClose(engine.window)) {
+        auto now = std::chrono::steady_clock::now();
+        double dt = std::min(0.1, std::chrono::duration<double>(now - last).count());   // pas de saut après un blocage
+        last = now;
+
+        bool space = glfwGetKey(engine.window, GLFW_KEY_SPACE) == GLFW_PRESS;
+        bool up    = glfwGetKey(engine.window, GLFW_KEY_UP) == GLFW_PRESS;
+        bool down  = glfwGetKey(engine.window, GLFW_KEY_DOWN) == GLFW_PRESS;
+        if (space && !spaceWas) paused = !paused;
+        if (up && !upWas) speed *= 2.0;
+        if (down && !downWas) speed = std::max(0.01, speed / 2.0);
+        spaceWas = space;  upWas = up;  downWas = down;
+        if (glfwGetKey(engine.window, GLFW_KEY_LEFT) == GLFW_PRESS)       t -= 4.0 * speed * dt;
+        else if (glfwGetKey(engine.window, GLFW_KEY_RIGHT) == GLFW_PRESS) t += 4.0 * speed * dt;
+        else if (!paused)                                                 t += speed * dt;
+
+        // Nouveaux échantillons du worker → VBO, tant qu'ils n'écrasent pas ce qu'on affiche
+        uint64_t available = recorder.available(), before = trails.uploaded;
+        while (trails.uploaded < available && trails.wants(t))
+            trails.upload(recorder.row(trails.uploaded));
+        if (trails.uploaded != before) recorder.consume(trails.uploaded);
+        reportSamples += trails.uploaded - before;
+        if (trails.uploaded)   // on ne lit pas plus loin que ce qui est calculé (le worker rattrape)
+            t = std::min(std::max(t, double(trails.oldest())), double(trails.uploaded - 1));
+        else
+            t = 0.0;
+
         engine.run();
         SagA.draw();
-
-        for (auto& ray : rays) {
-            ray.step(1.0, SagA.r_s);
-            ray.draw();
+        trails.draw(t);
+
+        if (std::chrono::duration<double>(now - lastReport).count() > 2.0) {
+            uint64_t us = recorder.stepMicros();
+            std::cout << "[Rayons] échantillon " << uint64_t(t) << (paused ? " (pause)" : "") << ", "
+                      << trails.uploaded - 1 - uint64_t(t) << " d'avance, " << recorder.live() << " en vol, "
+                      << (reportSamples ? double(us - reportUs) / 1000.0 / double(reportSamples) : 0.0) << " ms/échantillon, "
+                      << recorder.captured() << " capturés, " << recorder.escaped() << " partis"
+                      << (recorder.finished() ? ", intégration terminée" : "") << std::endl;
+            reportUs = us;
+            reportSamples = 0;
+            lastReport = now;
         }
 
         glfwSwapBuffers(engine.window);
         glfwPollEvents();
     }
 
+    trails.release();   // avant que ~Engine détruise le contexte
     return 0;
 }
-
@@ -1,7 +1,13 @@
 #include "common.hpp"
-#include "physics_asm.hpp"  
+#include "physics_asm.hpp"
+#include "space_scene.hpp"
+#include "tracer.hpp"
+#include "adaptive_grid.hpp"
 #define _USE_MATH_DEFINES
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -11,79 +17,54 @@ using Clock = std::chrono::high_resolution_clock;
 // variables globales pcq j'ai la flemme de tout passer en paramètre mdr
 double lastPrintTime = 0.0;
 int    framesCount   = 0;
-struct Ray;
-bool Gravity = false;
-
-struct Camera : public OrbitCamera {
-    Camera() : OrbitCamera(vec3(0.0f), 6.34194e10f, 1e10f, 1e12f, 60.0f) {
-        elevation = M_PI / 2.0f;
-        orbitSpeed = 0.01f;
-        zoomSpeed = 25e9f;
-    }
-
-    void processKey(int key, int scancode, int action, int mods) {
-        if (action == GLFW_PRESS && key == GLFW_KEY_G) {
-            Gravity = !Gravity;
-            cout << "[INFO] Gravité " << (Gravity ? "ACTIVÉE" : "DÉSACTIVÉE") << endl; // toggle la gravité avec G, pratique
-        }
-    }
-};
-Camera camera;
-
-struct BlackHole {
-    vec3 position;
-    double mass;
-    double radius;
-    double r_s; // rayon de Schwarzschild, le point critique quoi
-
-    BlackHole(vec3 pos, float m) : position(pos), mass(m) {
-        r_s = PhysicsUtils::CalculateSchwarzschildRadius(mass); // on calcule le rayon critique
-    }
 
-    bool Intercept(float px, float py, float pz) const {
-        // ⚡ ASSEMBLY-OPTIMIZED: Fast squared distance check (no sqrt needed!)
-        double dist2 = PhysicsASM::DistanceSquared(
-            px, py, pz,
-            float(position.x), float(position.y), float(position.z)
-        );
-        return dist2 < r_s * r_s; // check si on est tombé dedans, si oui c'est rip
-    }
-};
-BlackHole SagA(vec3(0.0f, 0.0f, 0.0f), 8.54e36); // Sagittarius A*, le bestiau au centre de notre galaxie
-
-struct ObjectData {
-    vec4 posRadius; // position xyz + rayon
-    vec4 color; // couleur rgba
-    float mass; // masse de l'objet
-    vec3 velocity = vec3(0.0f, 0.0f, 0.0f); // vitesse initiale
-};
-vector<ObjectData> objects = {
-    { vec4(4e11f, 0.0f, 0.0f, 4e10f), vec4(1,1,0,1), 1.98892e30 }, // étoile jaune
-    { vec4(0.0f, 0.0f, 4e11f, 4e10f), vec4(1,0,0,1), 1.98892e30 }, // étoile rouge
-    { vec4(0.0f, 0.0f, 0.0f, SagA.r_s), vec4(0,0,0,1), static_cast<float>(SagA.mass) }, // le trou noir au centre
-};
+// Scène, caméra et N-body communs avec BlackHole_space_cpu (space_scene.hpp) : G gravité, I intégrateur,
+// D disque, O objets. Ici le rendu passe toujours par le backend GL compute de tracer.hpp.
+SpaceCamera camera;
+SpaceScene  scene;
 
 struct Engine {
-    GLuint gridShaderProgram;
+    ShaderProgram gridShaderProgram;
     GLFWwindow* window;
     GLuint quadVAO;
-    GLuint texture;
-    GLuint shaderProgram;
-    GLuint computeProgram = 0;
-    GLuint cameraUBO = 0;
-    GLuint diskUBO = 0;
-    GLuint objectsUBO = 0;
+    ShaderProgram shaderProgram;
+    // Le ray tracer : geodesic_tiles.comp classe les tuiles 16x16, geodesic.comp intègre les mixtes (tracer.hpp)
+    std::unique_ptr<TracerBackends::GlCompute> tracer;
+    const char* kernelName = "";
+    // Emplacements des uniforms, récupérés une fois après le link
+    GLint viewProjLoc = -1;
+    // Temps GPU par étape, rapporté avec le temps de frame CPU
+    enum GpuStage { GPU_TILES, GPU_INTEGRATE, GPU_GRID, GPU_QUAD };
+    GpuTimer gpuTimer;
+    // Tout ce qui est réécrit à chaque frame passe par des buffers de streaming (pas de réallocation, pas de sync implicite)
     GLuint gridVAO = 0;
-    GLuint gridVBO = 0;
-    GLuint gridEBO = 0;
+    StreamingBuffer gridVertexStream;
+    StreamingBuffer gridIndexStream;
     int gridIndexCount = 0;
+    GLintptr gridIndexOffset = 0;
+    // Grille adaptative : même emprise que l'ancienne 26x26 (espacement 1e10), raffinée près des puits,
+    // budget fixe de 1024 cellules
+    static constexpr float GRID_TOLERANCE = 1e9f;
+    AdaptiveGrid grid{0.5e10f, 0.5e10f, 1.25e11f, 1024, GRID_TOLERANCE, 8};
+    // Cache de la grille : un terme de hauteur par objet (r_s calculé une seule fois),
+    // et la contribution de chaque objet à chaque sommet, pour ne refaire que les objets qui ont bougé
+    struct GridTerm { float x, z, mass; double r_s; };
+    vector<GridTerm> gridTerms;
+    // Re-score du quadtree : chaque objet a une ancre. Tant qu'il reste à moins de δ de l'ancre, seules les
+    // cellules où ce petit déplacement peut compter sont re-notées ; au-delà, l'ancre suit l'objet.
+    struct GridMove { GridTerm from, to; double delta; bool reset; };
+    vector<GridTerm> gridAnchors;
+    vector<GridMove> gridMoved;
+    vector<uint8_t> gridDirty;
+    vector<uint32_t> gridTodo;
+    vector<vector<float>> gridContrib;   // [objet][sommet]
+    vector<float> gridHeights;
+    uint64_t gridVersion = 0;
 
     int WIDTH = 800;
     int HEIGHT = 600;
     int COMPUTE_WIDTH = 200;
     int COMPUTE_HEIGHT = 150;
-    float width = 100000000000.0f;
-    float height = 75000000000.0f;
 
     Engine() {
         window = WindowManager::CreateWindow(WIDTH, HEIGHT, "Black Hole", 4, 3); // on crée la fenêtre, version OpenGL 4.3
@@ -93,7 +74,7 @@ struct Engine {
         WIDTH = fbWidth;
         HEIGHT = fbHeight;
 
-        this->shaderProgram = ShaderUtils::CreateProgram(
+        shaderProgram.reset(ShaderUtils::CreateProgram(
             R"(#version 330 core
             layout (location = 0) in vec2 aPos;
             layout (location = 1) in vec2 aTexCoord;
@@ -109,111 +90,184 @@ struct Engine {
             void main() {
                 FragColor = texture(screenTexture, TexCoord);
             })"
-        ); // shader de base pour afficher une texture sur un quad
-
-        gridShaderProgram = ShaderUtils::LoadProgramFromFiles("grid.vert", "grid.frag"); // shader pour la grille
-        computeProgram = ShaderUtils::LoadComputeShader("geodesic.comp"); // compute shader pour les géodésiques
-
-        glGenBuffers(1, &cameraUBO); // UBO pour les données de caméra
-        glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
-        glBufferData(GL_UNIFORM_BUFFER, 128, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_UNIFORM_BUFFER, 1, cameraUBO);
-
-        glGenBuffers(1, &diskUBO); // UBO pour le disque d'accrétion
-        glBindBuffer(GL_UNIFORM_BUFFER, diskUBO);
-        glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * 4, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_UNIFORM_BUFFER, 2, diskUBO);
-
-        glGenBuffers(1, &objectsUBO); // UBO pour tous les objets de la scène
-        glBindBuffer(GL_UNIFORM_BUFFER, objectsUBO);
-        GLsizeiptr objUBOSize = sizeof(int) + 3 * sizeof(float)
-            + 16 * (sizeof(vec4) + sizeof(vec4))
-            + 16 * sizeof(float);
-        glBufferData(GL_UNIFORM_BUFFER, objUBOSize, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_UNIFORM_BUFFER, 3, objectsUBO);
-
-        auto result = QuadVAO();
-        this->quadVAO = result[0];
-        this->texture = result[1];
+        )); // shader de base pour afficher une texture sur un quad
+        glUseProgram(shaderProgram);
+        glUniform1i(shaderProgram.uniform("screenTexture"), 0);   // toujours l'unité 0
+
+        gridShaderProgram.reset(ShaderUtils::LoadProgramFromFiles("grid.vert", "grid.frag")); // shader pour la grille
+        viewProjLoc = gridShaderProgram.uniform("viewProj");
+        tracer.reset(new TracerBackends::GlCompute); // les deux compute shaders, UBO et SSBO de la scène
+        gpuTimer.create({ "tuiles", "géodésiques", "grille", "quad" });
+        tracer->setTimer(&gpuTimer, GPU_TILES, GPU_INTEGRATE);
+
+        // La grille a un budget fixe de 1024 cellules, donc une taille max connue d'avance
+        gridVertexStream.create(1024 * 2 * 3 * sizeof(float));
+        gridIndexStream.create(1024 * 4 * 2 * sizeof(GLuint));
+
+        quadVAO = QuadVAO();
     }
 
-    void generateGrid(const vector<ObjectData>& objects) {
-        const int gridSize = 25; // taille de la grille, pas trop gros sinon ça lag
-        const float spacing = 1e10f; // espacement entre les points
-
-        vector<vec3> vertices;
-        vector<GLuint> indices;
-
-        for (int z = 0; z <= gridSize; ++z) {
-            for (int x = 0; x <= gridSize; ++x) {
-                float worldX = (x - gridSize / 2) * spacing;
-                float worldZ = (z - gridSize / 2) * spacing;
-                float y = 0.0f;
-
-                // on déforme la grille avec la courbure de Schwarzschild, c'est là que ça devient stylé
-                for (const auto& obj : objects) {
-                    vec3 objPos = vec3(obj.posRadius);
-                    double mass = obj.mass;
-                    double r_s = PhysicsUtils::CalculateSchwarzschildRadius(mass);
-                    double dx = worldX - objPos.x;
-                    double dz = worldZ - objPos.z;
-                    double dist = sqrt(dx * dx + dz * dz);
-
-                    // évite les racines carrées négatives, sinon le compilo panique
-                    if (dist > r_s) {
-                        // formule du diagramme d'embedding, les maths de la relativité générale quoi
-                        double deltaY = 2.0 * sqrt(r_s * (dist - r_s));
-                        y += static_cast<float>(deltaY) - 3e10f; // offset pour bien voir la déformation sinon c'est trop plat
-                    } else {
-                        // si on est à l'intérieur du rayon de Schwarzschild, ça plonge à fond
-                        y += 2.0f * static_cast<float>(sqrt(r_s * r_s)) - 3e10f;
-                    }
-                }
-                vertices.push_back(vec3(worldX, y, worldZ));
+    // Contribution d'un objet au diagramme d'embedding en (x, z)
+    static float GridHeight(const GridTerm& t, float worldX, float worldZ) {
+        double dx = worldX - t.x;
+        double dz = worldZ - t.z;
+        double dist = sqrt(dx * dx + dz * dz);
+
+        // évite les racines carrées négatives, sinon le compilo panique
+        if (dist > t.r_s) {
+            // formule du diagramme d'embedding, les maths de la relativité générale quoi
+            double deltaY = 2.0 * sqrt(t.r_s * (dist - t.r_s));
+            return static_cast<float>(deltaY) - 3e10f; // offset pour bien voir la déformation sinon c'est trop plat
+        }
+        // si on est à l'intérieur du rayon de Schwarzschild, ça plonge à fond
+        return 2.0f * static_cast<float>(t.r_s) - 3e10f;
+    }
+
+    void generateGrid(const vector<SpaceObject>& objects) {
+        bool first = gridVAO == 0;
+        if (!first && gridVersion == scene.version) return;   // rien n'a bougé : les buffers de la frame d'avant restent valides
+        gridVersion = scene.version;
+
+        // Seuls les objets massifs creusent la grille (le champ d'étoiles ne compte pas)
+        size_t massive = 0;
+        while (massive < objects.size() && objects[massive].mass > 0.0f) ++massive;
+
+        // Quels objets ont bougé (ou changé de masse) depuis la dernière fois ?
+        bool countChanged = gridTerms.size() != massive;
+        gridTerms.resize(massive);
+        vector<uint8_t>& dirty = gridDirty;
+        dirty.assign(massive, countChanged ? 1 : 0);
+        gridMoved.clear();
+        for (size_t k = 0; k < massive; ++k) {
+            GridTerm t{ objects[k].posRadius.x, objects[k].posRadius.z, objects[k].mass, 0.0 };
+            if (t.x != gridTerms[k].x || t.z != gridTerms[k].z || t.mass != gridTerms[k].mass) dirty[k] = 1;
+            if (dirty[k]) {
+                t.r_s = PhysicsUtils::CalculateSchwarzschildRadius(t.mass);
+                gridTerms[k] = t;
             }
         }
 
-        // génération des indices pour dessiner les lignes de la grille
-        for (int z = 0; z < gridSize; ++z) {
-            for (int x = 0; x < gridSize; ++x) {
-                int row1 = z * (gridSize + 1);
-                int row2 = (z + 1) * (gridSize + 1);
-                indices.push_back(row1 + x);
-                indices.push_back(row1 + x + 1);
-                indices.push_back(row1 + x);
-                indices.push_back(row2 + x);
+        // Re-score du quadtree. Une note en cache est gardée tant que la part d'erreur qu'elle rate reste sous
+        // eps (5 % de la tolérance) par objet. Pour h = 2√(r_s (d - r_s)) et g = d - r_s l'écart à l'horizon :
+        //   - la part d'un objet dans l'erreur d'une cellule de côté L est ≤ L²/4 · √r_s / g^1.5 ;
+        //   - h est ½-höldérienne hors de l'horizon : un déplacement s change une note d'au plus 4√(r_s s).
+        // Chaque objet a une ancre ; toute note en cache a été prise avec l'objet à moins de δ de son ancre,
+        // avec δ tel que 4√(2 r_s δ) ≤ eps/2. Tant qu'il y reste, seules les cellules dont un échantillon
+        // (coins, milieux des bords, centre) peut passer l'horizon sont re-notées. Plus loin, l'ancre le suit
+        // et toutes les cellules où il pèse, autour de l'ancre ou de la nouvelle position, sont re-notées.
+        const double eps = 0.05 * GRID_TOLERANCE;
+        if (countChanged) gridAnchors = gridTerms;   // tout est re-noté, les ancres repartent d'ici
+        else {
+            for (size_t k = 0; k < massive; ++k) {
+                if (!dirty[k]) continue;
+                const GridTerm& a = gridAnchors[k];
+                const GridTerm& t = gridTerms[k];
+                double delta = std::min(1e-4 * a.r_s, eps * eps / (128.0 * a.r_s));
+                bool reset = t.mass != a.mass || hypot(double(t.x) - a.x, double(t.z) - a.z) > delta;
+                gridMoved.push_back({ a, t, delta, reset });
+                if (reset) gridAnchors[k] = t;
             }
         }
 
-        if (gridVAO == 0) glGenVertexArrays(1, &gridVAO);
-        if (gridVBO == 0) glGenBuffers(1, &gridVBO);
-        if (gridEBO == 0) glGenBuffers(1, &gridEBO);
+        auto height = [&](float x, float z) {
+            float y = 0.0f;
+            for (const auto& t : gridTerms) y += GridHeight(t, x, z);
+            return y;
+        };
 
-        glBindVertexArray(gridVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vec3), vertices.data(), GL_DYNAMIC_DRAW);
+        auto affected = [&](float x0, float z0, float x1, float z1) {
+            if (countChanged) return true;
+            const double L = double(x1) - x0;
+            // Écart à l'horizon du point de la cellule le plus proche de t, moins une marge
+            auto gapTo = [&](const GridTerm& t, double margin) {
+                double dx = std::max({ double(x0) - t.x, 0.0, double(t.x) - x1 });
+                double dz = std::max({ double(z0) - t.z, 0.0, double(t.z) - z1 });
+                return sqrt(dx * dx + dz * dz) - margin - t.r_s;
+            };
+            auto weighs = [&](const GridTerm& t, double margin) {
+                double g = gapTo(t, margin);
+                return g <= 0.0 || 0.25 * L * L * sqrt(t.r_s) / (g * sqrt(g)) > eps;
+            };
+            for (const GridMove& m : gridMoved) {
+                if (m.reset) {
+                    if (weighs(m.from, m.delta) || weighs(m.to, m.delta)) return true;
+                    continue;
+                }
+                if (!weighs(m.from, m.delta)) continue;
+                // Mêmes échantillons que AdaptiveGrid::cellError (calculés en float comme lui)
+                const float xs[3] = { x0, 0.5f * (x0 + x1), x1 };
+                const float zs[3] = { z0, 0.5f * (z0 + z1), z1 };
+                for (float sx : xs)
+                    for (float sz : zs)
+                        if (fabs(hypot(double(sx) - m.from.x, double(sz) - m.from.z) - m.from.r_s) <= m.delta) return true;
+            }
+            return false;
+        };
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_DYNAMIC_DRAW);
+        // Le quadtree suit les objets : on raffine/fusionne un peu à chaque changement
+        if (first) grid.subdivideUniform(4, height);
+        grid.updateAffected(height, affected);
+        bool topologyChanged = grid.needsSegments();
+        if (topologyChanged) {
+            grid.buildSegments();
+            std::fill(dirty.begin(), dirty.end(), 1);   // nouveaux sommets : toutes les contributions sont à refaire
+        }
+
+        // Contributions des objets sales seulement, puis somme ; réparti sur le pool quand ça vaut le coup
+        const size_t nv = grid.vertexCount();
+        const float* xyz = grid.vertices().data();
+        gridContrib.resize(massive);
+        vector<uint32_t>& todo = gridTodo;
+        todo.clear();
+        for (size_t k = 0; k < massive; ++k) {
+            if (!dirty[k]) continue;
+            gridContrib[k].resize(nv);
+            todo.push_back(uint32_t(k));
+        }
+        gridHeights.resize(nv);
+        auto evaluate = [&](size_t begin, size_t end, unsigned) {
+            for (uint32_t k : todo)
+                for (size_t v = begin; v < end; ++v)
+                    gridContrib[k][v] = GridHeight(gridTerms[k], xyz[v * 3], xyz[v * 3 + 2]);
+            // Somme en SIMD (axpy avec a = 1) : même ordre objet par objet, donc même résultat au bit près
+            std::fill(gridHeights.begin() + begin, gridHeights.begin() + end, 0.0f);
+            for (const auto& c : gridContrib)
+                PhysicsASM::AxpyBatch(1.0f, c.data() + begin, gridHeights.data() + begin, end - begin);
+        };
+        if (nv * todo.size() >= 4096) scene.pool.parallelFor(nv, 256, evaluate);
+        else evaluate(0, nv, 0);
+        grid.setHeights(gridHeights.data());
+
+        if (first) glGenVertexArrays(1, &gridVAO);
+
+        // Les indices ne repartent que si la topologie a changé : leur région de l'anneau n'est pas recyclée d'ici là
+        GLintptr vertexOffset = gridVertexStream.upload(grid.vertices().data(), grid.vertices().size() * sizeof(float));
+        if (topologyChanged) {
+            const auto& indices = grid.indices();
+            gridIndexOffset = gridIndexStream.upload(indices.data(), indices.size() * sizeof(GLuint));
+            gridIndexCount = indices.size();
+        }
+
+        glBindVertexArray(gridVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, gridVertexStream.id());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridIndexStream.id());
 
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)vertexOffset);
 
-        gridIndexCount = indices.size();
         glBindVertexArray(0);
     }
 
     void drawGrid(const mat4& viewProj) {
         glUseProgram(gridShaderProgram);
-        glUniformMatrix4fv(glGetUniformLocation(gridShaderProgram, "viewProj"),
-                        1, GL_FALSE, glm::value_ptr(viewProj));
+        glUniformMatrix4fv(viewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
         glBindVertexArray(gridVAO);
 
         glDisable(GL_DEPTH_TEST);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glDrawElements(GL_LINES, gridIndexCount, GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_LINES, gridIndexCount, GL_UNSIGNED_INT, (void*)gridIndexOffset);
 
         glBindVertexArray(0);
         glEnable(GL_DEPTH_TEST);
@@ -224,99 +278,38 @@ struct Engine {
         glBindVertexArray(quadVAO);
 
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glUniform1i(glGetUniformLocation(shaderProgram, "screenTexture"), 0);
+        glBindTexture(GL_TEXTURE_2D, tracer->texture());
 
         glDisable(GL_DEPTH_TEST);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 6);
         glEnable(GL_DEPTH_TEST);
     }
 
-    void dispatchCompute(const Camera& cam) {
-        // determine target compute‐res - use consistent resolution
-        int cw = cam.moving ? COMPUTE_WIDTH  : 200;
-        int ch = cam.moving ? COMPUTE_HEIGHT : 150;
-
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cw, ch, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-        glUseProgram(computeProgram);
-        uploadCameraUBO(cam);
-        uploadDiskUBO();
-        uploadObjectsUBO(objects);
-
-        glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-
-        GLuint groupsX = (GLuint)std::ceil(cw / 16.0f);
-        GLuint groupsY = (GLuint)std::ceil(ch / 16.0f);
-        glDispatchCompute(groupsX, groupsY, 1);
-
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-    }
-
-    void uploadCameraUBO(const Camera& cam) {
-        struct UBOData {
-            vec3 pos; float _pad0;
-            vec3 right; float _pad1;
-            vec3 up; float _pad2;
-            vec3 forward; float _pad3;
-            float tanHalfFov;
-            float aspect;
-            bool moving;
-            int _pad4;
-        } data;
-
-        vec3 fwd = normalize(cam.target - cam.position());
-        vec3 up = vec3(0, 1, 0);
-        vec3 right = normalize(cross(fwd, up));
-        up = cross(right, fwd);
-
-        data.pos = cam.position();
-        data.right = right;
-        data.up = up;
-        data.forward = fwd;
-        data.tanHalfFov = tan(radians(60.0f * 0.5f));
-        data.aspect = float(WIDTH) / float(HEIGHT);
-        data.moving = cam.dragging || cam.panning;
-
-        glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UBOData), &data);
+    // fences de fin de frame : les régions de cette frame ne seront réécrites qu'une fois lues par le GPU
+    void endFrame() {
+        gridVertexStream.endFrame();
+        gridIndexStream.endFrame();
+        gpuTimer.endFrame();
     }
 
-    void uploadObjectsUBO(const vector<ObjectData>& objs) {
-        struct UBOData {
-            int numObjects;
-            float _pad0, _pad1, _pad2;
-            vec4 posRadius[16];
-            vec4 color[16];
-            float mass[16];
-        } data;
-
-        size_t count = std::min(objs.size(), size_t(16));
-        data.numObjects = static_cast<int>(count);
-
-        for (size_t i = 0; i < count; ++i) {
-            data.posRadius[i] = objs[i].posRadius;
-            data.color[i] = objs[i].color;
-            data.mass[i] = objs[i].mass;
-        }
-
-        glBindBuffer(GL_UNIFORM_BUFFER, objectsUBO);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(data), &data);
+    // à appeler tant que le contexte GL existe encore (engine est global, son destructeur passe après glfwTerminate)
+    void releaseStreams() {
+        tracer.reset();
+        gridVertexStream.release();
+        gridIndexStream.release();
+        gpuTimer.release();
     }
 
-    void uploadDiskUBO() {
-        float r1 = SagA.r_s * 2.2f;
-        float r2 = SagA.r_s * 5.2f;
-        float num = 2.0;
-        float thickness = 1e9f;
-        float diskData[4] = { r1, r2, num, thickness };
-
-        glBindBuffer(GL_UNIFORM_BUFFER, diskUBO);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(diskData), diskData);
+    // Même Frame que les backends CPU de BlackHole_space_cpu ; le tracer écrit dans sa texture, sans relecture
+    void dispatchCompute(const SpaceCamera& cam) {
+        // determine target compute‐res - use consistent resolution
+        CpuTracer::Frame frame = scene.frame(cam, float(WIDTH) / float(HEIGHT));
+        frame.width  = cam.moving ? COMPUTE_WIDTH  : 200;
+        frame.height = cam.moving ? COMPUTE_HEIGHT : 150;
+        kernelName = tracer->render(frame, scene.policy());   // les deux passes sont chronométrées par gpuTimer
     }
 
-    vector<GLuint> QuadVAO() {
+    GLuint QuadVAO() {
         float quadVertices[] = {
             -1.0f,  1.0f,  0.0f, 1.0f,
             -1.0f, -1.0f,  0.0f, 0.0f,
@@ -339,24 +332,27 @@ struct Engine {
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
         glEnableVertexAttribArray(1);
 
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, COMPUTE_WIDTH, COMPUTE_HEIGHT,
-                    0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-        return {VAO, texture};
+        return VAO;
     }
 };
 Engine engine;
 
-int main() {
+int main(int argc, char** argv) {
     OrbitCamera::RegisterCallbacks(engine.window, &camera);
 
-    glfwSetKeyCallback(engine.window, [](GLFWwindow* win, int key, int scancode, int action, int mods) {
-        camera.processKey(key, scancode, action, mods);
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--stars" && i + 1 < argc) {
+            int n = std::max(0, std::atoi(argv[++i]));
+            scene.addStarField(n);
+            cout << "[INFO] " << n << " étoiles de fond ajoutées (" << scene.objects.size() << " objets)" << endl;
+        } else {
+            cerr << "Usage : BlackHole_space [--stars N]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    glfwSetKeyCallback(engine.window, [](GLFWwindow*, int key, int, int action, int) {
+        scene.processKey(key, action);
     });
 
     // Gestion du redimensionnement de fenêtre (au cas où tu veux resize pendant que ça tourne)
@@ -366,9 +362,8 @@ int main() {
         glViewport(0, 0, width, height);
     });
 
-    auto t0 = Clock::now();
-    lastPrintTime = chrono::duration<double>(t0.time_since_epoch()).count();
     double lastTime = glfwGetTime();
+    lastPrintTime = lastTime;
 
     while (!glfwWindowShouldClose(engine.window)) {
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -379,45 +374,37 @@ int main() {
         lastTime = now;
 
         // Simulation de la gravité (les corps s'attirent comme moi et mon lit le matin)
-        for (auto& obj : objects) {
-            for (auto& obj2 : objects) {
-                if (&obj == &obj2) continue;
-
-                float dx = obj2.posRadius.x - obj.posRadius.x;
-                float dy = obj2.posRadius.y - obj.posRadius.y;
-                float dz = obj2.posRadius.z - obj.posRadius.z;
-                float distance = sqrt(dx * dx + dy * dy + dz * dz);
-
-                if (distance > 0 && Gravity) {
-                    vec3 direction = normalize(vec3(dx, dy, dz));
-                    double Gforce = (GRAVITATIONAL_CONSTANT * obj.mass * obj2.mass) / (distance * distance);
-                    double acc1 = Gforce / obj.mass;
-                    vec3 acc = direction * float(acc1);
-
-                    obj.velocity += acc * float(dt);
-                    obj.posRadius.x += obj.velocity.x * float(dt);
-                    obj.posRadius.y += obj.velocity.y * float(dt);
-                    obj.posRadius.z += obj.velocity.z * float(dt);
-                }
-            }
-        }
+        scene.step(float(dt));
 
         // Grille (avec la courbure de l'espace-temps stylée)
-        engine.generateGrid(objects);
+        engine.generateGrid(scene.objects);   // CPU seulement : hors du timer GPU, sinon l'attente du GPU compterait
         mat4 view = lookAt(camera.position(), camera.target, vec3(0,1,0));
         mat4 proj = perspective(radians(60.0f), float(engine.WIDTH)/float(engine.HEIGHT), 1e9f, 1e14f);
         mat4 viewProj = proj * view;
+        engine.gpuTimer.begin(Engine::GPU_GRID);
         engine.drawGrid(viewProj);
+        engine.gpuTimer.end(Engine::GPU_GRID);
 
         // Raytracer (pour rendre tout ça magnifique)
         glViewport(0, 0, engine.WIDTH, engine.HEIGHT);
         engine.dispatchCompute(camera);
+        engine.gpuTimer.begin(Engine::GPU_QUAD);
         engine.drawFullScreenQuad();
+        engine.gpuTimer.end(Engine::GPU_QUAD);
+        engine.endFrame();
+
+        // toutes les 2 s : temps de frame CPU et temps GPU de chaque étape, pour savoir quoi optimiser
+        if (now - lastPrintTime >= 2.0) {
+            cout << "[GPU] kernel " << engine.kernelName << endl;
+            engine.gpuTimer.report(cout);
+            lastPrintTime = now;
+        }
 
         glfwSwapBuffers(engine.window);
         glfwPollEvents();
     }
 
+    engine.releaseStreams();
     glfwDestroyWindow(engine.window);
     glfwTerminate();
     return 0;
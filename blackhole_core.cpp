@@ -0,0 +1,128 @@
+// blackhole_core.cpp
+// C entry points of blackhole_core (see blackhole_core.h).
+//
+// The batch is cut into fixed chunks of rays handed to a ThreadPool; each
+// chunk runs CpuTracer::TraceRays with a source reading bh_ray_in and a sink
+// writing bh_ray_out.  Every ray only ever touches its own output slot, so the
+// results do not depend on the chunking or the thread count.
+
+#include "blackhole_core.h"
+#include "cpu_tracer.hpp"
+#include "thread_pool.hpp"
+
+#include <mutex>
+#include <vector>
+
+namespace {
+
+constexpr size_t RAYS_PER_CHUNK = 256;
+
+// One chunk of the batch; ids are relative to the chunk, so they fit in an int
+struct BatchSource {
+    const bh_ray_in* rays;
+    int count, index;
+
+    bool next(int& id, CpuTracer::detail::V3& pos, CpuTracer::detail::V3& dir) {
+        using namespace CpuTracer::detail;
+        if (index >= count) return false;
+        const bh_ray_in& r = rays[index];
+        pos = Load(r.origin);
+        dir = Normalize(Load(r.direction));
+        id  = index++;
+        return true;
+    }
+};
+
+struct BatchSink {
+    bh_ray_out* out;    // the chunk's first output
+
+    void finish(int id, const CpuTracer::Termination& t) {
+        static const int32_t status[] = { BH_ESCAPED, BH_CAPTURED, BH_DISK, BH_OBJECT, BH_MAX_STEPS };
+        bh_ray_out& o = out[id];
+        o.status = status[int(t.hit)];
+        o.steps  = t.steps;
+        o.object = t.object;
+        o.position[0]  = t.position.x;   o.position[1]  = t.position.y;   o.position[2]  = t.position.z;
+        o.direction[0] = t.direction.x;  o.direction[1] = t.direction.y;  o.direction[2] = t.direction.z;
+    }
+};
+
+// Same role as CpuTracer::Select(): the policies are fixed for the batch
+using BatchKernel = void (*)(const CpuTracer::Frame&, BatchSource&, BatchSink&);
+
+BatchKernel SelectBatch(bool cartesian, bool disk, bool objects) {
+    using I = CpuTracer::Integrator;
+    static const BatchKernel table[2][2][2] = {
+        { { &CpuTracer::TraceRays<I::Spherical, false, false, true, BatchSource, BatchSink>,
+            &CpuTracer::TraceRays<I::Spherical, false, true,  true, BatchSource, BatchSink> },
+          { &CpuTracer::TraceRays<I::Spherical, true,  false, true, BatchSource, BatchSink>,
+            &CpuTracer::TraceRays<I::Spherical, true,  true,  true, BatchSource, BatchSink> } },
+        { { &CpuTracer::TraceRays<I::Cartesian, false, false, true, BatchSource, BatchSink>,
+            &CpuTracer::TraceRays<I::Cartesian, false, true,  true, BatchSource, BatchSink> },
+          { &CpuTracer::TraceRays<I::Cartesian, true,  false, true, BatchSource, BatchSink>,
+            &CpuTracer::TraceRays<I::Cartesian, true,  true,  true, BatchSource, BatchSink> } },
+    };
+    return table[cartesian][disk][objects];
+}
+
+// Pool and sphere copy shared by all calls; the mutex serialises them
+struct Core {
+    std::mutex mtx;
+    ThreadPool pool;
+    std::vector<CpuTracer::Sphere> spheres;
+};
+
+Core& GetCore() {
+    static Core core;
+    return core;
+}
+
+bool ValidScene(const bh_scene* s) {
+    return s && s->rs > 0.0f && s->step_length > 0.0f && s->escape_radius > 0.0f &&
+           s->max_steps >= 0 && s->sphere_count >= 0 && (s->sphere_count == 0 || s->spheres) &&
+           (s->integrator == BH_SPHERICAL || s->integrator == BH_CARTESIAN);
+}
+
+} // namespace
+
+extern "C" int bh_trace_batch(const bh_ray_in* rays, size_t n, bh_ray_out* out, const bh_scene* scene) {
+    if (!ValidScene(scene)) return -1;
+    if (n == 0) return 0;
+    if (!rays || !out) return -1;
+    for (size_t i = 0; i < n; ++i) {
+        const float* d = rays[i].direction;
+        if (!(d[0] * d[0] + d[1] * d[1] + d[2] * d[2] > 0.0f)) return -1;
+    }
+
+    Core& core = GetCore();
+    std::lock_guard<std::mutex> lk(core.mtx);
+
+    CpuTracer::Frame f;
+    f.rs       = scene->rs;
+    f.diskR1   = scene->disk_inner;
+    f.diskR2   = scene->disk_outer;
+    f.escapeR  = scene->escape_radius;
+    f.dLambda  = scene->step_length;
+    f.maxSteps = scene->max_steps;
+    core.spheres.resize(size_t(scene->sphere_count));   // grows only past the largest scene so far
+    for (int j = 0; j < scene->sphere_count; ++j) {
+        const bh_sphere& s = scene->spheres[j];
+        core.spheres[j] = { s.center[0], s.center[1], s.center[2], s.radius, 0, 0, 0, 0 };
+    }
+    f.objects     = core.spheres.data();
+    f.objectCount = scene->sphere_count;
+
+    BatchKernel trace = SelectBatch(scene->integrator == BH_CARTESIAN,
+                                    scene->disk_outer > scene->disk_inner,
+                                    scene->sphere_count > 0);
+    core.pool.parallelFor(n, RAYS_PER_CHUNK, [&](size_t b, size_t e, unsigned) {
+        BatchSource src{ rays + b, int(e - b), 0 };
+        BatchSink   sink{ out + b };
+        trace(f, src, sink);
+    });
+    return 0;
+}
+
+extern "C" unsigned bh_thread_count(void) {
+    return GetCore().pool.size();
+}
@@ -0,0 +1,199 @@
+/* blackhole_core_test.c
+ * Checks of the blackhole_core C API, run by ctest: argument validation, the
+ * photon-capture threshold, each termination status, and results that do not
+ * depend on how a batch is split.  Lengths are in units of rs.
+ *
+ * Build target: BlackHole_core_test
+ */
+
+#include "blackhole_core.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                    \
+        }                                                                  \
+    } while (0)
+
+static bh_scene Scene(void) {
+    bh_scene s;
+    memset(&s, 0, sizeof s);
+    s.rs            = 1.0f;
+    s.escape_radius = 40.0f;
+    s.step_length   = 0.004f;
+    s.max_steps     = 100000;
+    s.integrator    = BH_CARTESIAN;
+    return s;
+}
+
+static bh_ray_in Ray(float x, float y, float z, float dx, float dy, float dz) {
+    bh_ray_in r;
+    r.origin[0] = x;     r.origin[1] = y;     r.origin[2] = z;
+    r.direction[0] = dx; r.direction[1] = dy; r.direction[2] = dz;
+    return r;
+}
+
+static void TestArguments(void) {
+    bh_scene  s = Scene();
+    bh_ray_in r = Ray(-30.0f, 5.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    bh_ray_out o;
+
+    CHECK(bh_trace_batch(NULL, 1, &o, &s) == -1);
+    CHECK(bh_trace_batch(&r, 1, NULL, &s) == -1);
+    CHECK(bh_trace_batch(&r, 1, &o, NULL) == -1);
+    CHECK(bh_trace_batch(NULL, 0, NULL, &s) == 0);   /* n == 0: nothing to read or write */
+    CHECK(bh_trace_batch(&r, 0, &o, &s) == 0);
+
+    s.rs = 0.0f;
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == -1);
+    s.rs = -1.0f;
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == -1);
+
+    s = Scene();
+    s.integrator = BH_SPHERICAL;
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == 0);
+    s.integrator = 2;                                 /* not a bh_integrator */
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == -1);
+    s.integrator = -1;
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == -1);
+
+    s = Scene();
+    r.direction[0] = 0.0f;
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == -1);
+}
+
+/* Parallel rays from x = -30: below b = 3√3/2 rs they fall in, above they
+ * escape.  2 % either side covers the finite start distance and the step. */
+static void TestCaptureThreshold(void) {
+    enum { PER_SIDE = 48 };
+    const float bCrit = 1.5f * sqrtf(3.0f);
+    bh_scene  s = Scene();
+    bh_ray_in  rays[2 * PER_SIDE];
+    bh_ray_out out[2 * PER_SIDE];
+    int i;
+
+    for (i = 0; i < PER_SIDE; ++i) {
+        float below = 0.98f * bCrit * (float)i / (float)(PER_SIDE - 1);
+        float above = 1.02f * bCrit + 7.0f * (float)i / (float)(PER_SIDE - 1);
+        rays[i]            = Ray(-30.0f, below, 0.0f, 1.0f, 0.0f, 0.0f);
+        rays[PER_SIDE + i] = Ray(-30.0f, 0.0f, above, 1.0f, 0.0f, 0.0f);   /* another plane, same geometry */
+    }
+    CHECK(bh_trace_batch(rays, 2 * PER_SIDE, out, &s) == 0);
+    for (i = 0; i < PER_SIDE; ++i) {
+        CHECK(out[i].status == BH_CAPTURED);
+        CHECK(out[i].object == -1);
+        CHECK(out[PER_SIDE + i].status == BH_ESCAPED);
+        CHECK(out[PER_SIDE + i].object == -1);
+    }
+}
+
+static void TestMaxSteps(void) {
+    bh_scene  s = Scene();
+    bh_ray_in r = Ray(-30.0f, 5.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    bh_ray_out o;
+
+    s.max_steps = 0;
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == 0);
+    CHECK(o.status == BH_MAX_STEPS);
+    CHECK(o.steps == 0);
+    CHECK(o.position[0] == -30.0f && o.position[1] == 5.0f);
+
+    s.max_steps = 10;
+    CHECK(bh_trace_batch(&r, 1, &o, &s) == 0);
+    CHECK(o.status == BH_MAX_STEPS);
+    CHECK(o.steps == 10);
+}
+
+static void TestDiskAndObjects(void) {
+    bh_sphere spheres[3] = {
+        { { 10.0f, 0.0f,   0.0f }, 2.0f },
+        { {  0.0f, 0.0f,  10.0f }, 2.0f },
+        { {-10.0f, 0.0f,   0.0f }, 2.0f },
+    };
+    bh_ray_in  rays[4];
+    bh_ray_out out[4];
+    bh_scene   s = Scene();
+    int i;
+
+    /* Straight down onto the disk between its edges */
+    s.disk_inner = 3.0f;
+    s.disk_outer = 12.0f;
+    rays[0] = Ray(6.0f, 5.0f, 0.0f, 0.0f, -1.0f, 0.0f);
+    CHECK(bh_trace_batch(rays, 1, out, &s) == 0);
+    CHECK(out[0].status == BH_DISK);
+    CHECK(out[0].object == -1);
+    CHECK(fabsf(out[0].position[1]) < 0.01f);
+
+    /* Straight down onto each sphere, plus one ray that passes them all */
+    s.disk_outer   = 0.0f;
+    s.spheres      = spheres;
+    s.sphere_count = 3;
+    rays[0] = Ray(-10.0f, 5.0f,  0.0f, 0.0f, -1.0f, 0.0f);
+    rays[1] = Ray( 10.0f, 5.0f,  0.0f, 0.0f, -1.0f, 0.0f);
+    rays[2] = Ray(  0.0f, 5.0f, 10.0f, 0.0f, -1.0f, 0.0f);
+    rays[3] = Ray(  0.0f, 15.0f, -30.0f, 0.0f, 0.0f, 1.0f);
+    CHECK(bh_trace_batch(rays, 4, out, &s) == 0);
+    CHECK(out[0].status == BH_OBJECT && out[0].object == 2);
+    CHECK(out[1].status == BH_OBJECT && out[1].object == 0);
+    CHECK(out[2].status == BH_OBJECT && out[2].object == 1);
+    CHECK(out[3].status == BH_ESCAPED && out[3].object == -1);
+    for (i = 0; i < 3; ++i) CHECK(out[i].position[1] > 1.5f && out[i].position[1] < 2.0f);
+}
+
+/* Same rays whole and in uneven pieces: every output must match bit for bit */
+static void TestSplitBatches(void) {
+    enum { N = 1000 };
+    static bh_ray_in  rays[N];
+    static bh_ray_out whole[N], parts[N];
+    const size_t cuts[] = { 0, 1, 4, 7, 300, 557, N };
+    bh_sphere sphere = { { 8.0f, 1.0f, -3.0f }, 1.5f };
+    bh_scene  s = Scene();
+    unsigned  seed = 12345u;
+    int i, counts[5] = { 0, 0, 0, 0, 0 };
+
+    s.disk_inner   = 3.0f;
+    s.disk_outer   = 12.0f;
+    s.spheres      = &sphere;
+    s.sphere_count = 1;
+    s.max_steps    = 20000;
+    for (i = 0; i < N; ++i) {
+        float v[6];
+        int k;
+        for (k = 0; k < 6; ++k) {
+            seed = seed * 1664525u + 1013904223u;
+            v[k] = (float)(seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+        }
+        rays[i] = Ray(-20.0f, 6.0f * v[0], 6.0f * v[1], 1.0f, 0.3f * v[2], 0.3f * v[3]);
+    }
+
+    CHECK(bh_trace_batch(rays, N, whole, &s) == 0);
+    for (i = 0; i + 1 < (int)(sizeof cuts / sizeof cuts[0]); ++i)
+        CHECK(bh_trace_batch(rays + cuts[i], cuts[i + 1] - cuts[i], parts + cuts[i], &s) == 0);
+    CHECK(memcmp(whole, parts, sizeof whole) == 0);
+
+    for (i = 0; i < N; ++i) counts[whole[i].status]++;
+    CHECK(counts[BH_ESCAPED] > 0 && counts[BH_CAPTURED] > 0 && counts[BH_DISK] > 0);   /* a mixed batch */
+}
+
+int main(void) {
+    TestArguments();
+    TestCaptureThreshold();
+    TestMaxSteps();
+    TestDiskAndObjects();
+    TestSplitBatches();
+
+    if (failures) {
+        fprintf(stderr, "blackhole_core: %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("blackhole_core: all checks passed (%u threads)\n", bh_thread_count());
+    return EXIT_SUCCESS;
+}
@@ -5,9 +5,11 @@
 # successfully built, then presents only those as menu options.
 # Targets:
 #   PhysicsASM_Demo      — assembly validation & benchmarks (no graphics)
+#   PhysicsASM_Bench     — statistical micro-benchmark suite (no graphics)
+#   BlackHole_core_example — C API batch ray trace (no graphics)
 #   Gravity_Grid         — N-body simulation (OpenGL 3.3)
 #   BlackHole_curv       — 2-D gravitational lensing demo (OpenGL 3.3)
-#   BlackHole_space_cpu  — CPU RK4 ray tracer, std::thread (OpenGL 3.3)
+#   BlackHole_space_cpu  — RK4 ray tracer, fastest backend (CPU or GL compute) picked at startup (OpenGL 3.3)
 #   BlackHole_space_cuda — CUDA GPU ray tracer (NVIDIA only, optional)
 #   BlackHole_space_metal— Metal GPU ray tracer (Apple Silicon only)
 
@@ -52,6 +54,8 @@ build_target() {
 }
 
 build_target PhysicsASM_Demo
+build_target PhysicsASM_Bench
+build_target BlackHole_core_example
 build_target Gravity_Grid
 build_target BlackHole_curv
 build_target BlackHole_space_cpu
@@ -79,20 +83,30 @@ if [[ -f PhysicsASM_Demo ]]; then
     LABELS+=("PhysicsASM_Demo   — assembly validation & benchmark (no graphics)")
     CONTROLS+=("")
 fi
+if [[ -f PhysicsASM_Bench ]]; then
+    BUILT+=("PhysicsASM_Bench")
+    LABELS+=("PhysicsASM_Bench  — asm vs C++ / auto-vectorised / intrinsics benchmark suite")
+    CONTROLS+=("")
+fi
+if [[ -f BlackHole_core_example ]]; then
+    BUILT+=("BlackHole_core_example")
+    LABELS+=("BlackHole_core_example — blackhole_core C API: batch of rays, deflection table")
+    CONTROLS+=("")
+fi
 if [[ -f Gravity_Grid ]]; then
     BUILT+=("Gravity_Grid")
     LABELS+=("Gravity_Grid      — N-body gravitational simulation")
-    CONTROLS+=("  Mouse drag: rotate  |  Scroll: zoom  |  SPACE: pause  |  ESC: quit")
+    CONTROLS+=("  Mouse drag: rotate  |  Scroll: zoom  |  SPACE: pause  |  C: collisions  |  T: trails  |  ESC: quit")
 fi
 if [[ -f BlackHole_curv ]]; then
     BUILT+=("BlackHole_curv")
     LABELS+=("BlackHole_curv    — 2-D gravitational lensing demo")
-    CONTROLS+=("  Mouse: interact  |  ESC: quit")
+    CONTROLS+=("  SPACE: pause  |  ←/→ (hold): rewind/fast-forward  |  ↑/↓: speed ×2/÷2  |  ESC: quit  |  options: --rays N  --source beam|fan|point  --substeps K  --speed S")
 fi
 if [[ -f BlackHole_space_cpu ]]; then
     BUILT+=("BlackHole_space_cpu")
     LABELS+=("BlackHole_space_cpu — CPU RK4 ray tracer  [${ARCH}]")
-    CONTROLS+=("  Mouse drag: rotate  |  Scroll: zoom  |  G: toggle gravity  |  ESC: quit")
+    CONTROLS+=("  Mouse drag: rotate  |  Scroll: zoom  |  G: gravity  |  I: integrator  |  D/O: disk/objects  |  ESC: quit")
 fi
 if [[ -f BlackHole_space_cuda ]]; then
     BUILT+=("BlackHole_space_cuda")
@@ -0,0 +1,333 @@
+// collision.hpp
+// Sphere-sphere collision detection and response for the N-body simulation.
+//
+// Broad phase: a uniform spatial hash rebuilt every step.  The cell size is
+// the largest diameter among the ordinary bodies, so two of them that overlap
+// always land in the same or in adjacent cells and each one only has to look
+// at 27 cells.  Bodies more than LARGE_FACTOR times the median radius (a
+// central star) would blow the cells up for everyone; they stay out of the
+// hash and query the cells their sphere covers, and are tested among
+// themselves directly.
+// Keys, bucket counts and the pair search run on the ThreadPool; all scratch
+// storage is kept between steps, so a steady-state step does not allocate.
+//
+// Narrow phase: exact overlap test on the candidate pairs, then either
+//   - Merge  : perfectly inelastic — mass and momentum conserved, volume
+//              conserved (radius recomputed from the combined density), or
+//   - Bounce : impulse along the contact normal with restitution, plus a
+//              positional correction that removes the overlap.
+// Contacts are resolved serially in (i, j) order so the outcome does not
+// depend on the thread count.
+
+#ifndef COLLISION_HPP
+#define COLLISION_HPP
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+enum class CollisionMode { Off, Merge, Bounce };
+
+inline const char* CollisionModeName(CollisionMode m) {
+    switch (m) {
+        case CollisionMode::Merge:  return "merge";
+        case CollisionMode::Bounce: return "bounce";
+        default:                    return "off";
+    }
+}
+
+// Non-owning SoA view over the bodies taking part in collision handling.
+struct CollisionBodies {
+    float*   x  = nullptr; float* y  = nullptr; float* z  = nullptr;
+    float*   vx = nullptr; float* vy = nullptr; float* vz = nullptr;
+    float*   mass    = nullptr;
+    float*   density = nullptr;
+    float*   radius  = nullptr;
+    uint8_t* alive   = nullptr;   // 0 once a body has been merged away
+    size_t   count   = 0;
+};
+
+struct ContactPair {
+    uint32_t i, j;   // i < j
+    bool operator<(const ContactPair& o) const {
+        return i != o.i ? i < o.i : j < o.j;
+    }
+};
+
+class SpatialHash {
+public:
+    // A body is "large" above this many median radii
+    static constexpr float LARGE_FACTOR = 4.0f;
+
+    // Rebuilds the hash over the bodies' centres.
+    void build(const CollisionBodies& b, ThreadPool& pool) {
+        n = b.count;
+        if (cellOf.size() < n) {
+            cellOf.resize(n);
+            sorted.resize(n);
+            packed.resize(n);
+            radii.resize(n);
+        }
+
+        // Median radius → threshold for the large bodies; the cell fits the rest
+        float limit = 0.0f;
+        if (n) {
+            std::copy(b.radius, b.radius + n, radii.begin());
+            std::nth_element(radii.begin(), radii.begin() + n / 2, radii.begin() + n);
+            limit = LARGE_FACTOR * radii[n / 2];
+        }
+        float maxR = 0.0f;
+        large.clear();
+        for (size_t i = 0; i < n; ++i) {
+            if (b.radius[i] > limit) large.push_back(uint32_t(i));
+            else                     maxR = std::max(maxR, b.radius[i]);
+        }
+        cellSize    = std::max(2.0f * maxR, 1e-6f);
+        invCellSize = 1.0f / cellSize;
+        small       = n - large.size();
+
+        size_t want = 64;
+        while (want < 2 * small) want <<= 1;
+        if (want != tableSize) {
+            tableSize = want;
+            counts.reset(new std::atomic<uint32_t>[tableSize]);
+            bucketStart.assign(tableSize + 1, 0);
+        }
+        mask = tableSize - 1;
+
+        pool.parallelFor(tableSize, 4096, [&](size_t s, size_t e, unsigned) {
+            for (size_t k = s; k < e; ++k) counts[k].store(0, std::memory_order_relaxed);
+        });
+        pool.parallelFor(n, 1024, [&](size_t s, size_t e, unsigned) {
+            for (size_t i = s; i < e; ++i) {
+                if (b.radius[i] > limit) continue;
+                uint32_t h = hashCell(cellCoord(b.x[i]), cellCoord(b.y[i]), cellCoord(b.z[i]));
+                cellOf[i] = h;
+                counts[h].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        // Exclusive prefix sum → bucket start offsets (counts reused as cursors).
+        uint32_t run = 0;
+        for (size_t k = 0; k < tableSize; ++k) {
+            bucketStart[k] = run;
+            uint32_t c = counts[k].load(std::memory_order_relaxed);
+            counts[k].store(run, std::memory_order_relaxed);
+            run += c;
+        }
+        bucketStart[tableSize] = run;
+
+        pool.parallelFor(n, 1024, [&](size_t s, size_t e, unsigned) {
+            for (size_t i = s; i < e; ++i) {
+                if (b.radius[i] > limit) continue;
+                uint32_t slot = counts[cellOf[i]].fetch_add(1, std::memory_order_relaxed);
+                sorted[slot] = uint32_t(i);
+                packed[slot] = { b.x[i], b.y[i], b.z[i], b.radius[i] };
+            }
+        });
+    }
+
+    // Fills `out` with every overlapping pair (i < j), sorted.
+    void findContacts(const CollisionBodies& b, ThreadPool& pool,
+                      std::vector<ContactPair>& out) {
+        if (perWorker.size() < pool.size()) perWorker.resize(pool.size());
+        for (auto& v : perWorker) v.clear();
+
+        // Queries walk the bodies in bucket order so neighbouring queries hit
+        // the same buckets, and candidates are read from the packed copy.
+        pool.parallelFor(small, 256, [&](size_t s, size_t e, unsigned w) {
+            std::vector<ContactPair>& local = perWorker[w];
+            for (size_t q = s; q < e; ++q) {
+                uint32_t i = sorted[q];
+                const Packed& pi = packed[q];
+                int32_t cx = cellCoord(pi.x), cy = cellCoord(pi.y), cz = cellCoord(pi.z);
+                auto scan = [&](uint32_t kBegin, uint32_t kEnd) {
+                    for (uint32_t k = kBegin; k < kEnd; ++k) {
+                        uint32_t j = sorted[k];
+                        if (j <= i) continue;
+                        if (overlap(pi, packed[k])) local.push_back({ i, j });
+                    }
+                };
+                // The hash is linear in cx, so the three cells of a row are three
+                // consecutive buckets: 9 contiguous ranges instead of 27 lookups.
+                for (int dz = -1; dz <= 1; ++dz)
+                for (int dy = -1; dy <= 1; ++dy)
+                    scanRow(hashCell(cx - 1, cy + dy, cz + dz), 3, scan);
+            }
+        });
+
+        // Large bodies: every cell within reach of the sphere, or the whole
+        // hash once that is cheaper, then the other large bodies.
+        pool.parallelFor(large.size(), 1, [&](size_t s, size_t e, unsigned w) {
+            std::vector<ContactPair>& local = perWorker[w];
+            for (size_t a = s; a < e; ++a) {
+                uint32_t i = large[a];
+                const Packed pi = { b.x[i], b.y[i], b.z[i], b.radius[i] };
+                auto scan = [&](uint32_t kBegin, uint32_t kEnd) {
+                    for (uint32_t k = kBegin; k < kEnd; ++k) {
+                        uint32_t j = sorted[k];
+                        if (overlap(pi, packed[k])) local.push_back({ std::min(i, j), std::max(i, j) });
+                    }
+                };
+                float reach = pi.r + 0.5f * cellSize;
+                int32_t x0 = cellCoord(pi.x - reach), x1 = cellCoord(pi.x + reach);
+                int32_t y0 = cellCoord(pi.y - reach), y1 = cellCoord(pi.y + reach);
+                int32_t z0 = cellCoord(pi.z - reach), z1 = cellCoord(pi.z + reach);
+                uint64_t nx = uint64_t(int64_t(x1) - x0 + 1);
+                uint64_t cells = nx * uint64_t(int64_t(y1) - y0 + 1) * uint64_t(int64_t(z1) - z0 + 1);
+                if (cells >= tableSize) {
+                    scan(0, bucketStart[tableSize]);
+                } else {
+                    for (int32_t cz = z0; cz <= z1; ++cz)
+                    for (int32_t cy = y0; cy <= y1; ++cy)
+                        scanRow(hashCell(x0, cy, cz), uint32_t(nx), scan);
+                }
+                for (size_t c = a + 1; c < large.size(); ++c) {
+                    uint32_t j = large[c];
+                    if (overlap(pi, { b.x[j], b.y[j], b.z[j], b.radius[j] }))
+                        local.push_back({ std::min(i, j), std::max(i, j) });
+                }
+            }
+        });
+
+        out.clear();
+        for (auto& v : perWorker) out.insert(out.end(), v.begin(), v.end());
+        std::sort(out.begin(), out.end());
+        // Distinct cells can share a hash bucket → the same pair may be found twice.
+        out.erase(std::unique(out.begin(), out.end(),
+                              [](const ContactPair& a, const ContactPair& c) {
+                                  return a.i == c.i && a.j == c.j;
+                              }),
+                  out.end());
+    }
+
+    float cell() const { return cellSize; }
+    size_t largeCount() const { return large.size(); }
+
+private:
+    struct Packed { float x, y, z, r; };
+
+    // Clamped a little inside the int32 range, so a body ejected far from the
+    // origin still gives a defined conversion and cx ± 1 or a loop up to it
+    // cannot overflow.  Far bodies then share edge cells; the narrow phase is
+    // exact, so only the broad phase gets slower.  NaN ends up at -lim.
+    int32_t cellCoord(float v) const {
+        const float lim = 2147483520.0f;   // 2^31 - 128, the largest float below 2^31
+        return int32_t(std::min(std::max(-lim, std::floor(v * invCellSize)), lim));
+    }
+
+    uint32_t hashCell(int32_t cx, int32_t cy, int32_t cz) const {
+        uint32_t h = uint32_t(cx) + uint32_t(cy) * 19349663u + uint32_t(cz) * 83492791u;
+        return h & uint32_t(mask);
+    }
+
+    static bool overlap(const Packed& p, const Packed& q) {
+        float ddx = q.x - p.x;
+        float ddy = q.y - p.y;
+        float ddz = q.z - p.z;
+        float rr  = p.r + q.r;
+        return ddx*ddx + ddy*ddy + ddz*ddz < rr*rr;
+    }
+
+    // `len` cells along x from bucket h are `len` consecutive buckets (mod table)
+    template <class Scan>
+    void scanRow(uint32_t h, uint32_t len, Scan& scan) const {
+        if (h + len <= tableSize) {
+            scan(bucketStart[h], bucketStart[h + len]);
+        } else {
+            scan(bucketStart[h], bucketStart[tableSize]);
+            scan(bucketStart[0], bucketStart[h + len - tableSize]);
+        }
+    }
+
+    size_t   n           = 0;
+    size_t   small       = 0;   // bodies in the hash
+    float    cellSize    = 1.0f;
+    float    invCellSize = 1.0f;
+    size_t   tableSize   = 0;
+    size_t   mask        = 0;
+
+    std::unique_ptr<std::atomic<uint32_t>[]> counts;
+    std::vector<uint32_t>                    bucketStart;
+    std::vector<uint32_t>                    cellOf;
+    std::vector<uint32_t>                    sorted;
+    std::vector<Packed>                      packed;    // hashed bodies in bucket order
+    std::vector<float>                       radii;     // scratch for the median
+    std::vector<uint32_t>                    large;     // bodies kept out of the hash
+    std::vector<std::vector<ContactPair>>    perWorker;
+};
+
+// Radius of a homogeneous sphere of the given mass and density, divided by the
+// scene scale factor (see sizeRatio in gravity_grid.cpp).
+inline float SphereRadius(float mass, float density, float sizeRatio) {
+    return float(std::cbrt((3.0 * mass / density) / (4.0 * M_PI))) / sizeRatio;
+}
+
+// Applies the chosen response to every contact.  Returns the number of
+// bodies that were merged away (their alive flag is cleared).
+inline size_t ResolveContacts(CollisionBodies& b, const std::vector<ContactPair>& pairs,
+                              CollisionMode mode, float sizeRatio,
+                              float restitution = 0.5f) {
+    size_t merged = 0;
+    for (const ContactPair& p : pairs) {
+        uint32_t i = p.i, j = p.j;
+        if (!b.alive[i] || !b.alive[j]) continue;
+
+        float dx = b.x[j] - b.x[i], dy = b.y[j] - b.y[i], dz = b.z[j] - b.z[i];
+        float dist2 = dx*dx + dy*dy + dz*dz;
+        float rr    = b.radius[i] + b.radius[j];
+        if (dist2 >= rr*rr) continue;   // already separated by an earlier contact
+
+        float mi = b.mass[i], mj = b.mass[j], M = mi + mj;
+
+        if (mode == CollisionMode::Merge) {
+            // The heavier body survives (and keeps its colour/identity).
+            uint32_t keep = (mj > mi) ? j : i;
+            uint32_t gone = (keep == i) ? j : i;
+            float volume = mi / b.density[i] + mj / b.density[j];
+
+            b.x[keep]  = (mi * b.x[i]  + mj * b.x[j])  / M;
+            b.y[keep]  = (mi * b.y[i]  + mj * b.y[j])  / M;
+            b.z[keep]  = (mi * b.z[i]  + mj * b.z[j])  / M;
+            b.vx[keep] = (mi * b.vx[i] + mj * b.vx[j]) / M;
+            b.vy[keep] = (mi * b.vy[i] + mj * b.vy[j]) / M;
+            b.vz[keep] = (mi * b.vz[i] + mj * b.vz[j]) / M;
+            b.mass[keep]    = M;
+            b.density[keep] = M / volume;
+            b.radius[keep]  = SphereRadius(M, b.density[keep], sizeRatio);
+            b.alive[gone]   = 0;
+            ++merged;
+        } else if (mode == CollisionMode::Bounce) {
+            float dist = std::sqrt(dist2);
+            if (dist <= 0.0f) continue;
+            float nx = dx / dist, ny = dy / dist, nz = dz / dist;
+
+            float vn = (b.vx[j] - b.vx[i]) * nx
+                     + (b.vy[j] - b.vy[i]) * ny
+                     + (b.vz[j] - b.vz[i]) * nz;
+            if (vn < 0.0f) {   // approaching
+                float jImp = -(1.0f + restitution) * vn / (1.0f / mi + 1.0f / mj);
+                b.vx[i] -= jImp / mi * nx;  b.vy[i] -= jImp / mi * ny;  b.vz[i] -= jImp / mi * nz;
+                b.vx[j] += jImp / mj * nx;  b.vy[j] += jImp / mj * ny;  b.vz[j] += jImp / mj * nz;
+            }
+
+            // Push apart along the normal, weighted by inverse mass.
+            float depth = rr - dist;
+            float si = depth * (mj / M), sj = depth * (mi / M);
+            b.x[i] -= si * nx;  b.y[i] -= si * ny;  b.z[i] -= si * nz;
+            b.x[j] += sj * nx;  b.y[j] += sj * ny;  b.z[j] += sj * nz;
+        }
+    }
+    return merged;
+}
+
+#endif // COLLISION_HPP
@@ -7,9 +7,19 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <string>
+#include <unordered_map>
 #include <cmath>
 
 #ifndef M_PI
@@ -23,6 +33,11 @@ const double SPEED_OF_LIGHT = 299792458.0;
 const double GRAVITATIONAL_CONSTANT = 6.67430e-11;
 
 
+// PROGRAMMES GLSL
+// Tout passe par BuildProgram, qui garde un cache de binaires sur disque (glGetProgramBinary) dans
+// shader_cache/, relatif au répertoire courant comme les fichiers .vert/.frag/.comp (pas à l'exécutable) :
+// clé = hash FNV-1a des sources + vendeur/renderer/version du driver, donc un changement de shader ou de
+// driver recompile tout seul.
 class ShaderUtils {
 public:
     static GLuint CompileShader(const char* source, GLenum type) {
@@ -33,96 +48,192 @@ public:
         GLint success;
         glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
         if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-            std::cerr << "Shader compilation failed: " << infoLog << std::endl;
+            GLint logLen = 0;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLen);
+            std::vector<char> log(std::max(logLen, 1));
+            glGetShaderInfoLog(shader, GLsizei(log.size()), nullptr, log.data());
+            std::cerr << "Shader compilation failed: " << log.data() << std::endl;
         }
         return shader;
     }
 
-    static GLuint CreateProgram(const char* vertexSource, const char* fragmentSource) {
-        GLuint vertexShader = CompileShader(vertexSource, GL_VERTEX_SHADER);
-        GLuint fragmentShader = CompileShader(fragmentSource, GL_FRAGMENT_SHADER);
-
+    // Programme à partir de ses étapes (type, source). Si ce source a déjà été linké par ce driver,
+    // on recharge le binaire au lieu de recompiler. fatal = on quitte en cas d'erreur.
+    static GLuint BuildProgram(std::initializer_list<std::pair<GLenum, const char*>> stages, bool fatal = false) {
+        std::string cachePath = ProgramCachePath(stages);
         GLuint program = glCreateProgram();
-        glAttachShader(program, vertexShader);
-        glAttachShader(program, fragmentShader);
+        if (!cachePath.empty() && LoadProgramBinary(program, cachePath)) return program;
+
+        bool compiled = true;
+        std::vector<GLuint> shaders;
+        for (const auto& stage : stages) {
+            GLuint shader = CompileShader(stage.second, stage.first);
+            GLint ok;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+            compiled = compiled && ok;
+            glAttachShader(program, shader);
+            shaders.push_back(shader);
+        }
+        if (!cachePath.empty()) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glLinkProgram(program);
 
-        GLint success;
-        glGetProgramiv(program, GL_LINK_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetProgramInfoLog(program, 512, nullptr, infoLog);
-            std::cerr << "Shader program linking failed: " << infoLog << std::endl;
+        GLint linked;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            GLint logLen = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLen);
+            std::vector<char> log(std::max(logLen, 1));
+            glGetProgramInfoLog(program, GLsizei(log.size()), nullptr, log.data());
+            std::cerr << "Shader program linking failed: " << log.data() << std::endl;
         }
-
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-
+        for (GLuint shader : shaders) {
+            glDetachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        if (!compiled || !linked) {
+            if (fatal) exit(EXIT_FAILURE);
+            return program;
+        }
+        if (!cachePath.empty()) SaveProgramBinary(program, cachePath);
         return program;
     }
 
-    static GLuint LoadProgramFromFiles(const char* vertPath, const char* fragPath) {
-        auto loadFile = [](const char* path) -> std::string {
-            std::ifstream in(path);
-            if (!in.is_open()) {
-                std::cerr << "Failed to open shader file: " << path << std::endl; // fichier introuvable, t'as oublié de le créer?
-                exit(EXIT_FAILURE);
-            }
-            std::stringstream ss;
-            ss << in.rdbuf();
-            return ss.str();
-        };
-
-        std::string vertSource = loadFile(vertPath);
-        std::string fragSource = loadFile(fragPath);
+    static GLuint CreateProgram(const char* vertexSource, const char* fragmentSource) {
+        return BuildProgram({ { GL_VERTEX_SHADER, vertexSource }, { GL_FRAGMENT_SHADER, fragmentSource } });
+    }
 
+    static GLuint LoadProgramFromFiles(const char* vertPath, const char* fragPath) {
+        std::string vertSource = LoadFile(vertPath);
+        std::string fragSource = LoadFile(fragPath);
         return CreateProgram(vertSource.c_str(), fragSource.c_str());
     }
 
     static GLuint LoadComputeShader(const char* path) {
+        std::string source = LoadFile(path);
+        return BuildProgram({ { GL_COMPUTE_SHADER, source.c_str() } }, true);   // pas de compute shader = pas de rendu, on quitte
+    }
+
+private:
+    static constexpr const char* kProgramCacheDir = "shader_cache";
+    static constexpr uint32_t    kProgramCacheMagic = 0x42504842;   // "BHPB"
+
+    static std::string LoadFile(const char* path) {
         std::ifstream in(path);
         if (!in.is_open()) {
-            std::cerr << "Failed to open compute shader: " << path << std::endl; // pas trouvé le compute shader, cherche mieux mec
+            std::cerr << "Failed to open shader file: " << path << std::endl; // fichier introuvable, t'as oublié de le créer?
             exit(EXIT_FAILURE);
         }
         std::stringstream ss;
         ss << in.rdbuf();
-        std::string srcStr = ss.str();
-        const char* src = srcStr.c_str();
-
-        GLuint cs = glCreateShader(GL_COMPUTE_SHADER);
-        glShaderSource(cs, 1, &src, nullptr);
-        glCompileShader(cs);
-
-        GLint ok;
-        glGetShaderiv(cs, GL_COMPILE_STATUS, &ok);
-        if (!ok) {
-            GLint logLen;
-            glGetShaderiv(cs, GL_INFO_LOG_LENGTH, &logLen);
-            std::vector<char> log(logLen);
-            glGetShaderInfoLog(cs, logLen, nullptr, log.data());
-            std::cerr << "Compute shader compile error:\n" << log.data() << std::endl; // erreur de compil dans le compute shader, gg
-            exit(EXIT_FAILURE);
+        return ss.str();
+    }
+
+    // Chemin du binaire en cache, ou "" si le driver ne sait pas sortir de binaires
+    static std::string ProgramCachePath(std::initializer_list<std::pair<GLenum, const char*>> stages) {
+        if (!(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) return "";
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (formats <= 0) return "";
+
+        uint64_t h = 1469598103934665603ull;   // FNV-1a 64 bits
+        auto mix = [&h](const void* data, size_t n) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+            h ^= 0xff; h *= 1099511628211ull;  // séparateur, pour que "ab"+"c" ≠ "a"+"bc"
+        };
+        for (const auto& stage : stages) {
+            mix(&stage.first, sizeof(stage.first));
+            mix(stage.second, strlen(stage.second));
         }
+        for (GLenum e : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* str = reinterpret_cast<const char*>(glGetString(e));
+            if (str) mix(str, strlen(str));
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(h));
+        return std::string(kProgramCacheDir) + "/" + name;
+    }
 
-        GLuint prog = glCreateProgram();
-        glAttachShader(prog, cs);
-        glLinkProgram(prog);
-        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
-        if (!ok) {
-            GLint logLen;
-            glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &logLen);
-            std::vector<char> log(logLen);
-            glGetProgramInfoLog(prog, logLen, nullptr, log.data());
-            std::cerr << "Compute shader link error:\n" << log.data() << std::endl; // le link du compute shader a planté, aïe
-            exit(EXIT_FAILURE);
+    static bool LoadProgramBinary(GLuint program, const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        uint32_t header[2];   // magic, format
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != kProgramCacheMagic) return false;
+        std::vector<char> blob((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (blob.empty()) return false;
+        glProgramBinary(program, GLenum(header[1]), blob.data(), GLsizei(blob.size()));
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        return ok == GL_TRUE;   // refusé (driver mis à jour entre-temps…) : on recompile et on écrase
+    }
+
+    static void SaveProgramBinary(GLuint program, const std::string& path) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<char> blob(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, blob.data());
+        if (length <= 0) return;
+
+        // fichier temporaire + rename : deux instances lancées en même temps ne lisent jamais un binaire à moitié écrit
+        std::error_code ec;
+        std::filesystem::create_directories(kProgramCacheDir, ec);
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return;
+            uint32_t header[2] = { kProgramCacheMagic, uint32_t(format) };
+            out.write(reinterpret_cast<const char*>(header), sizeof(header));
+            out.write(blob.data(), length);
+            if (!out) return;
         }
+        std::filesystem::rename(tmp, path, ec);
+    }
+};
 
-        glDeleteShader(cs);
-        return prog;
+// PROGRAMME AVEC SES UNIFORMS (réflexion au link, plus de glGetUniformLocation par chaîne dans la boucle)
+// Se convertit en GLuint, donc remplace un GLuint de programme partout (glUseProgram, glDeleteProgram…).
+// Les emplacements se récupèrent une fois à l'init avec uniform("nom") et se gardent dans des GLint.
+class ShaderProgram {
+public:
+    ShaderProgram() = default;
+    explicit ShaderProgram(GLuint program) { reset(program); }
+
+    void reset(GLuint program) {
+        id = program;
+        locations.clear();
+        GLint count = 0, maxLen = 0;
+        glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+        std::vector<char> name(std::max(maxLen, 1));
+        for (GLint i = 0; i < count; ++i) {
+            GLint size;
+            GLenum type;
+            GLsizei len = 0;
+            glGetActiveUniform(id, GLuint(i), GLsizei(name.size()), &len, &size, &type, name.data());
+            std::string n(name.data(), len);
+            GLint loc = glGetUniformLocation(id, n.c_str());
+            if (loc < 0) continue;   // membre d'un bloc uniform : pas d'emplacement
+            locations[n] = loc;
+            if (n.size() > 3 && n.compare(n.size() - 3, 3, "[0]") == 0)
+                locations[n.substr(0, n.size() - 3)] = loc;   // "tab[0]" se demande aussi "tab"
+        }
+    }
+
+    // -1 si le uniform n'existe pas (ou a été éliminé par le compilateur), comme glGetUniformLocation
+    GLint uniform(const std::string& name) const {
+        auto it = locations.find(name);
+        if (it != locations.end()) return it->second;
+        std::cerr << "[Shader] uniform '" << name << "' absent du programme " << id << std::endl;
+        return -1;
     }
+
+    operator GLuint() const { return id; }
+
+private:
+    GLuint id = 0;
+    std::unordered_map<std::string, GLint> locations;
 };
 
 //  GESTIONNAIRE DE FENÊTRE (parce que GLFW c'est relou à setup)
@@ -175,7 +286,7 @@ public:
 class FullScreenQuad {
 private:
     GLuint VAO, VBO;
-    GLuint shaderProgram;
+    ShaderProgram shaderProgram;
 
 public:
     FullScreenQuad() {
@@ -198,7 +309,9 @@ public:
             FragColor = texture(screenTexture, TexCoord);
         })";
 
-        shaderProgram = ShaderUtils::CreateProgram(vertexShaderSource, fragmentShaderSource);
+        shaderProgram.reset(ShaderUtils::CreateProgram(vertexShaderSource, fragmentShaderSource));
+        glUseProgram(shaderProgram);
+        glUniform1i(shaderProgram.uniform("screenTexture"), 0);   // toujours l'unité 0, une fois pour toutes
 
         float quadVertices[] = {
             // positions   // coords de texture
@@ -229,7 +342,6 @@ public:
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, texture);
-        glUniform1i(glGetUniformLocation(shaderProgram, "screenTexture"), 0);
 
         glDisable(GL_DEPTH_TEST);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -243,6 +355,340 @@ public:
     }
 };
 
+// BUFFER DE STREAMING (pour les données qui changent à chaque frame sans faire ramer le driver)
+// Un anneau de `frames` régions dans un seul buffer GL. Chaque frame écrit dans sa région,
+// endFrame() pose une fence, et on ne réécrit une région que quand le GPU a fini de la lire.
+// Une frame qui n'écrit rien relit la dernière région écrite : endFrame() re-clôture alors cette
+// région, pour qu'une rafale d'écritures qui y revient attende la dernière lecture, pas l'écriture.
+// Avec GL 4.4 / ARB_buffer_storage le buffer est mappé une fois pour toutes (persistant + cohérent) ;
+// sinon (GL 3.3, macOS) on map en UNSYNCHRONIZED et on orpheline le buffer quand l'anneau est plein.
+// Usage : map()/unmap() ou upload(), puis on rebinde id() à l'offset renvoyé.
+// Quand une frame déborde, le buffer est remplacé par un plus grand ; l'ancien est gardé (avec tout
+// ce qui y est déjà écrit ou bindé) tant que l'anneau ne l'aurait pas recyclé et que le GPU s'en sert.
+class StreamingBuffer {
+public:
+    StreamingBuffer() = default;
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+    ~StreamingBuffer() { release(); }
+
+    void create(size_t bytesPerFrame, int frameCount = 3) {
+        release();
+        frames = std::max(1, std::min(frameCount, MAX_FRAMES));
+        persistentMode = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+        allocate(std::max<size_t>(bytesPerFrame, 256));
+    }
+
+    // Réserve `bytes` octets dans la région de la frame courante. Le pointeur reste valide jusqu'à unmap().
+    void* map(size_t bytes, size_t align = 16) {
+        if (!buffer) create(bytes);
+        size_t offset = (head + align - 1) / align * align;
+        if (persistentMode) {
+            if (offset + bytes > regionSize) {
+                // Ça ne rentre pas : on agrandit (rare, seulement quand la géométrie grossit)
+                allocate(std::max(regionSize * 2, bytes + align));
+                if (!persistentMode) return map(bytes, align);   // le mapping persistant a échoué, on passe au repli
+                offset = 0;
+            }
+            if (!used) waitRegion(region);    // première écriture de la frame : le GPU doit avoir fini avec cette région
+            lastOffset = GLintptr(region * regionSize + offset);
+            head = offset + bytes;
+            used = true;
+            liveRegion = region;
+            return mapped + lastOffset;
+        }
+
+        // Repli GL 3.3 : l'anneau couvre tout le buffer. On n'orpheline qu'en début de frame
+        // (sinon ce qui a déjà été écrit cette frame partirait avec l'ancien stockage)
+        size_t total = regionSize * frames;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        if (!used && head + regionSize > total) {
+            glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW);   // nouveau stockage, l'ancien vit tant que le GPU s'en sert
+            head = 0;
+        }
+        offset = (head + align - 1) / align * align;
+        if (offset + bytes > total) {
+            // La frame déborde de l'anneau : nouveau buffer plus grand, l'ancien reste attaché à ce qui l'utilise
+            allocate(std::max(regionSize * 2, bytes + align));
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            offset = 0;
+        }
+        void* p = bytes ? glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, bytes,
+                                           GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT)
+                        : nullptr;   // mapper 0 octet c'est une erreur GL
+        rangeMapped = p != nullptr;
+        lastOffset = GLintptr(offset);
+        head = offset + bytes;
+        used = true;
+        return p;
+    }
+
+    // Termine l'écriture, renvoie l'offset de la région dans id()
+    GLintptr unmap() {
+        if (rangeMapped) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            rangeMapped = false;
+        }
+        return lastOffset;
+    }
+
+    GLintptr upload(const void* data, size_t bytes, size_t align = 16) {
+        void* dst = map(bytes, align);
+        if (dst && bytes) std::memcpy(dst, data, bytes);
+        return unmap();
+    }
+
+    // À appeler une fois par frame, après les draws qui lisent ce buffer
+    void endFrame() {
+        if (!used) {
+            // Rien écrit : les draws de cette frame ont lu la dernière région écrite, la fence
+            // doit suivre cette lecture (le repli ne réécrit jamais sous les données vivantes)
+            if (persistentMode && liveRegion >= 0) fenceRegion(liveRegion);
+            return;
+        }
+        if (persistentMode) {
+            fenceRegion(region);
+            region = (region + 1) % frames;
+            head = 0;
+        }
+        used = false;
+        ++writtenFrames;
+        collectRetired();
+    }
+
+    GLuint id() const { return buffer; }
+    bool persistent() const { return persistentMode; }
+
+    void release() {
+        for (auto& f : fences) {
+            if (f) glDeleteSync(f);
+            f = nullptr;
+        }
+        for (auto& r : retired) {
+            if (r.fence) glDeleteSync(r.fence);
+            glDeleteBuffers(1, &r.buffer);   // supprimer un buffer mappé le démappe
+        }
+        retired.clear();
+        if (buffer) {
+            if (persistentMode && mapped) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            }
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = 0;
+        mapped = nullptr;
+        region = 0;
+        liveRegion = -1;
+        head = 0;
+        used = false;
+    }
+
+private:
+    static constexpr int MAX_FRAMES = 4;
+
+    void allocate(size_t bytesPerFrame) {
+        // Pas de glDeleteBuffers ici : ça débinderait les ranges déjà bindés cette frame (UBO, SSBO…).
+        // L'ancien buffer part à la retraite, sa fence sera posée par endFrame() après les draws qui le lisent.
+        // Le nouveau est vierge, donc aucune région à attendre.
+        for (auto& f : fences) {
+            if (f) glDeleteSync(f);
+            f = nullptr;
+        }
+        if (buffer) retired.push_back({ buffer, nullptr, writtenFrames });
+
+        regionSize = (bytesPerFrame + 255) / 256 * 256;   // les régions restent alignées pour les UBO
+        GLsizeiptr total = GLsizeiptr(regionSize * frames);
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        if (persistentMode) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags);
+            mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags));
+            if (!mapped) {
+                std::cerr << "[Streaming] persistent mapping failed, falling back to orphaning" << std::endl;
+                glDeleteBuffers(1, &buffer);
+                persistentMode = false;
+                glGenBuffers(1, &buffer);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            }
+        }
+        if (!persistentMode) glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        region = 0;
+        liveRegion = -1;
+        head = 0;
+    }
+
+    // Libère les anciens buffers dont l'anneau aurait recyclé le contenu et que le GPU a fini de lire
+    void collectRetired() {
+        for (size_t k = 0; k < retired.size();) {
+            Retired& r = retired[k];
+            if (!r.fence) r.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);   // après les draws de la frame du remplacement
+            bool done = writtenFrames - r.since > unsigned(frames) &&
+                        glClientWaitSync(r.fence, 0, 0) != GL_TIMEOUT_EXPIRED;
+            if (!done) { ++k; continue; }
+            glDeleteSync(r.fence);
+            glDeleteBuffers(1, &r.buffer);
+            retired[k] = retired.back();
+            retired.pop_back();
+        }
+    }
+
+    void fenceRegion(int r) {
+        if (fences[r]) glDeleteSync(fences[r]);
+        fences[r] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    void waitRegion(int r) {
+        GLsync f = fences[r];
+        if (!f) return;
+        GLenum s = glClientWaitSync(f, 0, 0);
+        while (s == GL_TIMEOUT_EXPIRED)
+            s = glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);   // 1 ms
+        glDeleteSync(f);
+        fences[r] = nullptr;
+    }
+
+    GLuint   buffer = 0;
+    uint8_t* mapped = nullptr;
+    bool     persistentMode = false;
+    int      frames = 3;
+    int      region = 0;
+    int      liveRegion = -1;   // région de la dernière écriture, encore lue tant que rien ne la remplace
+    size_t   regionSize = 0;
+    size_t   head = 0;
+    bool     used = false;
+    bool     rangeMapped = false;
+    GLintptr lastOffset = 0;
+    GLsync   fences[MAX_FRAMES] = {};
+
+    struct Retired {
+        GLuint   buffer;
+        GLsync   fence;
+        unsigned since;   // writtenFrames au remplacement
+    };
+    std::vector<Retired> retired;
+    unsigned writtenFrames = 0;
+};
+
+// CHRONOS GPU (pour savoir quelle étape mange la frame côté GPU, pas seulement côté CPU)
+// Une requête GL_TIME_ELAPSED par étape, en double : pendant que la frame N mesure dans un jeu,
+// on lit les résultats de la frame N-1 dans l'autre, seulement s'ils sont disponibles, donc jamais d'attente.
+// Si le GPU a encore deux frames de retard, l'étape n'est pas mesurée cette fois plutôt que de bloquer.
+// Les étapes ne doivent pas se chevaucher (une seule requête TIME_ELAPSED active à la fois).
+// Timer queries = GL 3.3 core, ça marche aussi sur llvmpipe.
+class GpuTimer {
+public:
+    GpuTimer() = default;
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+    ~GpuTimer() { release(); }
+
+    // Les noms servent au rapport, l'indice de chaque nom est celui à passer à begin()/end()
+    void create(std::initializer_list<const char*> names) {
+        release();
+        supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+        for (const char* n : names) {
+            Stage s;
+            s.name = n;
+            if (supported) glGenQueries(2, s.queries);
+            stages.push_back(s);
+        }
+        lastFrame = std::chrono::steady_clock::now();
+    }
+
+    void begin(int stage) {
+        if (!supported || stage < 0 || stage >= int(stages.size())) return;
+        Stage& s = stages[stage];
+        if (s.pending[slot]) collect(s, slot);
+        if (s.pending[slot]) return;
+        glBeginQuery(GL_TIME_ELAPSED, s.queries[slot]);
+        s.started[slot] = std::chrono::steady_clock::now();
+        s.active = true;
+    }
+
+    void end(int stage) {
+        if (!supported || stage < 0 || stage >= int(stages.size())) return;
+        Stage& s = stages[stage];
+        if (!s.active) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        s.active = false;
+        s.pending[slot] = true;
+    }
+
+    // À appeler une fois par frame (avant le swap) : temps CPU de la frame, puis on bascule de jeu
+    // et on récupère ce que la frame précédente a déjà produit
+    void endFrame() {
+        auto now = std::chrono::steady_clock::now();
+        cpuMs += std::chrono::duration<double, std::milli>(now - lastFrame).count();
+        ++cpuFrames;
+        lastFrame = now;
+        slot ^= 1;
+        for (Stage& s : stages)
+            if (s.pending[slot]) collect(s, slot);
+    }
+
+    // "[GPU] frame 16.7 ms CPU (60 fps) | calcul 12.31 ms  grille 0.20 ms" — moyennes depuis le dernier rapport
+    void report(std::ostream& os) {
+        double frameMs = cpuFrames ? cpuMs / cpuFrames : 0.0;
+        os << "[GPU] frame " << std::fixed << std::setprecision(1) << frameMs << " ms CPU ("
+           << (frameMs > 0.0 ? 1000.0 / frameMs : 0.0) << " fps) |";
+        if (!supported) os << " pas de timer queries";
+        for (Stage& s : stages) {
+            os << "  " << s.name << " ";
+            if (s.samples) os << std::setprecision(2) << (s.totalNs / s.samples) * 1e-6 << " ms";
+            else           os << "-";
+            s.totalNs = 0.0;
+            s.samples = 0;
+        }
+        os << std::defaultfloat << std::setprecision(6) << std::endl;
+        cpuMs = 0.0;
+        cpuFrames = 0;
+    }
+
+    void release() {
+        if (supported)
+            for (Stage& s : stages) glDeleteQueries(2, s.queries);
+        stages.clear();
+        slot = 0;
+    }
+
+private:
+    struct Stage {
+        const char* name = "";
+        GLuint queries[2] = {};
+        bool   pending[2] = {};
+        std::chrono::steady_clock::time_point started[2];
+        bool   active = false;
+        double totalNs = 0.0;
+        size_t samples = 0;
+    };
+
+    void collect(Stage& s, int which) {
+        GLint available = 0;
+        glGetQueryObjectiv(s.queries[which], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(s.queries[which], GL_QUERY_RESULT, &ns);
+        s.pending[which] = false;
+        // Une étape GPU ne peut pas durer plus que le temps réel écoulé depuis son begin().
+        // llvmpipe renvoie l'uptime de la machine pour la toute première requête du contexte, on la jette.
+        double wallNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - s.started[which]).count();
+        if (double(ns) > wallNs + 1e6) return;
+        s.totalNs += double(ns);
+        ++s.samples;
+    }
+
+    std::vector<Stage> stages;
+    bool   supported = false;
+    int    slot = 0;
+    double cpuMs = 0.0;
+    size_t cpuFrames = 0;
+    std::chrono::steady_clock::time_point lastFrame;
+};
+
 // CAMÉRA ORBITALE (pour tourner autour du bordel qu'on simule)
 class OrbitCamera {
 public:
@@ -354,59 +800,109 @@ public:
 };
 
 // GÉNÉRATEUR DE SPHÈRES (pour faire des boules en 3D tranquille)
+// Sphère unité indexée : un seul sommet par pôle, (stacks - 1) anneaux de `sectors` sommets, zéro triangle
+// dégénéré. Le rayon et la position passent par la matrice model, donc un même mesh sert à tous les objets.
+struct SphereMesh {
+    GLuint  VAO = 0, VBO = 0, EBO = 0;
+    GLsizei indexCount = 0;
+};
+
 class SphereGenerator {
 public:
-    static std::vector<float> GenerateVertices(float radius, int stacks = 25, int sectors = 25) {
-        std::vector<float> vertices;
-
-        for (float i = 0.0f; i <= stacks; ++i) {
-            float theta1 = (i / stacks) * float(M_PI);
-            float theta2 = ((i + 1) / stacks) * float(M_PI);
-
-            for (float j = 0.0f; j < sectors; ++j) {
-                float phi1 = (j / sectors) * 2.0f * float(M_PI);
-                float phi2 = ((j + 1) / sectors) * 2.0f * float(M_PI);
-
-                auto sphericalToCartesian = [](float r, float theta, float phi) -> vec3 {
-                    return vec3(
-                        r * sin(theta) * cos(phi),
-                        r * cos(theta),
-                        r * sin(theta) * sin(phi)
-                    );
-                };
-
-                vec3 v1 = sphericalToCartesian(radius, theta1, phi1);
-                vec3 v2 = sphericalToCartesian(radius, theta1, phi2);
-                vec3 v3 = sphericalToCartesian(radius, theta2, phi1);
-                vec3 v4 = sphericalToCartesian(radius, theta2, phi2);
-
-                // Triangle 1
-                vertices.insert(vertices.end(), {v1.x, v1.y, v1.z});
-                vertices.insert(vertices.end(), {v2.x, v2.y, v2.z});
-                vertices.insert(vertices.end(), {v3.x, v3.y, v3.z});
-
-                // Triangle 2
-                vertices.insert(vertices.end(), {v2.x, v2.y, v2.z});
-                vertices.insert(vertices.end(), {v4.x, v4.y, v4.z});
-                vertices.insert(vertices.end(), {v3.x, v3.y, v3.z});
+    static void GenerateIndexed(int stacks, int sectors, std::vector<float>& vertices, std::vector<GLushort>& indices) {
+        stacks = std::max(stacks, 2);
+        sectors = std::max(sectors, 3);
+        vertices.clear();
+        indices.clear();
+
+        // pôle nord (0), anneaux i = 1..stacks-1, pôle sud (dernier)
+        vertices.insert(vertices.end(), { 0.0f, 1.0f, 0.0f });
+        for (int i = 1; i < stacks; ++i) {
+            float theta = float(i) / float(stacks) * float(M_PI);
+            for (int j = 0; j < sectors; ++j) {
+                float phi = float(j) / float(sectors) * 2.0f * float(M_PI);
+                vertices.insert(vertices.end(), { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) });
             }
         }
-
-        return vertices;
+        vertices.insert(vertices.end(), { 0.0f, -1.0f, 0.0f });
+
+        auto ring = [sectors](int i, int j) { return GLushort(1 + (i - 1) * sectors + j % sectors); };
+        const GLushort south = GLushort(vertices.size() / 3 - 1);
+        for (int j = 0; j < sectors; ++j)   // calotte nord
+            indices.insert(indices.end(), { GLushort(0), ring(1, j + 1), ring(1, j) });
+        for (int i = 1; i < stacks - 1; ++i) {
+            for (int j = 0; j < sectors; ++j) {
+                GLushort a = ring(i, j), b = ring(i, j + 1), c = ring(i + 1, j), d = ring(i + 1, j + 1);
+                indices.insert(indices.end(), { a, b, c, b, d, c });
+            }
+        }
+        for (int j = 0; j < sectors; ++j)   // calotte sud
+            indices.insert(indices.end(), { ring(stacks - 1, j), ring(stacks - 1, j + 1), south });
     }
 
-    static void CreateVAO(GLuint& VAO, GLuint& VBO, const std::vector<float>& vertices) {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
+    static SphereMesh CreateMesh(int stacks, int sectors) {
+        std::vector<float> vertices;
+        std::vector<GLushort> indices;
+        GenerateIndexed(stacks, sectors, vertices, indices);
 
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        SphereMesh mesh;
+        mesh.indexCount = GLsizei(indices.size());
+        glGenVertexArrays(1, &mesh.VAO);
+        glGenBuffers(1, &mesh.VBO);
+        glGenBuffers(1, &mesh.EBO);
+
+        glBindVertexArray(mesh.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
         glBindVertexArray(0);
+        return mesh;
+    }
+};
+
+// CACHE DE SPHÈRES PAR NIVEAU DE DÉTAIL
+// Quelques tessellations partagées par tous les objets, construites à la première demande. Le niveau
+// vient de la taille de l'objet à l'écran : une planète de 3 pixels n'a pas besoin de 2000 triangles.
+class SphereMeshCache {
+public:
+    static constexpr int kLevels = 4;   // 8x4, 16x8, 32x16, 64x32 (secteurs x tranches)
+
+    const SphereMesh& get(int level) {
+        level = std::max(0, std::min(kLevels - 1, level));
+        SphereMesh& mesh = meshes[level];
+        if (mesh.VAO == 0) {
+            int sectors = 8 << level;
+            mesh = SphereGenerator::CreateMesh(sectors / 2, sectors);
+        }
+        return mesh;
     }
+
+    // Diamètre projeté en pixels (perspective, fovY en radians) -> niveau
+    static int SelectLevel(float radius, float distance, float fovY, int viewportHeight) {
+        if (distance <= radius) return kLevels - 1;   // caméra dedans ou collée : plein détail
+        float pixels = radius / (distance * tanf(0.5f * fovY)) * float(viewportHeight);
+        if (pixels < 8.0f)   return 0;
+        if (pixels < 32.0f)  return 1;
+        if (pixels < 128.0f) return 2;
+        return 3;
+    }
+
+    void release() {
+        for (SphereMesh& mesh : meshes) {
+            if (mesh.VAO == 0) continue;
+            glDeleteVertexArrays(1, &mesh.VAO);
+            glDeleteBuffers(1, &mesh.VBO);
+            glDeleteBuffers(1, &mesh.EBO);
+            mesh = SphereMesh();
+        }
+    }
+
+private:
+    SphereMesh meshes[kLevels];
 };
 
 
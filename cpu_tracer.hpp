@@ -0,0 +1,329 @@
+// cpu_tracer.hpp
+// Per-pixel kernel of the CPU Schwarzschild ray tracer (BlackHole_space_cpu).
+//
+// Rays are stepped four at a time, one per SIMD lane, by either
+// PhysicsASM::GeodesicRK4 (spherical) or PhysicsASM::CartesianRK4, or lane by
+// lane through their plain C++ references (the scalar tracer).  A lane whose
+// ray terminates is refilled with the band's next pixel, so the packet stays
+// full until the band runs out.
+//
+// The integrator, the accretion disk and the scene objects are fixed for a
+// whole frame, so TraceBand is a template over them: each instantiation keeps
+// only the tests it needs inside the step loop, and Select() picks one from a
+// table once per frame.  Nothing here depends on GL or GLM, so the benchmark
+// can time every instantiation on its own.
+
+#ifndef CPU_TRACER_HPP
+#define CPU_TRACER_HPP
+
+#include "physics_asm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace CpuTracer {
+
+enum class Integrator { Spherical, Cartesian };
+
+// Sphere the rays can hit, shaded with a headlight from the camera
+struct Sphere {
+    float x, y, z, radius;
+    float r, g, b, a;
+};
+
+// Everything a band needs for one frame; the kernel only reads it
+struct Frame {
+    float camPos[3] = {}, right[3] = {}, up[3] = {}, fwd[3] = {};
+    float tanHFov = 1.0f, aspect = 1.0f;
+    float rs = 0.0f;                    // horizon, and the rs passed to the integrator
+    float diskR1 = 0.0f, diskR2 = 0.0f; // equatorial disk, y = 0
+    float escapeR = 1e30f;
+    float dLambda = 1e7f;
+    int   maxSteps = 60000;
+    const Sphere* objects = nullptr;
+    int   objectCount = 0;
+    uint64_t objectsVersion = 0;        // changes with objects[]; GPU backends re-upload only then (0: every frame)
+    int   width = 0, height = 0;
+    uint8_t* rgba = nullptr;            // width × height × 4
+};
+
+// Camera basis looking from pos to target, y up (as OrbitCamera)
+inline void LookAt(Frame& f, const float pos[3], const float target[3], float fovYDeg, float aspect) {
+    auto normalize = [](float* v) {
+        float inv = 1.0f / std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        v[0] *= inv;  v[1] *= inv;  v[2] *= inv;
+    };
+    auto cross = [](const float* a, const float* b, float* o) {
+        o[0] = a[1] * b[2] - a[2] * b[1];
+        o[1] = a[2] * b[0] - a[0] * b[2];
+        o[2] = a[0] * b[1] - a[1] * b[0];
+    };
+    const float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+    for (int k = 0; k < 3; ++k) { f.camPos[k] = pos[k];  f.fwd[k] = target[k] - pos[k]; }
+    normalize(f.fwd);
+    cross(f.fwd, worldUp, f.right);
+    normalize(f.right);
+    cross(f.right, f.fwd, f.up);
+    f.tanHFov = std::tan(fovYDeg * 0.5f * 3.14159265f / 180.0f);
+    f.aspect  = aspect;
+}
+
+namespace detail {
+
+struct V3 { float x, y, z; };
+inline V3    operator+(V3 a, V3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline V3    operator-(V3 a, V3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline V3    operator*(float s, V3 a) { return { s * a.x, s * a.y, s * a.z }; }
+inline float Dot(V3 a, V3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Length(V3 a) { return std::sqrt(Dot(a, a)); }
+inline V3    Normalize(V3 a) { return (1.0f / Length(a)) * a; }
+inline V3    Cross(V3 a, V3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+inline V3    Load(const float* v) { return { v[0], v[1], v[2] }; }
+
+// Spherical state of a ray leaving pos along dir, with E from the null condition
+inline void InitSpherical(GeodesicPacket& p, int l, V3 pos, V3 dir, float rs) {
+    float r     = Length(pos);
+    float theta = std::acos(pos.z / r);
+    float phi   = std::atan2(pos.y, pos.x);
+
+    float st = std::sin(theta), ct = std::cos(theta);
+    float sp = std::sin(phi),   cp = std::cos(phi);
+
+    float dr     =  st*cp*dir.x + st*sp*dir.y + ct*dir.z;
+    float dtheta = (ct*cp*dir.x + ct*sp*dir.y - st*dir.z) / r;
+    float dphi   = (-sp*dir.x  + cp*dir.y)               / (r * st);
+
+    float f     = 1.0f - rs / r;
+    float dt_dL = std::sqrt((dr * dr) / f + r * r * (dtheta * dtheta + st * st * dphi * dphi));
+    p.r[l]  = r;   p.theta[l]  = theta;   p.phi[l]  = phi;
+    p.dr[l] = dr;  p.dtheta[l] = dtheta;  p.dphi[l] = dphi;
+    p.E[l]  = f * dt_dL;
+}
+
+// Exact photon orbit without trig: position, direction and the conserved |x × v|²
+inline void InitCartesian(CartesianPacket& p, int l, V3 pos, V3 dir) {
+    p.x[l]  = pos.x;  p.y[l]  = pos.y;  p.z[l]  = pos.z;
+    p.vx[l] = dir.x;  p.vy[l] = dir.y;  p.vz[l] = dir.z;
+    V3 h    = Cross(pos, dir);
+    p.h2[l] = Dot(h, h);
+}
+
+} // namespace detail
+
+// What ended a ray, and where
+enum class Hit { Escaped, Captured, Disk, Object, MaxSteps };
+
+struct Termination {
+    Hit       hit;
+    int       object;       // index into Frame::objects for Hit::Object, else -1
+    int       steps;
+    detail::V3 position;
+    detail::V3 direction;   // unit tangent at the end (the exit direction of an escaped ray)
+};
+
+// Steps the rays that src hands out until each one ends, and reports it to
+// sink.  Source: bool next(int& id, V3& pos, V3& dir), dir normalised.
+// Sink: void finish(int id, const Termination&).  Only the scene part of the
+// frame is read here; the camera and rgba belong to the pixel source/sink.
+// Simd = false steps through the C++ references.
+template <Integrator I, bool Disk, bool Objects, bool Simd, class Source, class Sink>
+void TraceRays(const Frame& f, Source& src, Sink& sink) {
+    using namespace detail;
+    constexpr bool cartesian = I == Integrator::Cartesian;
+
+    GeodesicPacket  pk;
+    CartesianPacket cp;
+    int  ray[4], steps[4];
+    V3   prevPos[4];
+
+    auto loadLane = [&](int l) {
+        V3 pos, dir;
+        if (!src.next(ray[l], pos, dir)) {
+            // Idle lane: a far, motionless ray keeps the SIMD math finite
+            ray[l] = -1;
+            if constexpr (cartesian) {
+                InitCartesian(cp, l, V3{ 1e3f * f.rs, 0.0f, 0.0f }, V3{ 0.0f, 0.0f, 0.0f });
+            } else {
+                pk.r[l] = 1e3f * f.rs;  pk.theta[l] = 1.0f;  pk.phi[l] = 0.0f;
+                pk.dr[l] = pk.dtheta[l] = pk.dphi[l] = 0.0f;  pk.E[l] = 1.0f;
+            }
+            return;
+        }
+        if constexpr (cartesian) InitCartesian(cp, l, pos, dir);
+        else                     InitSpherical(pk, l, pos, dir, f.rs);
+        prevPos[l] = pos;
+        steps[l] = 0;
+    };
+
+    auto position = [&](int l) {
+        if constexpr (cartesian) return V3{ cp.x[l], cp.y[l], cp.z[l] };
+        else                     return V3{ pk.x[l], pk.y[l], pk.z[l] };
+    };
+    auto radius = [&](int l) {
+        if constexpr (cartesian) return Length(position(l));
+        else                     return pk.r[l];
+    };
+    // dx/dλ: stored as such in Cartesian form, from the spherical derivatives otherwise
+    auto direction = [&](int l) {
+        if constexpr (cartesian) {
+            return Normalize(V3{ cp.vx[l], cp.vy[l], cp.vz[l] });
+        } else {
+            float r = pk.r[l];
+            float st = std::sin(pk.theta[l]), ct = std::cos(pk.theta[l]);
+            float sp = std::sin(pk.phi[l]),   cph = std::cos(pk.phi[l]);
+            float dr = pk.dr[l], dth = r * pk.dtheta[l], dph = r * st * pk.dphi[l];
+            return Normalize(V3{ dr*st*cph + dth*ct*cph - dph*sp,
+                                 dr*st*sp  + dth*ct*sp  + dph*cph,
+                                 dr*ct     - dth*st });
+        }
+    };
+
+    // Reports the lane's ray and refills the lane
+    auto finishLane = [&](int l, Hit hit, int object, V3 P) {
+        sink.finish(ray[l], Termination{ hit, object, steps[l], P, direction(l) });
+        loadLane(l);
+    };
+
+    for (int l = 0; l < 4; ++l) loadLane(l);
+
+    while (ray[0] >= 0 || ray[1] >= 0 || ray[2] >= 0 || ray[3] >= 0) {
+        // Same termination order as a single ray: step cap and horizon before the step...
+        for (int l = 0; l < 4; ++l) {
+            while (ray[l] >= 0 && (steps[l] == f.maxSteps || radius(l) <= f.rs))
+                finishLane(l, steps[l] < f.maxSteps ? Hit::Captured : Hit::MaxSteps, -1, prevPos[l]);
+        }
+
+        if constexpr (cartesian && Simd)  PhysicsASM::CartesianRK4(&cp, 1, f.dLambda, f.rs);
+        else if constexpr (cartesian)     PhysicsASM::CartesianRK4Reference(&cp, 1, f.dLambda, f.rs);
+        else if constexpr (Simd)          PhysicsASM::GeodesicRK4(&pk, 1, f.dLambda, f.rs);
+        else                              PhysicsASM::GeodesicRK4Reference(&pk, 1, f.dLambda, f.rs);
+
+        // ...then disk, objects and escape after it
+        for (int l = 0; l < 4; ++l) {
+            if (ray[l] < 0) continue;
+            ++steps[l];
+            V3 P = position(l);
+            if constexpr (Disk) {
+                float rd = std::sqrt(P.x * P.x + P.z * P.z);
+                if (prevPos[l].y * P.y < 0.0f && rd >= f.diskR1 && rd <= f.diskR2) {
+                    finishLane(l, Hit::Disk, -1, P);
+                    continue;
+                }
+            }
+            if constexpr (Objects) {
+                int hitObj = -1;
+                for (int j = 0; j < f.objectCount; ++j) {
+                    const Sphere& o = f.objects[j];
+                    if (Length(P - V3{ o.x, o.y, o.z }) <= o.radius) { hitObj = j; break; }
+                }
+                if (hitObj >= 0) {
+                    finishLane(l, Hit::Object, hitObj, P);
+                    continue;
+                }
+            }
+            prevPos[l] = P;
+            if (radius(l) > f.escapeR)
+                finishLane(l, Hit::Escaped, -1, P);
+        }
+    }
+}
+
+// Camera rays for pixel rows [yS, yE), in pixel order
+struct PixelSource {
+    const Frame& f;
+    int pixel, last;
+    detail::V3 camPos, right, up, fwd;
+
+    PixelSource(const Frame& frame, int yS, int yE)
+        : f(frame), pixel(yS * frame.width), last(yE * frame.width),
+          camPos(detail::Load(frame.camPos)), right(detail::Load(frame.right)),
+          up(detail::Load(frame.up)), fwd(detail::Load(frame.fwd)) {}
+
+    bool next(int& id, detail::V3& pos, detail::V3& dir) {
+        using namespace detail;
+        if (pixel >= last) return false;
+        int px = pixel % f.width, py = pixel / f.width;
+        float u = (2.0f*(px + 0.5f)/f.width  - 1.0f) * f.aspect * f.tanHFov;
+        float v = (1.0f - 2.0f*(py + 0.5f)/f.height) * f.tanHFov;
+        pos = camPos;
+        dir = Normalize(u * right - v * up + fwd);
+        id  = pixel++;
+        return true;
+    }
+};
+
+// Shades each ended ray into the frame's RGBA8 buffer
+struct PixelSink {
+    const Frame& f;
+    detail::V3 camPos;
+
+    explicit PixelSink(const Frame& frame) : f(frame), camPos(detail::Load(frame.camPos)) {}
+
+    void finish(int pixel, const Termination& t) {
+        using namespace detail;
+        float cr = 0, cg = 0, cb = 0, ca = 0;
+        if (t.hit == Hit::Disk) {
+            float rv = Length(t.position) / f.diskR2;
+            cr = 1.0f; cg = rv; cb = 0.2f; ca = rv;
+        } else if (t.hit == Hit::Captured) {
+            ca = 1.0f;
+        } else if (t.hit == Hit::Object) {
+            const Sphere& o = f.objects[t.object];
+            V3 N = Normalize(t.position - V3{ o.x, o.y, o.z });
+            V3 V = Normalize(camPos - t.position);
+            float ambient   = 0.1f;
+            float diff      = std::max(Dot(N, V), 0.0f);
+            float intensity = ambient + (1.0f - ambient) * diff;
+            cr = o.r * intensity;  cg = o.g * intensity;  cb = o.b * intensity;  ca = o.a;
+        }
+        int idx = 4 * pixel;
+        f.rgba[idx+0] = uint8_t(std::min(cr, 1.0f) * 255.0f);
+        f.rgba[idx+1] = uint8_t(std::min(cg, 1.0f) * 255.0f);
+        f.rgba[idx+2] = uint8_t(std::min(cb, 1.0f) * 255.0f);
+        f.rgba[idx+3] = uint8_t(std::min(ca, 1.0f) * 255.0f);
+    }
+};
+
+// Traces pixel rows [yS, yE) of the frame
+template <Integrator I, bool Disk, bool Objects, bool Simd = true>
+void TraceBand(const Frame& f, int yS, int yE) {
+    PixelSource src(f, yS, yE);
+    PixelSink   sink(f);
+    TraceRays<I, Disk, Objects, Simd>(f, src, sink);
+}
+
+using BandKernel = void (*)(const Frame&, int yS, int yE);
+
+struct Variant {
+    const char* name;       // "sph", "cart+disk+obj", ...
+    BandKernel  trace;
+};
+
+// Instantiation for this frame's policies; the index order is [simd][integrator][disk][objects]
+inline const Variant& Select(Integrator integrator, bool disk, bool objects, bool simd = true) {
+    using I = Integrator;
+    static const Variant table[2][2][2][2] = {
+        { { { { "sph/scalar",           &TraceBand<I::Spherical, false, false, false> },
+              { "sph+obj/scalar",       &TraceBand<I::Spherical, false, true,  false> } },
+            { { "sph+disk/scalar",      &TraceBand<I::Spherical, true,  false, false> },
+              { "sph+disk+obj/scalar",  &TraceBand<I::Spherical, true,  true,  false> } } },
+          { { { "cart/scalar",          &TraceBand<I::Cartesian, false, false, false> },
+              { "cart+obj/scalar",      &TraceBand<I::Cartesian, false, true,  false> } },
+            { { "cart+disk/scalar",     &TraceBand<I::Cartesian, true,  false, false> },
+              { "cart+disk+obj/scalar", &TraceBand<I::Cartesian, true,  true,  false> } } } },
+        { { { { "sph",                  &TraceBand<I::Spherical, false, false> },
+              { "sph+obj",              &TraceBand<I::Spherical, false, true > } },
+            { { "sph+disk",             &TraceBand<I::Spherical, true,  false> },
+              { "sph+disk+obj",         &TraceBand<I::Spherical, true,  true > } } },
+          { { { "cart",                 &TraceBand<I::Cartesian, false, false> },
+              { "cart+obj",             &TraceBand<I::Cartesian, false, true > } },
+            { { "cart+disk",            &TraceBand<I::Cartesian, true,  false> },
+              { "cart+disk+obj",        &TraceBand<I::Cartesian, true,  true > } } } },
+    };
+    return table[simd][integrator == I::Cartesian][disk][objects];
+}
+
+} // namespace CpuTracer
+
+#endif // CPU_TRACER_HPP
@@ -1,5 +1,17 @@
 #include "common.hpp"
 #include "physics_asm.hpp"  
+#include "collision.hpp"
+#include "nbody.hpp"
+#include "snapshot.hpp"
+#include "predictor.hpp"
+#include "swarm.hpp"
+#include "adaptive_grid.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
 
 // Ouais, ici on balance les shaders de la mort avec des effets de lumière et de glow stylés
 const char* vertexShaderSource = R"glsl(
@@ -40,6 +52,33 @@ void main() {
     }
 })glsl";
 
+// Essaim de particules test : des point sprites, couleur selon la vitesse (lent = orange, rapide = bleu)
+const char* swarmVertexSource = R"glsl(
+#version 330 core
+layout(location=0) in vec4 aPosSpeed;
+uniform mat4 view;
+uniform mat4 projection;
+uniform float pointScale;
+out float speed;
+void main() {
+    vec4 viewPos = view * vec4(aPosSpeed.xyz, 1.0);
+    gl_Position = projection * viewPos;
+    gl_PointSize = clamp(pointScale / -viewPos.z, 1.0, 6.0);
+    speed = aPosSpeed.w;
+})glsl";
+
+const char* swarmFragmentSource = R"glsl(
+#version 330 core
+in float speed;
+out vec4 FragColor;
+void main() {
+    vec2 d = gl_PointCoord * 2.0 - 1.0;
+    float r2 = dot(d, d);
+    if (r2 > 1.0) discard;
+    vec3 col = mix(vec3(1.0, 0.45, 0.1), vec3(0.55, 0.75, 1.0), clamp(speed, 0.0, 1.0));
+    FragColor = vec4(col, (1.0 - r2) * 0.35);
+})glsl";
+
 // Variables globales aka les trucs qu’on touche partout (pas top mais bon…)
 bool running = true;
 bool pause = false;  // On démarre sans pause, faut bien que ça bouge un peu
@@ -51,34 +90,49 @@ const float c = 299792458.0f;
 float initMass = float(pow(10, 22));
 float sizeRatio = 30000.0f;  // Ce ratio magique qui fait tout marcher “à peu près”
 
+// Collisions : fusion par défaut, touche C pour passer en rebond / off
+CollisionMode collisionMode = CollisionMode::Merge;
+ThreadPool simPool;  // les workers restent en vie toute la simu, pas de spawn par frame
+
+// L'état physique vit en SoA dans `bodies` ; les Object ne sont plus que le rendu.
+// Pas de temps par blocs : chaque corps a son propre niveau dt = frame / 2^L.
+NBodySystem bodies;
+NBodyParams nbodyParams;
+BlockTimestepper stepper;
+
+// Trajectoires prédites en tâche de fond (touche T pour les cacher)
+bool showTrails = true;
+
+// Replay : snapshot affiché + déplacement demandé au clavier
+long replayFrame = 0;
+long replayScrub = 0;
+
 // Caméra : on la fout loin pour voir tout le bazar
 OrbitCamera camera(vec3(0.0f, 0.0f, 0.0f), 50000.0f, 1000.0f, 200000.0f, 45.0f);
 
 // Protos de fonctions, histoire que le compilateur arrête de râler
 GLFWwindow* StartGLU();
-GLuint CreateShaderProgram(const char* vertexSource, const char* fragmentSource);
-void CreateVBOVAO(GLuint& VAO, GLuint& VBO, const float* vertices, size_t vertexCount);
-void UpdateCam(GLuint shaderProgram);
+void UpdateCam(GLuint shaderProgram, GLint viewLoc);
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void DrawGrid(GLuint shaderProgram, GLuint gridVAO, size_t vertexCount);
+void DrawGrid(GLuint shaderProgram, GLint modelLoc, GLuint gridVAO, size_t indexCount, GLintptr indexOffset);
 
 // Classe Object : ici on gère les planètes, les masses, la physique, bref... le cosmos
+// Pas de mesh par objet : toutes les sphères tirent du SphereMeshCache partagé, mises à l'échelle au rendu
 class Object {
 public:
-    GLuint VAO, VBO;
     glm::vec3 position = glm::vec3(400, 300, 0);
     glm::vec3 velocity = glm::vec3(0, 0, 0);
-    size_t vertexCount;
     glm::vec4 color = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
 
     bool Initalizing = false;
     bool Launched = false;
     bool target = false;
     bool glow = false;
+    bool alive = true;  // false une fois fusionné (ou absent du snapshot en replay)
 
     float mass;
     float density;
@@ -97,121 +151,24 @@ public:
         this->radius = pow(((3 * this->mass/this->density)/(4 * 3.14159265359)), (1.0f/3.0f)) / sizeRatio;
         this->color = color;
         this->glow = Glow;
-
-        std::vector<float> vertices = SphereGenerator::GenerateVertices(this->radius);
-        vertexCount = vertices.size();
-        SphereGenerator::CreateVAO(VAO, VBO, vertices);
-    }
-
-    // Mise à jour de la position, un peu de mouvement sinon c’est boring
-    void UpdatePos(){
-        this->position[0] += this->velocity[0] / 94;
-        this->position[1] += this->velocity[1] / 94;
-        this->position[2] += this->velocity[2] / 94;
-        this->radius = pow(((3 * this->mass/this->density)/(4 * 3.14159265359)), (1.0f/3.0f)) / sizeRatio;
-    }
-
-    // On recalcule la sphère si jamais sa taille change (aka si elle gonfle ou fond)
-    void UpdateVertices() {
-        std::vector<float> vertices = SphereGenerator::GenerateVertices(this->radius);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
     }
 
     glm::vec3 GetPos() const {
         return this->position;
     }
-
-    // Accélération, c’est là qu’on applique les forces, yeah baby Newton
-    void accelerate(float x, float y, float z){
-        this->velocity[0] += x / 96;
-        this->velocity[1] += y / 96;
-        this->velocity[2] += z / 96;
-    }
-
-    // Collision ? Spoiler : non, juste un check bidon pour l'instant
-    float CheckCollision(const Object& other) {
-        // ⚡ ASSEMBLY-OPTIMIZED: Using fast distance calculation
-        float distSq = PhysicsASM::DistanceSquared(
-            this->position[0], this->position[1], this->position[2],
-            other.position[0], other.position[1], other.position[2]
-        );
-        float distance = std::sqrt(distSq);  // Only sqrt if we really need actual distance
-        return 1.0f;
-    }
 };
 
 // Le grand tableau des objets (aka le système solaire de fortune)
 std::vector<Object> objs = {};
-std::vector<float> CreateGridVertices(float size, int divisions, const std::vector<Object>& objs);
-std::vector<float> UpdateGridVertices(std::vector<float> vertices, const std::vector<Object>& objs, float halfSize, float originalY);
-
-GLuint gridVAO, gridVBO;
-
-// Ici on assemble les shaders comme des LEGO
-GLuint CreateShaderProgram(const char* vertexSource, const char* fragmentSource) {
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexSource, nullptr);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "Erreur compilation vertex shader : " << infoLog << std::endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentSource, nullptr);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "Erreur compilation fragment shader : " << infoLog << std::endl;
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "Erreur linkage shader program : " << infoLog << std::endl;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
-}
-
-// VBO + VAO setup : le duo infernal
-void CreateVBOVAO(GLuint& VAO, GLuint& VBO, const float* vertices, size_t vertexCount) {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(float), vertices, GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
-}
+GLuint gridVAO;
 
 // Mise à jour de la caméra, aka “suivre le bazar en mouvement”
-void UpdateCam(GLuint shaderProgram) {
+void UpdateCam(GLuint shaderProgram, GLint viewLoc) {
     glUseProgram(shaderProgram);
     glm::vec3 cameraPos = camera.position();
     glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
     glm::mat4 view = glm::lookAt(cameraPos, camera.target, cameraUp);
-    GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
 }
 
@@ -219,6 +176,26 @@ void UpdateCam(GLuint shaderProgram) {
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) pause = !pause;
 
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        showTrails = !showTrails;
+        std::cout << "[Trajectoires] " << (showTrails ? "affichées" : "cachées") << std::endl;
+    }
+
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+        collisionMode = collisionMode == CollisionMode::Off   ? CollisionMode::Merge
+                      : collisionMode == CollisionMode::Merge ? CollisionMode::Bounce
+                                                              : CollisionMode::Off;
+        std::cout << "[Collisions] " << CollisionModeName(collisionMode) << std::endl;
+    }
+
+    // Replay : ←/→ image par image (maintenir pour défiler), HOME/END début/fin
+    if (action != GLFW_RELEASE) {
+        if (key == GLFW_KEY_RIGHT) replayScrub += 1;
+        if (key == GLFW_KEY_LEFT)  replayScrub -= 1;
+        if (key == GLFW_KEY_HOME)  replayScrub = -replayFrame;
+        if (key == GLFW_KEY_END)   replayScrub = 1L << 40;
+    }
+
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS){
         glfwTerminate();
         glfwWindowShouldClose(window);
@@ -244,98 +221,57 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 }
 
 // Fonction pour dessiner la grille : le plan de l’univers, tranquille
-void DrawGrid(GLuint shaderProgram, GLuint gridVAO, size_t vertexCount) {
+void DrawGrid(GLuint shaderProgram, GLint modelLoc, GLuint gridVAO, size_t indexCount, GLintptr indexOffset) {
     glUseProgram(shaderProgram);
     glm::mat4 model = glm::mat4(1.0f);
-    GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
     glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
 
     glBindVertexArray(gridVAO);
-    glDrawArrays(GL_LINES, 0, vertexCount / 3);
+    glDrawElements(GL_LINES, GLsizei(indexCount), GL_UNSIGNED_INT, (void*)indexOffset);
     glBindVertexArray(0);
 }
 
-std::vector<float> CreateGridVertices(float size, int divisions, const std::vector<Object>& objs) {
-    std::vector<float> vertices;
-    float step = size / divisions;
-    float halfSize = size / 2.0f;
-
-    // Lignes selon X — ou comment tracer un joli quadrillage de l’espace-temps
-    for (int yStep = 3; yStep <= 3; ++yStep) {
-        float y = -halfSize*0.3f + yStep * step;
-        for (int zStep = 0; zStep <= divisions; ++zStep) {
-            float z = -halfSize + zStep * step;
-            for (int xStep = 0; xStep < divisions; ++xStep) {
-                float xStart = -halfSize + xStep * step;
-                float xEnd = xStart + step;
-                vertices.push_back(xStart); vertices.push_back(y); vertices.push_back(z);
-                vertices.push_back(xEnd);   vertices.push_back(y); vertices.push_back(z);
-            }
+// Déformation de la grille en un point : somme des puits de tous les corps vivants
+static float GridDeflection(const std::vector<Object>& objs, const glm::vec3& p) {
+    float dy = 0.0f;
+    for (const auto& obj : objs) {
+        if (!obj.alive) continue;
+        glm::vec3 toObject = obj.GetPos() - p;
+        float distance = glm::length(toObject);
+        float distance_m = distance * 1000.0f;
+        float rs = (2 * GRAVITATIONAL_CONSTANT * obj.mass) / (c * c);
+        if (distance_m > rs) {
+            float dz = 2 * std::sqrt(rs * (distance_m - rs));
+            dy += dz * 2.0f;
         }
     }
-
-    // Lignes selon Z — histoire de croiser le bazar
-    for (int xStep = 0; xStep <= divisions; ++xStep) {
-        float x = -halfSize + xStep * step;
-        for (int yStep = 3; yStep <= 3; ++yStep) {
-            float y = -halfSize*0.3f + yStep * step;
-            for (int zStep = 0; zStep < divisions; ++zStep) {
-                float zStart = -halfSize + zStep * step;
-                float zEnd = zStart + step;
-                vertices.push_back(x); vertices.push_back(y); vertices.push_back(zStart);
-                vertices.push_back(x); vertices.push_back(y); vertices.push_back(zEnd);
-            }
-        }
-    }
-
-    return vertices;
+    return dy;
 }
 
-// Mise à jour de la grille avec la courbure de l’espace-temps (oui oui, Einstein inside)
-std::vector<float> UpdateGridVertices(std::vector<float> vertices, const std::vector<Object>& objs,
-                                     float halfSize, float originalY) {
-    glm::vec3 corners[4] = {
-        glm::vec3(-halfSize, originalY, -halfSize),
-        glm::vec3(halfSize, originalY, -halfSize),
-        glm::vec3(-halfSize, originalY, halfSize),
-        glm::vec3(halfSize, originalY, halfSize)
-    };
-
-    float dy_corners[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-
-    // On calcule combien chaque coin se fait "tirer" par la gravité
-    for (int i = 0; i < 4; i++) {
-        for (const auto& obj : objs) {
-            glm::vec3 toObject = obj.GetPos() - corners[i];
-            float distance = glm::length(toObject);
-            float distance_m = distance * 1000.0f;
-            float rs = (2 * GRAVITATIONAL_CONSTANT * obj.mass) / (c * c);
-            if (distance_m > rs) {
-                float dz = 2 * std::sqrt(rs * (distance_m - rs));
-                dy_corners[i] += dz * 2.0f;
-            }
-        }
+// Hauteur de la grille avec la courbure de l’espace-temps (oui oui, Einstein inside).
+// Les coins sont calculés une fois par frame, ensuite c'est un foncteur (x, z) -> y
+// que le quadtree adaptatif appelle où il veut.
+struct GridHeightField {
+    const std::vector<Object>& objs;
+    float halfSize, originalY;
+    float dy_corners[4];
+
+    GridHeightField(const std::vector<Object>& o, float half, float y0)
+        : objs(o), halfSize(half), originalY(y0) {
+        // On calcule combien chaque coin se fait "tirer" par la gravité
+        const glm::vec3 corners[4] = {
+            glm::vec3(-halfSize, originalY, -halfSize),
+            glm::vec3(halfSize, originalY, -halfSize),
+            glm::vec3(-halfSize, originalY, halfSize),
+            glm::vec3(halfSize, originalY, halfSize)
+        };
+        for (int i = 0; i < 4; i++) dy_corners[i] = GridDeflection(objs, corners[i]);
     }
 
-    // Maintenant on fait de la magie mathématique : interpolation bilinéaire
-    for (size_t i = 0; i < vertices.size(); i += 3) {
-        float x = vertices[i];
-        float z = vertices[i + 2];
-
-        glm::vec3 vertexPos(x, originalY, z);
-        float dy = 0.0f;
-
-        for (const auto& obj : objs) {
-            glm::vec3 toObject = obj.GetPos() - vertexPos;
-            float distance = glm::length(toObject);
-            float distance_m = distance * 1000.0f;
-            float rs = (2 * GRAVITATIONAL_CONSTANT * obj.mass) / (c * c);
-            if (distance_m > rs) {
-                float dz = 2 * std::sqrt(rs * (distance_m - rs));
-                dy += dz * 2.0f;
-            }
-        }
+    float operator()(float x, float z) const {
+        float dy = GridDeflection(objs, glm::vec3(x, originalY, z));
 
+        // Maintenant on fait de la magie mathématique : interpolation bilinéaire
         float u = (x + halfSize) / (2 * halfSize);
         float v = (z + halfSize) / (2 * halfSize);
 
@@ -344,10 +280,201 @@ std::vector<float> UpdateGridVertices(std::vector<float> vertices, const std::ve
                       (1 - u) * v * dy_corners[2] +
                       u * v * dy_corners[3];
 
-        vertices[i + 1] = originalY + (dy - shift) + halfSize / 3;
+        return originalY + (dy - shift) + halfSize / 3;
     }
+};
+
+// Broad phase + narrow phase, directement sur les tableaux SoA de `bodies`.
+// Aucun appel GL ici : le mode headless passe aussi par là.
+struct CollisionScratch {
+    std::vector<ContactPair> pairs;
+    SpatialHash hash;
+} collisionScratch;
+
+size_t ResolveCollisions(NBodySystem& sys) {
+    if (collisionMode == CollisionMode::Off || sys.size() < 2) return 0;
+
+    CollisionScratch& s = collisionScratch;
+    CollisionBodies view = sys.collisionView();
+    s.hash.build(view, simPool);
+    s.hash.findContacts(view, simPool, s.pairs);
+    if (s.pairs.empty()) return 0;
+
+    size_t merged = ResolveContacts(view, s.pairs, collisionMode, sizeRatio);
+    stepper.invalidate();  // vitesses / masses modifiées → forces et niveaux à refaire
+    if (merged) sys.compact();
+    return merged;
+}
 
-    return vertices;
+// Recopie un état (live ou snapshot) dans les Object pour le rendu et la grille.
+// objs est indexé par id : un corps fusionné reste là mais n'est plus affiché,
+// comme ça le replay peut revenir en arrière sans rien recréer.
+void SyncObjects(const SnapshotFrame& f, std::vector<Object>& objs) {
+    for (auto& o : objs) o.alive = false;
+    for (uint32_t k = 0; k < f.count; ++k) {
+        if (f.id[k] >= objs.size()) continue;
+        Object& o = objs[f.id[k]];
+        o.alive = true;
+        o.position = glm::vec3(f.x[k], f.y[k], f.z[k]);
+        o.velocity = glm::vec3(f.vx[k], f.vy[k], f.vz[k]);
+        if (f.mass[k] != o.mass) {
+            // fusion : nouvelle masse, nouveau rayon (le mesh est mis à l'échelle au rendu, rien à regénérer)
+            o.mass = f.mass[k];
+            o.radius = f.radius[k];
+        }
+    }
+}
+
+// La scène de départ, sans rien de GL dedans (utilisée aussi en headless)
+struct SceneBody {
+    glm::vec3 position, velocity;
+    float mass, density;
+    glm::vec4 color;
+    bool glow;
+};
+
+std::vector<SceneBody> DefaultScene(int extraBodies) {
+    float planetMass = 1.989e25f;
+    float satelliteMass = 5.97219e22f * 27.0f;
+    float orbitVel = 1500.0f;
+
+    std::vector<SceneBody> scene = {
+        { glm::vec3(-8000, 0, 0), glm::vec3(0, 0, 0), planetMass, 5515, glm::vec4(0.2f, 0.5f, 0.9f, 1.0f), false },
+        { glm::vec3(4000, 0, 6000), glm::vec3(0, 0, 0), planetMass, 5515, glm::vec4(0.3f, 0.9f, 0.3f, 1.0f), false },
+        { glm::vec3(4000, 0, -6000), glm::vec3(0, 0, 0), planetMass, 5515, glm::vec4(0.9f, 0.3f, 0.3f, 1.0f), false },
+        { glm::vec3(-11000, 0, 0), glm::vec3(0, 0, orbitVel), satelliteMass, 3344, glm::vec4(0.7f, 0.8f, 0.9f, 1.0f), false },
+        { glm::vec3(-5000, 0, 0), glm::vec3(0, 0, -orbitVel), satelliteMass, 3344, glm::vec4(0.6f, 0.7f, 0.85f, 1.0f), false },
+        { glm::vec3(1000, 0, 6000), glm::vec3(0, 0, orbitVel), satelliteMass, 3344, glm::vec4(0.7f, 0.95f, 0.7f, 1.0f), false },
+        { glm::vec3(4000, 0, -9000), glm::vec3(orbitVel, 0, 0), satelliteMass, 3344, glm::vec4(0.95f, 0.7f, 0.7f, 1.0f), false },
+        { glm::vec3(4000, 0, -1500), glm::vec3(-orbitVel * 0.85f, 0, 0), satelliteMass * 0.7f, 3344, glm::vec4(0.9f, 0.6f, 0.6f, 1.0f), false },
+    };
+
+    // --bodies N : une ceinture de petits cailloux en orbite autour du centre (seed fixe)
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    for (int i = 0; i < extraBodies; ++i) {
+        float ang = uni(rng) * 2.0f * float(M_PI);
+        float r = 12000.0f + 6000.0f * uni(rng);
+        glm::vec3 pos(r * std::cos(ang), 200.0f * (uni(rng) - 0.5f), r * std::sin(ang));
+        glm::vec3 vel = glm::vec3(-std::sin(ang), 0, std::cos(ang)) * orbitVel * 0.9f;
+        scene.push_back({ pos, vel, satelliteMass * 0.05f, 3344, glm::vec4(0.6f, 0.6f, 0.65f, 1.0f), false });
+    }
+    return scene;
+}
+
+// Mode essaim : un seul corps massif fixe au centre (Sgr A* à l'échelle de la scène),
+// les particules ne voient que lui
+const float swarmCentralMass = 4.0e26f;
+
+std::vector<SceneBody> SwarmScene() {
+    return { { glm::vec3(0), glm::vec3(0), swarmCentralMass, 16000, glm::vec4(0.02f, 0.02f, 0.02f, 1.0f), false } };
+}
+
+SwarmConfig MakeSwarmConfig() {
+    SwarmConfig c;
+    c.mu = nbodyParams.G * swarmCentralMass / (nbodyParams.lengthToSI * nbodyParams.lengthToSI);
+    c.kick = nbodyParams.kickScale;
+    c.drift = nbodyParams.driftScale;
+    c.softening = 50.0f;
+    c.capture = SphereRadius(swarmCentralMass, 16000, sizeRatio);
+    c.rIn = 2500.0f;
+    c.rOut = 16000.0f;
+    c.thickness = 150.0f;
+    c.dispersion = 0.15f;
+    return c;
+}
+
+void LoadBodies(const std::vector<SceneBody>& scene, NBodySystem& sys) {
+    for (const auto& b : scene)
+        sys.add(b.position.x, b.position.y, b.position.z,
+                b.velocity.x, b.velocity.y, b.velocity.z,
+                b.mass, b.density, SphereRadius(b.mass, b.density, sizeRatio));
+}
+
+// Options de ligne de commande
+struct Options {
+    bool headless = false;
+    long steps = 100000;          // --steps
+    long every = 100;             // --every : un snapshot tous les N pas
+    int extraBodies = 0;          // --bodies
+    size_t swarm = 0;             // --swarm N : N particules test autour d'un trou noir fixe
+    long horizon = 2000;          // --horizon : frames prédites à l'avance (0 = pas de prédiction)
+    std::string out = "nbody_run.nbs";
+    std::string replay;           // --replay fichier
+};
+
+Options ParseArgs(int argc, char* argv[]) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasNext = i + 1 < argc;
+        if (a == "--headless") o.headless = true;
+        else if (a == "--steps" && hasNext) o.steps = std::atol(argv[++i]);
+        else if (a == "--every" && hasNext) o.every = std::max(1L, std::atol(argv[++i]));
+        else if (a == "--bodies" && hasNext) o.extraBodies = std::max(0, std::atoi(argv[++i]));
+        else if (a == "--swarm" && hasNext) o.swarm = size_t(std::max(0L, std::atol(argv[++i])));
+        else if (a == "--horizon" && hasNext) o.horizon = std::max(0L, std::atol(argv[++i]));
+        else if (a == "--out" && hasNext) o.out = argv[++i];
+        else if (a == "--replay" && hasNext) o.replay = argv[++i];
+        else {
+            std::cerr << "Option inconnue : " << a << "\n"
+                      << "Usage : Gravity_Grid [--headless [--steps N] [--every K] [--out f.nbs]]"
+                         " [--bodies N] [--horizon N] [--swarm N] [--replay f.nbs]" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    return o;
+}
+
+// Mode headless : pas de fenêtre, pas de GL, on simule à fond et on écrit les snapshots
+int RunHeadless(const Options& opt) {
+    if (opt.swarm)
+        std::cout << "[Headless] --swarm ignoré : l'essaim n'est qu'une visualisation" << std::endl;
+    LoadBodies(DefaultScene(opt.extraBodies), bodies);
+    stepper.pool = &simPool;
+
+    SnapshotFileHeader meta = {};
+    meta.lengthToSI = nbodyParams.lengthToSI;
+    meta.kickScale = nbodyParams.kickScale;
+    meta.driftScale = nbodyParams.driftScale;
+    meta.sizeRatio = sizeRatio;
+    meta.initialBodies = uint32_t(bodies.size());
+    meta.snapshotEvery = uint32_t(opt.every);
+
+    SnapshotWriter writer;
+    if (!writer.open(opt.out.c_str(), meta)) return EXIT_FAILURE;
+    writer.append(FrameView(bodies, 0, 0.0));
+
+    std::cout << "[Headless] " << bodies.size() << " corps, " << opt.steps << " pas, snapshot tous les "
+              << opt.every << " pas → " << opt.out << std::endl;
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto lastPrint = t0;
+    for (long step = 1; step <= opt.steps; ++step) {
+        stepper.step(bodies, nbodyParams);
+        size_t merged = ResolveCollisions(bodies);
+        if (merged)
+            std::cout << "[Collisions] pas " << step << " : " << merged << " fusion(s), "
+                      << bodies.size() << " corps restants" << std::endl;
+
+        if (step % opt.every == 0 || step == opt.steps) {
+            if (!writer.append(FrameView(bodies, uint64_t(step), double(step)))) return EXIT_FAILURE;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastPrint).count() >= 2.0) {
+            double el = std::chrono::duration<double>(now - t0).count();
+            std::cout << "[Headless] pas " << step << "/" << opt.steps << "  "
+                      << long(step / el) << " pas/s  ";
+            stepper.printStats("");
+            lastPrint = now;
+        }
+    }
+
+    double el = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[Headless] terminé en " << el << " s, " << bodies.size() << " corps, "
+              << writer.bytesWritten() / (1024.0 * 1024.0) << " MiB écrits" << std::endl;
+    return EXIT_SUCCESS;
 }
 
 // Variables globales d’écran (aka le canvas de ton univers)
@@ -355,13 +482,21 @@ int g_fbWidth = 800;
 int g_fbHeight = 600;
 
 // MAIN — le cœur du game 💥
-int main() {
-    GLFWwindow* window = StartGLU();
-    GLuint shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+int main(int argc, char* argv[]) {
+    Options opt = ParseArgs(argc, argv);
+    if (opt.headless) return RunHeadless(opt);
 
-    GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-    GLint objectColorLoc = glGetUniformLocation(shaderProgram, "objectColor");
-    GLint projectionLoc = glGetUniformLocation(shaderProgram, "projection");
+    GLFWwindow* window = StartGLU();
+    // Le programme passe par le cache de binaires de ShaderUtils ; les uniforms sont récupérés une fois ici
+    ShaderProgram shaderProgram(ShaderUtils::CreateProgram(vertexShaderSource, fragmentShaderSource));
+
+    GLint modelLoc = shaderProgram.uniform("model");
+    GLint objectColorLoc = shaderProgram.uniform("objectColor");
+    GLint projectionLoc = shaderProgram.uniform("projection");
+    GLint viewLoc = shaderProgram.uniform("view");
+    GLint isGridLoc = shaderProgram.uniform("isGrid");
+    GLint glowLoc = shaderProgram.uniform("GLOW");
+    SphereMeshCache sphereMeshes;
     glUseProgram(shaderProgram);
 
     glfwSetCursorPosCallback(window, mouse_callback);
@@ -378,28 +513,84 @@ int main() {
     glViewport(0, 0, g_fbWidth, g_fbHeight);
 
     // On crée les planètes et satellites — l’armée du cosmos
-    float planetMass = 1.989e25f;
-    float satelliteMass = 5.97219e22f * 27.0f;
-    float orbitVel = 1500.0f;
+    // (objs[id] ↔ corps d'id `id`, en live comme en replay)
+    SnapshotReader replay;
+    bool replaying = !opt.replay.empty();
+    if (replaying) {
+        if (!replay.open(opt.replay.c_str()) || replay.frameCount() == 0) {
+            std::cerr << "Replay impossible : " << opt.replay << std::endl;
+            glfwTerminate();
+            return EXIT_FAILURE;
+        }
+        sizeRatio = replay.header().sizeRatio;
+        std::vector<SceneBody> scene = DefaultScene(0);
+        SnapshotFrame first = replay.frame(0);
+        uint32_t maxId = 0;
+        for (uint32_t k = 0; k < first.count; ++k) maxId = std::max(maxId, first.id[k]);
+        objs.reserve(maxId + 1);
+        for (uint32_t id = 0; id <= maxId; ++id) {
+            glm::vec4 color = id < scene.size() ? scene[id].color : glm::vec4(0.6f, 0.6f, 0.65f, 1.0f);
+            objs.emplace_back(glm::vec3(0), glm::vec3(0), 1.0f, 1.0f, color, false);
+            objs.back().alive = false;
+        }
+        // Masse et rayon du premier snapshot : la sphère a sa taille dès la création
+        // (SyncObjects ne les touche ensuite qu'aux fusions)
+        for (uint32_t k = 0; k < first.count; ++k) {
+            Object& o = objs[first.id[k]];
+            o.mass = first.mass[k];
+            o.radius = first.radius[k];
+        }
+        std::cout << "[Replay] " << replay.frameCount() << " snapshots, " << first.count
+                  << " corps. ESPACE : lecture/pause, ←/→ : image par image, HOME/END : début/fin" << std::endl;
+    } else {
+        std::vector<SceneBody> scene = opt.swarm ? SwarmScene() : DefaultScene(opt.extraBodies);
+        for (const auto& b : scene)
+            objs.emplace_back(b.position, b.velocity, b.mass, b.density, b.color, b.glow);
+        LoadBodies(scene, bodies);
+        stepper.pool = &simPool;  // forces répartis sur les workers, résultat identique quel que soit le nb de threads
+    }
 
-    objs = {
-        Object(glm::vec3(-8000, 0, 0), glm::vec3(0, 0, 0), planetMass, 5515,
-               glm::vec4(0.2f, 0.5f, 0.9f, 1.0f), false),
-        Object(glm::vec3(4000, 0, 6000), glm::vec3(0, 0, 0), planetMass, 5515,
-               glm::vec4(0.3f, 0.9f, 0.3f, 1.0f), false),
-        Object(glm::vec3(4000, 0, -6000), glm::vec3(0, 0, 0), planetMass, 5515,
-               glm::vec4(0.9f, 0.3f, 0.3f, 1.0f), false),
-        Object(glm::vec3(-11000, 0, 0), glm::vec3(0, 0, orbitVel), satelliteMass, 3344,
-               glm::vec4(0.7f, 0.8f, 0.9f, 1.0f), false),
-        Object(glm::vec3(-5000, 0, 0), glm::vec3(0, 0, -orbitVel), satelliteMass, 3344,
-               glm::vec4(0.6f, 0.7f, 0.85f, 1.0f), false),
-        Object(glm::vec3(1000, 0, 6000), glm::vec3(0, 0, orbitVel), satelliteMass, 3344,
-               glm::vec4(0.7f, 0.95f, 0.7f, 1.0f), false),
-        Object(glm::vec3(4000, 0, -9000), glm::vec3(orbitVel, 0, 0), satelliteMass, 3344,
-               glm::vec4(0.95f, 0.7f, 0.7f, 1.0f), false),
-        Object(glm::vec3(4000, 0, -1500), glm::vec3(-orbitVel * 0.85f, 0, 0), satelliteMass * 0.7f, 3344,
-               glm::vec4(0.9f, 0.6f, 0.6f, 1.0f), false),
-    };
+    // Essaim : SoA + SIMD sur le pool, un buffer de streaming rempli directement par le pas
+    ParticleSwarm swarm;
+    ShaderProgram swarmProgram;
+    GLint swarmViewLoc = -1, swarmProjectionLoc = -1;
+    GLuint swarmVAO = 0;
+    StreamingBuffer swarmStream;
+    bool swarmFilled = false;
+    if (opt.swarm && !replaying) {
+        swarm.seed(opt.swarm, MakeSwarmConfig(), 42);
+        swarmProgram.reset(ShaderUtils::CreateProgram(swarmVertexSource, swarmFragmentSource));
+        swarmViewLoc = swarmProgram.uniform("view");
+        swarmProjectionLoc = swarmProgram.uniform("projection");
+        glUseProgram(swarmProgram);
+        glUniform1f(swarmProgram.uniform("pointScale"), 60000.0f);   // constant, réglé une fois
+        glUseProgram(shaderProgram);
+        swarmStream.create(swarm.size() * 4 * sizeof(float));
+        glGenVertexArrays(1, &swarmVAO);
+        glBindVertexArray(swarmVAO);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+        std::cout << "[Swarm] " << swarm.size() << " particules test" << std::endl;
+    }
+    double swarmMs = 0.0;
+    size_t swarmSteps = 0, swarmCaptured = 0;
+    float lastReport = 0.0f;
+    uint64_t simStep = 0;
+
+    // Prédicteur : il tourne sur son propre thread, la boucle de rendu ne l'attend jamais
+    std::unique_ptr<TrajectoryPredictor> predictor;
+    if (!replaying && !opt.swarm && opt.horizon > 0)
+        predictor.reset(new TrajectoryPredictor(uint32_t(opt.horizon), 8));
+    bool predictionDirty = true;
+    // Trajectoires : elles ne changent qu'à chaque publication du prédicteur, mais passent aussi par un anneau
+    GLuint trailVAO;
+    StreamingBuffer trailStream;   // créé à la première publication, à la taille des trajectoires
+    glGenVertexArrays(1, &trailVAO);
+    glBindVertexArray(trailVAO);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    std::vector<uint32_t> trailIds;
+    uint32_t trailCapacity = 0, trailCount = 0;
 
     float size = 20000.0f;
     int divisions = 25;
@@ -407,8 +598,25 @@ int main() {
     float halfSize = size / 2.0f;
     float originalY = -halfSize * 0.3f + 3 * step;
 
-    std::vector<float> gridVertices = CreateGridVertices(size, divisions, objs);
-    CreateVBOVAO(gridVAO, gridVBO, gridVertices.data(), gridVertices.size());
+    // Grille adaptative : un quadtree qui raffine près des puits et reste grossier ailleurs,
+    // avec un budget fixe de cellules. Topologie recalculée toutes les 4 frames, hauteurs à chaque frame.
+    const size_t gridBudget = 2048;
+    AdaptiveGrid grid(0.0f, 0.0f, halfSize, gridBudget, 30.0f, 8);
+    grid.subdivideUniform(3, GridHeightField(objs, halfSize, originalY));
+    // Sommets chaque frame, indices seulement quand la topologie change : pas de glBufferData dans la boucle
+    StreamingBuffer gridVertexStream, gridIndexStream;
+    GLintptr gridIndexOffset = 0;
+    size_t gridIndexCount = 0;
+    gridVertexStream.create(gridBudget * 2 * 3 * sizeof(float));   // ~1 sommet par cellule + les bords, large
+    gridIndexStream.create(gridBudget * 4 * 2 * sizeof(uint32_t));
+    glGenVertexArrays(1, &gridVAO);
+    unsigned gridFrame = 0;
+
+    // Temps GPU par étape (requêtes doublées, jamais bloquantes), rapporté toutes les 2 s avec le temps de frame CPU
+    enum { GPU_GRID, GPU_TRAILS, GPU_OBJECTS, GPU_SWARM };
+    GpuTimer gpuTimer;
+    gpuTimer.create({ "grille", "trajectoires", "objets", "essaim" });
+    float lastGpuReport = 0.0f;
 
     // BOUCLE PRINCIPALE : aka “la danse des planètes”
     while (!glfwWindowShouldClose(window) && running == true) {
@@ -416,11 +624,83 @@ int main() {
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
+        if (replaying) {
+            // Replay : on lit le snapshot courant dans le mmap, zéro simulation
+            long last = long(replay.frameCount()) - 1;
+            long target = replayFrame + replayScrub;
+            if (!pause && replayScrub == 0) target += 1;
+            replayScrub = 0;
+            if (target > last && replay.refresh()) last = long(replay.frameCount()) - 1;  // fichier encore en cours d'écriture
+            target = std::max(0L, std::min(target, last));
+            if (target != replayFrame || pause) {
+                if (target != replayFrame && (pause || target == last)) {
+                    SnapshotFrame f = replay.frame(size_t(target));
+                    std::cout << "[Replay] snapshot " << target << "/" << last << "  pas " << f.step
+                              << "  " << f.count << " corps" << std::endl;
+                }
+                replayFrame = target;
+            }
+            SyncObjects(replay.frame(size_t(replayFrame)), objs);
+        } else {
+            // Physique d'abord : une frame = un pas de base, les rencontres serrées sous-découpent
+            if(!pause){
+                stepper.step(bodies, nbodyParams);
+                ++simStep;
+                if (size_t merged = ResolveCollisions(bodies))
+                    std::cout << "[Collisions] " << merged << " fusion(s), " << bodies.size() << " corps restants" << std::endl;
+                if (swarm.size()) {
+                    // Le pas écrit directement dans la région de la frame, pas d'attente sur le GPU
+                    auto t0 = std::chrono::steady_clock::now();
+                    float* mapped = static_cast<float*>(swarmStream.map(swarm.size() * 4 * sizeof(float)));
+                    swarmCaptured += swarm.step(simPool, mapped);
+                    GLintptr swarmOffset = swarmStream.unmap();
+                    glBindVertexArray(swarmVAO);
+                    glBindBuffer(GL_ARRAY_BUFFER, swarmStream.id());
+                    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)swarmOffset);
+                    glBindVertexArray(0);
+                    swarmFilled = true;
+                    swarmMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    ++swarmSteps;
+                }
+                if (currentFrame - lastReport > 2.0f) {
+                    if (swarm.size()) {
+                        std::cout << "[Swarm] " << swarm.size() << " particules, " << swarmMs / std::max<size_t>(1, swarmSteps)
+                                  << " ms/pas, " << swarmCaptured << " avalées" << std::endl;
+                        swarmMs = 0.0;
+                        swarmSteps = swarmCaptured = 0;
+                    } else {
+                        stepper.printStats("[Block dt]");
+                    }
+                    lastReport = currentFrame;
+                }
+            }
+            SyncObjects(FrameView(bodies, simStep, double(simStep)), objs);
+
+            // Corps modifiés (collision…) → nouvelle prédiction ; si le worker est occupé on réessaie à la frame suivante
+            if (predictor) {
+                if (stepper.needsInit()) predictionDirty = true;
+                if (predictionDirty && predictor->request(bodies, nbodyParams, simStep, stepper.needsInit()))
+                    predictionDirty = false;
+                predictor->advanceTo(simStep);
+                if (const PredictedPaths* paths = predictor->poll()) {
+                    // Reste valide jusqu'aux publications suivantes : l'anneau ne recycle une région qu'après `frames` écritures
+                    GLintptr trailOffset = trailStream.upload(paths->xyz.data(), paths->xyz.size() * sizeof(float));
+                    glBindVertexArray(trailVAO);
+                    glBindBuffer(GL_ARRAY_BUFFER, trailStream.id());
+                    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)trailOffset);
+                    glBindVertexArray(0);
+                    trailIds = paths->id;
+                    trailCapacity = paths->capacity;
+                    trailCount = paths->count;
+                }
+            }
+        }
+
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glfwSetKeyCallback(window, keyCallback);
         glfwSetMouseButtonCallback(window, mouseButtonCallback);
-        UpdateCam(shaderProgram);
+        UpdateCam(shaderProgram, viewLoc);
 
         glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)g_fbWidth / (float)g_fbHeight, 0.1f, 750000.0f);
         glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
@@ -428,69 +708,98 @@ int main() {
         // Grille spatio-temporelle — pour donner le ton interstellaire
         glUseProgram(shaderProgram);
         glUniform4f(objectColorLoc, 1.0f, 1.0f, 1.0f, 0.25f);
-        glUniform1i(glGetUniformLocation(shaderProgram, "isGrid"), 1);
-        glUniform1i(glGetUniformLocation(shaderProgram, "GLOW"), 0);
-        gridVertices = UpdateGridVertices(gridVertices, objs, halfSize, originalY);
-        glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
-        glBufferData(GL_ARRAY_BUFFER, gridVertices.size() * sizeof(float), gridVertices.data(), GL_DYNAMIC_DRAW);
-        DrawGrid(shaderProgram, gridVAO, gridVertices.size());
-
-        // Et maintenant : les objets (aka les planètes qui se tirent dessus avec gravité)
-        for(auto& obj : objs) {
-            glUniform4f(objectColorLoc, obj.color.r, obj.color.g, obj.color.b, obj.color.a);
-
-            for(auto& obj2 : objs){
-                if(&obj2 != &obj && !obj.Initalizing && !obj2.Initalizing){
-                   
-                    float distSq = PhysicsASM::DistanceSquared(
-                        obj.GetPos()[0], obj.GetPos()[1], obj.GetPos()[2],
-                        obj2.GetPos()[0], obj2.GetPos()[1], obj2.GetPos()[2]
-                    );
-
-                    float distance = std::sqrt(distSq);
-
-                    if (distance > 0) {
-                        
-                        float direction[3] = {
-                            obj2.GetPos()[0] - obj.GetPos()[0],
-                            obj2.GetPos()[1] - obj.GetPos()[1],
-                            obj2.GetPos()[2] - obj.GetPos()[2]
-                        };
-                        PhysicsASM::Normalize(direction);  
-
-                        distance *= 1000;
-
-                        
-                        float distance_scaled_sq = distance * distance;
-                        double Gforce = (GRAVITATIONAL_CONSTANT * obj.mass * obj2.mass) / distance_scaled_sq;
-
-                        float acc1 = Gforce / obj.mass;
-
-                        
-                        float acc[3];
-                        PhysicsASM::VectorScale(direction, acc1, acc);
-
-                        if(!pause){
-                            obj.accelerate(acc[0], acc[1], acc[2]);
-                        }
-
-                        obj.velocity *= obj.CheckCollision(obj2);
-                    }
-                }
+        glUniform1i(isGridLoc, 1);
+        glUniform1i(glowLoc, 0);
+        // Le timer GPU n'entoure que le draw : le quadtree et les uploads sont du travail CPU
+        GridHeightField gridHeight(objs, halfSize, originalY);
+        if (gridFrame++ % 4 == 0) grid.update(gridHeight);
+        if (grid.needsSegments()) {
+            grid.buildSegments();
+            // Les indices ne repartent qu'avec une nouvelle topologie : leur région de l'anneau n'est pas recyclée d'ici là
+            gridIndexOffset = gridIndexStream.upload(grid.indices().data(), grid.indices().size() * sizeof(uint32_t));
+            gridIndexCount = grid.indices().size();
+        }
+        grid.evaluateHeights(gridHeight);
+        GLintptr gridVertexOffset = gridVertexStream.upload(grid.vertices().data(), grid.vertices().size() * sizeof(float));
+        glBindVertexArray(gridVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, gridVertexStream.id());
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)gridVertexOffset);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridIndexStream.id());
+        glBindVertexArray(0);
+        gpuTimer.begin(GPU_GRID);
+        DrawGrid(shaderProgram, modelLoc, gridVAO, gridIndexCount, gridIndexOffset);
+        gpuTimer.end(GPU_GRID);
+
+        // Orbites prédites : une line strip par corps, dans la couleur du corps
+        gpuTimer.begin(GPU_TRAILS);
+        if (showTrails && trailCount > 1) {
+            glBindVertexArray(trailVAO);
+            for (size_t b = 0; b < trailIds.size(); ++b) {
+                if (trailIds[b] >= objs.size() || !objs[trailIds[b]].alive) continue;
+                const glm::vec4& col = objs[trailIds[b]].color;
+                glUniform4f(objectColorLoc, col.r, col.g, col.b, 0.45f);
+                glDrawArrays(GL_LINE_STRIP, GLint(b * trailCapacity), GLsizei(trailCount));
             }
+            glBindVertexArray(0);
+        }
+        gpuTimer.end(GPU_TRAILS);
 
-            if(!pause){
-                obj.UpdatePos();
-            }
+        // Et maintenant : les objets (la gravité a déjà été appliquée plus haut)
+        gpuTimer.begin(GPU_OBJECTS);
+        glUniform1i(isGridLoc, 0);
+        glm::vec3 eye = camera.position();
+        int boundLevel = -1;
+        for(auto& obj : objs) {
+            if (!obj.alive) continue;
+            glUniform4f(objectColorLoc, obj.color.r, obj.color.g, obj.color.b, obj.color.a);
 
             glm::mat4 model = glm::mat4(1.0f);
             model = glm::translate(model, obj.position);
+            model = glm::scale(model, glm::vec3(obj.radius));
             glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform1i(glGetUniformLocation(shaderProgram, "isGrid"), 0);
-            glUniform1i(glGetUniformLocation(shaderProgram, "GLOW"), obj.glow ? 1 : 0);
+            glUniform1i(glowLoc, obj.glow ? 1 : 0);
+
+            // niveau de détail selon la taille à l'écran ; on ne rebinde le VAO que quand il change
+            int level = SphereMeshCache::SelectLevel(obj.radius, glm::length(obj.position - eye), glm::radians(45.0f), g_fbHeight);
+            const SphereMesh& mesh = sphereMeshes.get(level);
+            if (level != boundLevel) {
+                glBindVertexArray(mesh.VAO);
+                boundLevel = level;
+            }
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_SHORT, nullptr);
+        }
+        glBindVertexArray(0);
+        gpuTimer.end(GPU_OBJECTS);
+
+        // L'essaim en dernier : additif, sans écrire la profondeur
+        if (swarmFilled) {
+            gpuTimer.begin(GPU_SWARM);
+            glUseProgram(swarmProgram);
+            glm::mat4 view = glm::lookAt(camera.position(), camera.target, glm::vec3(0.0f, 1.0f, 0.0f));
+            glUniformMatrix4fv(swarmViewLoc, 1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(swarmProjectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+            glEnable(GL_PROGRAM_POINT_SIZE);
+            glDepthMask(GL_FALSE);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+            glBindVertexArray(swarmVAO);
+            glDrawArrays(GL_POINTS, 0, GLsizei(swarm.size()));
+            glBindVertexArray(0);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDepthMask(GL_TRUE);
+            glUseProgram(shaderProgram);
+            gpuTimer.end(GPU_SWARM);
+        }
 
-            glBindVertexArray(obj.VAO);
-            glDrawArrays(GL_TRIANGLES, 0, obj.vertexCount / 3);
+        // Fin de frame : une fence par buffer de streaming, pour savoir quand la région redevient libre
+        gridVertexStream.endFrame();
+        gridIndexStream.endFrame();
+        trailStream.endFrame();
+        swarmStream.endFrame();
+        gpuTimer.endFrame();
+        if (currentFrame - lastGpuReport > 2.0f) {
+            gpuTimer.report(std::cout);
+            lastGpuReport = currentFrame;
         }
 
         glfwSwapBuffers(window);
@@ -498,13 +807,20 @@ int main() {
     }
 
     // Ménage de fin (on libère la RAM avant que le PC chauffe)
-    for (auto& obj : objs) {
-        glDeleteVertexArrays(1, &obj.VAO);
-        glDeleteBuffers(1, &obj.VBO);
-    }
+    sphereMeshes.release();
 
+    predictor.reset();
+    if (swarmProgram) {
+        glDeleteVertexArrays(1, &swarmVAO);
+        swarmStream.release();
+        glDeleteProgram(swarmProgram);
+    }
+    glDeleteVertexArrays(1, &trailVAO);
+    trailStream.release();
     glDeleteVertexArrays(1, &gridVAO);
-    glDeleteBuffers(1, &gridVBO);
+    gridVertexStream.release();
+    gridIndexStream.release();
+    gpuTimer.release();
     glDeleteProgram(shaderProgram);
     glfwTerminate();
 
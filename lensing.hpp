@@ -0,0 +1,297 @@
+// lensing.hpp
+// Batched 2-D null geodesics around a Schwarzschild mass (BlackHole_curv).
+//
+// Same equations and RK4 step as the original one-ray-at-a-time code: the
+// state is (r, φ, dr/dλ, dφ/dλ) plus the conserved energy E, in double
+// precision.  Rays are stored as SoA arrays and advanced 2 per SIMD iteration
+// (SSE2 on x86-64, NEON on ARM64, scalar elsewhere), in fixed-size chunks on
+// the ThreadPool.  The kernel is written once against small lane traits, so
+// the SIMD lanes and the scalar tail run exactly the same operations.
+//
+// A ray stops when it crosses the horizon (r <= r_s) or leaves the escape
+// radius.  Each chunk compacts its survivors in place, then the chunks are
+// slid together, so the arrays only ever hold rays still in flight and a
+// step costs O(live rays).  Every ray keeps the id it was seeded with, for
+// per-ray render data such as trails.
+
+#ifndef LENSING_HPP
+#define LENSING_HPP
+
+#include "physics_asm.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LENSING_SSE 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define LENSING_NEON 1
+#endif
+
+namespace LensingSimd {
+
+    // One ray per "vector": the scalar tail, and the whole range without SIMD
+    struct D1 {
+        using V = double;
+        using M = bool;
+        static constexpr size_t W = 1;
+        static V    Load(const double* p)     { return *p; }
+        static void Store(double* p, V v)     { *p = v; }
+        static V    Set1(double s)            { return s; }
+        static V    Add(V a, V b)             { return a + b; }
+        static V    Sub(V a, V b)             { return a - b; }
+        static V    Mul(V a, V b)             { return a * b; }
+        static V    Div(V a, V b)             { return a / b; }
+        static M    Greater(V a, V b)         { return a > b; }   // false for NaN
+        static V    Select(M m, V a, V b)     { return m ? a : b; }
+    };
+
+#if LENSING_SSE
+    struct D2 {
+        using V = __m128d;
+        using M = __m128d;
+        static constexpr size_t W = 2;
+        static V    Load(const double* p)     { return _mm_loadu_pd(p); }
+        static void Store(double* p, V v)     { _mm_storeu_pd(p, v); }
+        static V    Set1(double s)            { return _mm_set1_pd(s); }
+        static V    Add(V a, V b)             { return _mm_add_pd(a, b); }
+        static V    Sub(V a, V b)             { return _mm_sub_pd(a, b); }
+        static V    Mul(V a, V b)             { return _mm_mul_pd(a, b); }
+        static V    Div(V a, V b)             { return _mm_div_pd(a, b); }
+        static M    Greater(V a, V b)         { return _mm_cmpgt_pd(a, b); }
+        static V    Select(M m, V a, V b)     { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+    };
+#elif LENSING_NEON
+    struct D2 {
+        using V = float64x2_t;
+        using M = uint64x2_t;
+        static constexpr size_t W = 2;
+        static V    Load(const double* p)     { return vld1q_f64(p); }
+        static void Store(double* p, V v)     { vst1q_f64(p, v); }
+        static V    Set1(double s)            { return vdupq_n_f64(s); }
+        static V    Add(V a, V b)             { return vaddq_f64(a, b); }
+        static V    Sub(V a, V b)             { return vsubq_f64(a, b); }
+        static V    Mul(V a, V b)             { return vmulq_f64(a, b); }
+        static V    Div(V a, V b)             { return vdivq_f64(a, b); }
+        static M    Greater(V a, V b)         { return vcgtq_f64(a, b); }
+        static V    Select(M m, V a, V b)     { return vbslq_f64(m, a, b); }
+    };
+#endif
+
+} // namespace LensingSimd
+
+class LensingRays {
+public:
+    static constexpr size_t CHUNK = 4096;
+
+    // Live rays only, compacted after every step
+    std::vector<double>   r, phi, dr, dphi, E;
+    std::vector<uint32_t> id;       // seeding order, stable for the ray's lifetime
+    std::vector<float>    xy;       // current Cartesian position (x, y) per ray, for drawing
+
+    struct StepStats { size_t captured = 0, escaped = 0; };
+
+    // Removes every ray; rs = Schwarzschild radius, rays beyond rEscape are dropped
+    void reset(double rsValue, double rEscapeValue) {
+        rs = rsValue;
+        rEscape = rEscapeValue;
+        for (auto* v : { &r, &phi, &dr, &dphi, &E }) v->clear();
+        id.clear();
+        xy.clear();
+        dead.clear();
+        nextId = 0;
+    }
+
+    size_t size() const { return r.size(); }
+    size_t seeded() const { return nextId; }      // ids handed out so far, live or not
+
+    // Ids of the rays removed by the last step (captured or escaped), ascending
+    const std::vector<uint32_t>& died() const { return dead; }
+
+    // One ray at (px, py) moving along (dx, dy), in metres and m/λ
+    void add(double px, double py, double dx, double dy) {
+        float  distSq = PhysicsASM::DistanceSquared(float(px), float(py), 0.0f, 0.0f, 0.0f, 0.0f);
+        double rr = std::sqrt(distSq);
+        double ph = std::atan2(py, px);
+        double vr = dx * std::cos(ph) + dy * std::sin(ph);
+        double vp = (-dx * std::sin(ph) + dy * std::cos(ph)) / rr;
+
+        // Conserved energy E = f·dt/dλ, fixed by the null condition ds² = 0
+        double f = 1.0 - rs / rr;
+        double dt_dl = std::sqrt((vr * vr) / (f * f) + (rr * rr * vp * vp) / f);
+
+        r.push_back(rr);  phi.push_back(ph);  dr.push_back(vr);  dphi.push_back(vp);
+        E.push_back(f * dt_dl);
+        id.push_back(nextId++);
+        xy.push_back(float(px));
+        xy.push_back(float(py));
+    }
+
+    // Parallel beam moving along +x from x0, n rays spread over `height` centred on y = 0
+    void seedBeam(size_t n, double x0, double height, double speed) {
+        double spacing = height / double(n);
+        for (size_t i = 0; i < n; ++i)
+            add(x0, (double(i) - double(n) / 2.0) * spacing, speed, 0.0);
+    }
+
+    // n rays from (x0, y0) spread evenly over ±halfAngle around the direction of the hole
+    void seedFan(size_t n, double x0, double y0, double halfAngle, double speed) {
+        double axis = std::atan2(-y0, -x0);
+        for (size_t i = 0; i < n; ++i) {
+            double a = n > 1 ? axis - halfAngle + 2.0 * halfAngle * double(i) / double(n - 1) : axis;
+            add(x0, y0, speed * std::cos(a), speed * std::sin(a));
+        }
+    }
+
+    // Isotropic point source: n rays over the full circle
+    void seedPoint(size_t n, double x0, double y0, double speed) {
+        for (size_t i = 0; i < n; ++i) {
+            double a = 6.283185307179586 * (double(i) + 0.5) / double(n);
+            add(x0, y0, speed * std::cos(a), speed * std::sin(a));
+        }
+    }
+
+    // Advances every ray by `substeps` RK4 steps of dλ, then drops the rays that
+    // were captured or escaped.  If trailRow is not null, it receives (x, y, seq)
+    // at index id for every ray advanced, including the ones that just died.
+    StepStats step(ThreadPool& pool, double dl, int substeps, float* trailRow = nullptr, float seq = 0.0f) {
+        size_t n = size();
+        size_t numChunks = (n + CHUNK - 1) / CHUNK;
+        kept.assign(numChunks, 0);
+        if (scratch.size() < pool.size()) scratch.resize(pool.size());
+        for (auto& s : scratch) {
+            s.died.clear();
+            s.stats = StepStats();
+        }
+
+        pool.parallelFor(n, CHUNK, [&](size_t b, size_t e, unsigned w) {
+            size_t i = b;
+#if LENSING_SSE || LENSING_NEON
+            i = advance<LensingSimd::D2>(i, e, dl, substeps);
+#endif
+            advance<LensingSimd::D1>(i, e, dl, substeps);
+            kept[b / CHUNK] = finish(b, e, trailRow, seq, scratch[w]);
+        });
+
+        // Survivors sit at the start of each chunk: slide the chunks together
+        size_t live = 0;
+        for (size_t c = 0; c < numChunks; ++c) {
+            size_t src = c * CHUNK, k = kept[c];
+            if (src != live && k) move(src, live, k);
+            live += k;
+        }
+        for (auto* v : { &r, &phi, &dr, &dphi, &E }) v->resize(live);
+        id.resize(live);
+        xy.resize(2 * live);
+
+        StepStats total;
+        dead.clear();
+        for (const auto& s : scratch) {
+            total.captured += s.stats.captured;
+            total.escaped  += s.stats.escaped;
+            dead.insert(dead.end(), s.died.begin(), s.died.end());
+        }
+        std::sort(dead.begin(), dead.end());
+        return total;
+    }
+
+private:
+    // ─── Kernel ──────────────────────────────────────────────────────────────
+    // d/dλ (r, φ, dr, dφ) for null geodesics in the equatorial plane
+    template <class S>
+    static void rhs(const typename S::V* y, typename S::V e, typename S::V rsV, typename S::V* k) {
+        using V = typename S::V;
+        const V one = S::Set1(1.0), two = S::Set1(2.0), zero = S::Set1(0.0);
+        V r = y[0], vr = y[2], vp = y[3];
+        V f  = S::Sub(one, S::Div(rsV, r));                     // Schwarzschild metric factor
+        V dt = S::Div(e, f);
+        V r2 = S::Mul(S::Mul(two, r), r);                       // 2r²
+        k[0] = vr;
+        k[1] = vp;
+        k[2] = S::Add(S::Add(S::Mul(S::Mul(S::Sub(zero, S::Div(rsV, r2)), f), S::Mul(dt, dt)),
+                             S::Mul(S::Div(rsV, S::Mul(r2, f)), S::Mul(vr, vr))),
+                      S::Mul(S::Sub(r, rsV), S::Mul(vp, vp)));
+        k[3] = S::Div(S::Mul(S::Mul(S::Set1(-2.0), vr), vp), r);
+    }
+
+    // Rays [i, e) in groups of S::W; returns where it stopped (the tail for a narrower S).
+    // A lane that reaches the horizon during the substeps keeps its state from then on.
+    template <class S>
+    size_t advance(size_t i, size_t e, double dl, int substeps) {
+        using V = typename S::V;
+        const V rsV = S::Set1(rs), half = S::Set1(dl / 2.0), full = S::Set1(dl);
+        const V sixth = S::Set1(dl / 6.0), two = S::Set1(2.0);
+        for (; i + S::W <= e; i += S::W) {
+            V y[4] = { S::Load(&r[i]), S::Load(&phi[i]), S::Load(&dr[i]), S::Load(&dphi[i]) };
+            const V en = S::Load(&E[i]);
+            for (int s = 0; s < substeps; ++s) {
+                typename S::M live = S::Greater(y[0], rsV);
+                V k1[4], k2[4], k3[4], k4[4], t[4];
+                rhs<S>(y, en, rsV, k1);
+                for (int c = 0; c < 4; ++c) t[c] = S::Add(y[c], S::Mul(k1[c], half));
+                rhs<S>(t, en, rsV, k2);
+                for (int c = 0; c < 4; ++c) t[c] = S::Add(y[c], S::Mul(k2[c], half));
+                rhs<S>(t, en, rsV, k3);
+                for (int c = 0; c < 4; ++c) t[c] = S::Add(y[c], S::Mul(k3[c], full));
+                rhs<S>(t, en, rsV, k4);
+                for (int c = 0; c < 4; ++c) {
+                    V sum = S::Add(S::Add(S::Add(k1[c], S::Mul(two, k2[c])), S::Mul(two, k3[c])), k4[c]);
+                    y[c] = S::Select(live, S::Add(y[c], S::Mul(sixth, sum)), y[c]);
+                }
+            }
+            S::Store(&r[i], y[0]);  S::Store(&phi[i], y[1]);  S::Store(&dr[i], y[2]);  S::Store(&dphi[i], y[3]);
+        }
+        return i;
+    }
+
+    struct alignas(64) Scratch {        // one cache line per worker
+        std::vector<uint32_t> died;
+        StepStats             stats;
+    };
+
+    // Cartesian positions, trail output, then in-chunk compaction.  Returns the survivors.
+    size_t finish(size_t b, size_t e, float* trailRow, float seq, Scratch& s) {
+        size_t w = b;
+        for (size_t i = b; i < e; ++i) {
+            float x = float(r[i] * std::cos(phi[i]));
+            float y = float(r[i] * std::sin(phi[i]));
+            if (trailRow) {
+                float* o = trailRow + size_t(id[i]) * 3;
+                o[0] = x;  o[1] = y;  o[2] = seq;
+            }
+            bool captured = !(r[i] > rs);       // NaN counts as captured
+            if (captured || !(r[i] < rEscape)) {
+                ++(captured ? s.stats.captured : s.stats.escaped);
+                s.died.push_back(id[i]);
+                continue;
+            }
+            r[w] = r[i];  phi[w] = phi[i];  dr[w] = dr[i];  dphi[w] = dphi[i];  E[w] = E[i];
+            id[w] = id[i];
+            xy[2 * w] = x;  xy[2 * w + 1] = y;
+            ++w;
+        }
+        return w - b;
+    }
+
+    void move(size_t src, size_t dst, size_t n) {
+        for (auto* v : { &r, &phi, &dr, &dphi, &E })
+            std::memmove(v->data() + dst, v->data() + src, n * sizeof(double));
+        std::memmove(id.data() + dst, id.data() + src, n * sizeof(uint32_t));
+        std::memmove(xy.data() + 2 * dst, xy.data() + 2 * src, 2 * n * sizeof(float));
+    }
+
+    double                rs      = 0.0;
+    double                rEscape = 1e300;
+    uint32_t              nextId  = 0;
+    std::vector<size_t>   kept;
+    std::vector<Scratch>  scratch;
+    std::vector<uint32_t> dead;
+};
+
+#endif // LENSING_HPP
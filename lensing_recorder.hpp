@@ -0,0 +1,158 @@
+// lensing_recorder.hpp
+// Background integration for BlackHole_curv.
+//
+// A worker thread owns the LensingRays and integrates them ahead of the
+// display: one sample every `substeps` RK4 steps, on its own ThreadPool.  A
+// sample is a full row of (x, y, sample number) per ray id — rays that have
+// stopped keep their last position — plus the ids that stopped during it.
+// The display plays the samples back at whatever speed it likes and
+// interpolates between them, so its frame rate never depends on the cost of
+// a step, and pausing or rewinding does not touch the integration.
+//
+// Rows go through a fixed ring, single producer / single consumer:
+//   - the worker publishes `available` after filling a row, and never writes
+//     row s before the render thread has consumed row s - rows;
+//   - the render thread reads rows [consumed, available), copies them where
+//     it needs them and calls consume(), which wakes the worker if the ring
+//     was full.
+// Neither side locks the rows; the mutex only backs the worker's wait.
+
+#ifndef LENSING_RECORDER_HPP
+#define LENSING_RECORDER_HPP
+
+#include "lensing.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class LensingRecorder {
+public:
+    // Sample numbers stored in the rows wrap here, so they stay exact in a float
+    static constexpr uint32_t SEQ_WRAP = 1u << 23;
+
+    struct Row {
+        std::vector<float>    xyz;    // rays × (x, y, sample number mod SEQ_WRAP), indexed by id
+        std::vector<uint32_t> died;   // ids whose last position is in this row
+    };
+
+    // Takes over seeded rays; rows = ring size, dl and substeps as in LensingRays::step.
+    LensingRecorder(LensingRays&& seeded, size_t rows, double stepLength, int substepsPerSample)
+        : rays(std::move(seeded)),
+          numRays(rays.seeded()),
+          dl(stepLength),
+          substeps(std::max(1, substepsPerSample)),
+          ring(std::max<size_t>(2, rows)) {
+        for (auto& r : ring) r.xyz.assign(numRays * 3, 0.0f);
+        current.assign(numRays * 3, 0.0f);
+        for (size_t i = 0; i < rays.size(); ++i) {
+            float* o = current.data() + size_t(rays.id[i]) * 3;
+            o[0] = rays.xy[2 * i];
+            o[1] = rays.xy[2 * i + 1];
+        }
+        liveCount.store(rays.size(), std::memory_order_relaxed);
+        worker = std::thread([this] { run(); });
+    }
+
+    ~LensingRecorder() {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    LensingRecorder(const LensingRecorder&) = delete;
+    LensingRecorder& operator=(const LensingRecorder&) = delete;
+
+    size_t   rayCount() const { return numRays; }
+    size_t   rows() const { return ring.size(); }
+    uint64_t available() const { return produced.load(std::memory_order_acquire); }
+
+    // Row of sample s, valid for consumed <= s < available()
+    const Row& row(uint64_t s) const { return ring[s % ring.size()]; }
+
+    // Rows below upTo are no longer needed
+    void consume(uint64_t upTo) {
+        consumed.store(upTo, std::memory_order_release);
+        { std::lock_guard<std::mutex> lk(mtx); }   // the worker is either before its check or already waiting
+        wake.notify_one();
+    }
+
+    // True once every ray has stopped and its last row has been published
+    bool finished() const { return done.load(std::memory_order_acquire); }
+
+    // Worker statistics, for the console
+    size_t   live() const { return liveCount.load(std::memory_order_relaxed); }
+    uint64_t captured() const { return capturedCount.load(std::memory_order_relaxed); }
+    uint64_t escaped() const { return escapedCount.load(std::memory_order_relaxed); }
+    uint64_t stepMicros() const { return stepUs.load(std::memory_order_relaxed); }
+
+private:
+    void run() {
+        ThreadPool pool;   // parallelFor is only ever called from this thread
+        for (uint64_t s = 0;; ++s) {
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                wake.wait(lk, [&] {
+                    return stopping || s < consumed.load(std::memory_order_acquire) + ring.size();
+                });
+                if (stopping) return;
+            }
+
+            Row& row = ring[s % ring.size()];
+            row.died.clear();
+            if (s > 0) {
+                auto t0 = std::chrono::steady_clock::now();
+                float seq = float(uint32_t(s) & (SEQ_WRAP - 1));
+                LensingRays::StepStats st = rays.step(pool, dl, substeps, current.data(), seq);
+                row.died = rays.died();
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0);
+                stepUs.fetch_add(uint64_t(us.count()), std::memory_order_relaxed);
+                capturedCount.fetch_add(st.captured, std::memory_order_relaxed);
+                escapedCount.fetch_add(st.escaped, std::memory_order_relaxed);
+                liveCount.store(rays.size(), std::memory_order_relaxed);
+            }
+            std::copy(current.begin(), current.end(), row.xyz.begin());
+            produced.store(s + 1, std::memory_order_release);
+
+            if (rays.size() == 0) {
+                done.store(true, std::memory_order_release);
+                std::unique_lock<std::mutex> lk(mtx);
+                wake.wait(lk, [&] { return stopping; });
+                return;
+            }
+        }
+    }
+
+    LensingRays        rays;          // worker only
+    std::vector<float> current;       // latest position of every id (worker only)
+    const size_t       numRays;
+    const double       dl;
+    const int          substeps;
+
+    std::vector<Row>      ring;
+    std::atomic<uint64_t> produced{0};
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<bool>     done{false};
+
+    std::atomic<size_t>   liveCount{0};
+    std::atomic<uint64_t> capturedCount{0};
+    std::atomic<uint64_t> escapedCount{0};
+    std::atomic<uint64_t> stepUs{0};
+
+    std::mutex              mtx;
+    std::condition_variable wake;
+    bool                    stopping = false;
+
+    std::thread worker;
+};
+
+#endif // LENSING_RECORDER_HPP
@@ -0,0 +1,301 @@
+// nbody.hpp
+// Structure-of-arrays N-body state and integrators for the simulation targets.
+//
+// Bodies live in parallel float arrays (positions, velocities, accelerations,
+// jerks, masses, radii) so that force loops stream through memory and the
+// collision module can work on the same storage in place.
+//
+// Force evaluation splits the target bodies into fixed-size chunks on a
+// ThreadPool.  Each target's sum is accumulated by exactly one thread with the
+// batched SIMD kernel from physics_asm.hpp, in a fixed lane order — no atomics,
+// no reduction across threads — so the result is bitwise identical for every
+// pool size.  The kernel width (SSE/AVX2/AVX-512/NEON) is chosen once per
+// process; different widths round differently.
+//
+// Time integration uses individual block timesteps: every body sits on a
+// power-of-two level L and advances with dt = frame / 2^L, chosen from its own
+// acceleration and jerk (Aarseth: dt = η·|a|/|ȧ|).  A frame is split into
+// 2^MAX_LEVEL integer ticks; on each substep all bodies drift, but only the
+// bodies whose step ends there get their forces evaluated and are kicked
+// (kick-drift-kick leapfrog per level).  A close encounter therefore only
+// refines the bodies taking part in it.
+
+#ifndef NBODY_HPP
+#define NBODY_HPP
+
+#include "collision.hpp"
+#include "physics_asm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Scene-unit conversion factors.  The defaults reproduce the original
+// Gravity_Grid tuning: positions are in km (×1000 for the force law), and a
+// frame applies v += a/96 then x += v/94.
+struct NBodyParams {
+    float G          = 6.67430e-11f;
+    float lengthToSI = 1000.0f;        // scene units → metres
+    float kickScale  = 1.0f / 96.0f;   // Δv per unit acceleration per frame
+    float driftScale = 1.0f / 94.0f;   // Δx per unit velocity per frame
+    float softening  = 0.0f;           // ε, scene units
+};
+
+class NBodySystem {
+public:
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> ax, ay, az;   // acceleration (m/s²) at the body's last force evaluation
+    std::vector<float> jx, jy, jz;   // jerk (m/s² per frame)
+    std::vector<float> mass, density, radius;
+    std::vector<uint8_t> level;      // block-timestep level, dt = frame / 2^level
+    std::vector<uint8_t> alive;
+    std::vector<uint32_t> id;        // stable identity, survives compaction
+
+    size_t size() const { return x.size(); }
+
+    size_t add(float px, float py, float pz, float pvx, float pvy, float pvz,
+               float m, float rho, float r) {
+        x.push_back(px);   y.push_back(py);   z.push_back(pz);
+        vx.push_back(pvx); vy.push_back(pvy); vz.push_back(pvz);
+        ax.push_back(0);   ay.push_back(0);   az.push_back(0);
+        jx.push_back(0);   jy.push_back(0);   jz.push_back(0);
+        mass.push_back(m); density.push_back(rho); radius.push_back(r);
+        level.push_back(0);
+        alive.push_back(1);
+        id.push_back(nextId++);
+        return x.size() - 1;
+    }
+
+    // Drops every body whose alive flag is 0, preserving order.
+    void compact() {
+        size_t w = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            if (!alive[i]) continue;
+            if (w != i) {
+                x[w] = x[i];   y[w] = y[i];   z[w] = z[i];
+                vx[w] = vx[i]; vy[w] = vy[i]; vz[w] = vz[i];
+                ax[w] = ax[i]; ay[w] = ay[i]; az[w] = az[i];
+                jx[w] = jx[i]; jy[w] = jy[i]; jz[w] = jz[i];
+                mass[w] = mass[i]; density[w] = density[i]; radius[w] = radius[i];
+                level[w] = level[i];
+                id[w] = id[i];
+                alive[w] = 1;
+            }
+            ++w;
+        }
+        for (auto* v : { &x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az,
+                         &jx, &jy, &jz, &mass, &density, &radius })
+            v->resize(w);
+        level.resize(w);
+        alive.resize(w);
+        id.resize(w);
+    }
+
+    CollisionBodies collisionView() {
+        CollisionBodies b;
+        b.x = x.data();   b.y = y.data();   b.z = z.data();
+        b.vx = vx.data(); b.vy = vy.data(); b.vz = vz.data();
+        b.mass = mass.data(); b.density = density.data(); b.radius = radius.data();
+        b.alive = alive.data();
+        b.count = size();
+        return b;
+    }
+
+private:
+    uint32_t nextId = 0;
+};
+
+// Acceleration and jerk on body i from every other body.
+//   a_i = Σ G m_j r_ij / |r_ij|³
+//   ȧ_i = Σ G m_j [ v_ij / |r_ij|³ − 3 (r_ij·v_ij) r_ij / |r_ij|⁵ ]
+// r_ij is taken in scene units with the SI conversion folded into the
+// coefficient; v_ij is converted to scene units per frame.
+inline void AccelJerk(const NBodySystem& s, size_t i, const NBodyParams& p,
+                      float& oax, float& oay, float& oaz,
+                      float& ojx, float& ojy, float& ojz) {
+    // Body i is not skipped: with softening its own term is exactly zero
+    // (d = 0, dv = 0), and without it the kernel drops sources with r² = 0.
+    PhysicsForceBatch b;
+    b.x  = s.x.data();  b.y  = s.y.data();  b.z  = s.z.data();
+    b.vx = s.vx.data(); b.vy = s.vy.data(); b.vz = s.vz.data();
+    b.mass  = s.mass.data();
+    b.count = s.size();
+    b.px  = s.x[i];  b.py  = s.y[i];  b.pz  = s.z[i];
+    b.pvx = s.vx[i]; b.pvy = s.vy[i]; b.pvz = s.vz[i];
+    b.k        = p.G / (p.lengthToSI * p.lengthToSI);
+    b.eps2     = p.softening * p.softening;
+    b.velScale = p.driftScale;
+
+    float out[6];
+    PhysicsASM::AccelJerkBatch(b, out);
+    oax = out[0]; oay = out[1]; oaz = out[2];
+    ojx = out[3]; ojy = out[4]; ojz = out[5];
+}
+
+// Targets per pool chunk.  Fixed, so the split never depends on the thread count.
+constexpr size_t NBODY_FORCE_CHUNK = 16;
+
+// Evaluates acceleration and jerk for the listed target bodies, in parallel
+// when a pool is given.  Every target is written by one thread only.
+inline void EvaluateForces(NBodySystem& s, const uint32_t* targets, size_t count,
+                           const NBodyParams& p, ThreadPool* pool = nullptr) {
+    auto body = [&](size_t b, size_t e, unsigned) {
+        for (size_t t = b; t < e; ++t) {
+            size_t i = targets[t];
+            AccelJerk(s, i, p, s.ax[i], s.ay[i], s.az[i], s.jx[i], s.jy[i], s.jz[i]);
+        }
+    };
+    if (pool) pool->parallelFor(count, NBODY_FORCE_CHUNK, body);
+    else      body(0, count, 0);
+}
+
+// Single global step of length dt (semi-implicit Euler: kick, then drift)
+// for every body.  Used by the ray-tracer scenes, where dt is wall-clock time.
+inline void StepUniform(NBodySystem& s, const NBodyParams& p, float dt,
+                        std::vector<uint32_t>& scratch, ThreadPool* pool = nullptr) {
+    const size_t n = s.size();
+    scratch.resize(n);
+    for (size_t i = 0; i < n; ++i) scratch[i] = uint32_t(i);
+    EvaluateForces(s, scratch.data(), n, p, pool);
+
+    const float kick = p.kickScale * dt, drift = p.driftScale * dt;
+    PhysicsASM::AxpyBatch(kick, s.ax.data(), s.vx.data(), n);
+    PhysicsASM::AxpyBatch(kick, s.ay.data(), s.vy.data(), n);
+    PhysicsASM::AxpyBatch(kick, s.az.data(), s.vz.data(), n);
+    PhysicsASM::AxpyBatch(drift, s.vx.data(), s.x.data(), n);
+    PhysicsASM::AxpyBatch(drift, s.vy.data(), s.y.data(), n);
+    PhysicsASM::AxpyBatch(drift, s.vz.data(), s.z.data(), n);
+}
+
+class BlockTimestepper {
+public:
+    static constexpr int      MAX_LEVEL = 8;
+    static constexpr uint32_t FRAME     = 1u << MAX_LEVEL;   // ticks per frame
+
+    float       eta  = 0.02f;     // accuracy parameter of the timestep criterion
+    ThreadPool* pool = nullptr;   // force evaluation runs here when set
+
+    struct Stats {
+        size_t occupancy[MAX_LEVEL + 1] = {};   // bodies per level at frame end
+        size_t forceEvals  = 0;                 // target evaluations this frame
+        size_t globalEvals = 0;                 // same frame with a single global dt
+        int    finestLevel = 0;                 // finest level used this frame
+    };
+
+    // Full force evaluation and level assignment — call after bodies were
+    // added, removed, merged or had their velocities changed externally.
+    void initialize(NBodySystem& s, const NBodyParams& p) {
+        targets.resize(s.size());
+        for (size_t i = 0; i < s.size(); ++i) targets[i] = uint32_t(i);
+        EvaluateForces(s, targets.data(), targets.size(), p, pool);
+        for (size_t i = 0; i < s.size(); ++i) s.level[i] = uint8_t(chooseLevel(s, i));
+        dirty = false;
+    }
+
+    void invalidate() { dirty = true; }
+    bool needsInit() const { return dirty; }
+
+    // Takes over a state whose accelerations, jerks and levels are current
+    // (a copy of another stepper's system), without re-evaluating forces —
+    // both steppers then produce bitwise identical trajectories.
+    void adopt(const NBodySystem& s) {
+        targets.resize(s.size());
+        dirty = false;
+    }
+
+    // Advances every body by one frame; all bodies are synchronised on return.
+    void step(NBodySystem& s, const NBodyParams& p) {
+        if (dirty || targets.size() != s.size()) initialize(s, p);
+        const size_t n = s.size();
+        last = Stats();
+        if (n == 0) return;
+
+        uint32_t t = 0;
+        while (t < FRAME) {
+            int maxL = 0;
+            for (size_t i = 0; i < n; ++i) maxL = std::max(maxL, int(s.level[i]));
+            last.finestLevel = std::max(last.finestLevel, maxL);
+            const uint32_t h = stride(maxL);
+
+            // Opening half-kick for bodies whose step starts now.
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t st = stride(s.level[i]);
+                if (t % st == 0) kick(s, i, p, 0.5f * float(st) / FRAME);
+            }
+
+            const float drift = p.driftScale * float(h) / FRAME;
+            for (size_t i = 0; i < n; ++i) {
+                s.x[i] += s.vx[i] * drift;
+                s.y[i] += s.vy[i] * drift;
+                s.z[i] += s.vz[i] * drift;
+            }
+            t += h;
+
+            targets.clear();
+            for (size_t i = 0; i < n; ++i)
+                if (t % stride(s.level[i]) == 0) targets.push_back(uint32_t(i));
+            EvaluateForces(s, targets.data(), targets.size(), p, pool);
+            last.forceEvals += targets.size();
+
+            // Closing half-kick, then pick the next level.  Coarsening is only
+            // allowed onto a block boundary of the coarser level.
+            for (uint32_t i : targets) {
+                uint32_t st = stride(s.level[i]);
+                kick(s, i, p, 0.5f * float(st) / FRAME);
+                int want = chooseLevel(s, i);
+                int cur  = s.level[i];
+                if (want > cur) {
+                    s.level[i] = uint8_t(want);
+                } else if (want < cur) {
+                    int L = cur;
+                    while (L > want && t % stride(L - 1) == 0) --L;
+                    s.level[i] = uint8_t(L);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) ++last.occupancy[s.level[i]];
+        last.globalEvals = n * (size_t(1) << last.finestLevel);
+    }
+
+    const Stats& stats() const { return last; }
+
+    // One-line summary, e.g. "L0:6 L3:2 | force evals 40/2048 (2.0%)".
+    void printStats(const char* tag) const {
+        std::printf("%s", tag);
+        for (int L = 0; L <= MAX_LEVEL; ++L)
+            if (last.occupancy[L]) std::printf(" L%d:%zu", L, last.occupancy[L]);
+        double pct = last.globalEvals ? 100.0 * double(last.forceEvals) / double(last.globalEvals) : 0.0;
+        std::printf("  | force evals %zu/%zu (%.1f%% of global dt)\n",
+                    last.forceEvals, last.globalEvals, pct);
+    }
+
+private:
+    static uint32_t stride(int level) { return FRAME >> level; }
+
+    static void kick(NBodySystem& s, size_t i, const NBodyParams& p, float frac) {
+        float k = p.kickScale * frac;
+        s.vx[i] += s.ax[i] * k;
+        s.vy[i] += s.ay[i] * k;
+        s.vz[i] += s.az[i] * k;
+    }
+
+    int chooseLevel(const NBodySystem& s, size_t i) const {
+        float a = std::sqrt(s.ax[i]*s.ax[i] + s.ay[i]*s.ay[i] + s.az[i]*s.az[i]);
+        float j = std::sqrt(s.jx[i]*s.jx[i] + s.jy[i]*s.jy[i] + s.jz[i]*s.jz[i]);
+        if (j <= 0.0f || a <= 0.0f) return 0;
+        float dt = eta * a / j;                  // in frames
+        if (dt >= 1.0f) return 0;
+        int L = int(std::ceil(std::log2(1.0f / dt)));
+        return std::min(std::max(L, 0), MAX_LEVEL);
+    }
+
+    std::vector<uint32_t> targets;
+    Stats last;
+    bool  dirty = true;
+};
+
+#endif // NBODY_HPP
@@ -0,0 +1,150 @@
+// object_grid.hpp
+// Coarse uniform grid over the scene's spheres, for the ray tracers.
+//
+// Every ray step tests "is this point inside a sphere?".  Instead of looping
+// over all objects, the tracer looks up the one cell containing the point
+// and tests only the spheres registered there.  A sphere is registered in
+// every cell its bounding box overlaps, so a point query never has to look
+// at neighbouring cells.
+//
+// The grid is stored CSR-style so it uploads as-is into shader storage
+// buffers:
+//   header   — bounds, inverse cell size, dimensions (std430-compatible)
+//   cells    — (first, count) into `indices`, one pair per cell, x fastest
+//   indices  — object indices, grouped by cell
+//
+// No GL in here: BlackHole_space uploads the three arrays itself.
+
+#ifndef OBJECT_GRID_HPP
+#define OBJECT_GRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Mirrors the head of `GridBuffer` in geodesic.comp (std430: vec4, vec4, ivec4).
+struct SceneGridHeader {
+    float   minX = 0, minY = 0, minZ = 0, _pad0 = 0;
+    float   invCellX = 0, invCellY = 0, invCellZ = 0, _pad1 = 0;
+    int32_t dimX = 0, dimY = 0, dimZ = 0, objectCount = 0;
+};
+static_assert(sizeof(SceneGridHeader) == 48, "SceneGridHeader must match the shader layout");
+
+class SceneGrid {
+public:
+    // posRadius: `count` spheres as xyz + radius, `stride` floats apart.
+    // targetPerCell sets the cell count (~count / targetPerCell cells,
+    // capped at maxDim per axis).
+    void build(const float* posRadius, size_t count, size_t stride = 4,
+               float targetPerCell = 2.0f, int maxDim = 64) {
+        hdr = SceneGridHeader();
+        hdr.objectCount = int32_t(count);
+        cellRanges.clear();
+        objectIndices.clear();
+        if (count == 0) {
+            hdr.dimX = hdr.dimY = hdr.dimZ = 0;
+            return;
+        }
+
+        // Bounds of all spheres.
+        float lo[3] = {  INFINITY,  INFINITY,  INFINITY };
+        float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (size_t i = 0; i < count; ++i) {
+            const float* s = posRadius + i * stride;
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::min(lo[a], s[a] - s[3]);
+                hi[a] = std::max(hi[a], s[a] + s[3]);
+            }
+        }
+
+        // Roughly cubic cells.  Flat scenes (all in a plane) would give zero
+        // volume, so thin axes are padded to the largest extent / maxDim.
+        float ext[3], maxExt = 0.0f;
+        for (int a = 0; a < 3; ++a) maxExt = std::max(maxExt, hi[a] - lo[a]);
+        maxExt = std::max(maxExt, 1e-6f);
+        for (int a = 0; a < 3; ++a) {
+            ext[a] = std::max(hi[a] - lo[a], maxExt / float(maxDim));
+            float c = 0.5f * (lo[a] + hi[a]);
+            lo[a] = c - 0.5f * ext[a];
+        }
+        double targetCells = std::max(1.0, double(count) / double(std::max(targetPerCell, 0.01f)));
+        double cell = std::cbrt(double(ext[0]) * ext[1] * ext[2] / targetCells);
+        int dims[3];
+        for (int a = 0; a < 3; ++a)
+            dims[a] = std::max(1, std::min(maxDim, int(std::ceil(ext[a] / cell))));
+
+        hdr.minX = lo[0];  hdr.minY = lo[1];  hdr.minZ = lo[2];
+        hdr.invCellX = float(dims[0]) / ext[0];
+        hdr.invCellY = float(dims[1]) / ext[1];
+        hdr.invCellZ = float(dims[2]) / ext[2];
+        hdr.dimX = dims[0];  hdr.dimY = dims[1];  hdr.dimZ = dims[2];
+
+        // Two passes: count per cell, prefix sum, then fill.
+        const size_t numCells = size_t(dims[0]) * dims[1] * dims[2];
+        cellRanges.assign(numCells * 2, 0);
+        forEachOverlap(posRadius, count, stride, [&](size_t, size_t cellIdx) { ++cellRanges[cellIdx * 2 + 1]; });
+        uint32_t running = 0;
+        for (size_t c = 0; c < numCells; ++c) {
+            cellRanges[c * 2] = running;
+            running += cellRanges[c * 2 + 1];
+            cellRanges[c * 2 + 1] = 0;
+        }
+        objectIndices.resize(running);
+        forEachOverlap(posRadius, count, stride, [&](size_t obj, size_t cellIdx) {
+            uint32_t& n = cellRanges[cellIdx * 2 + 1];
+            objectIndices[cellRanges[cellIdx * 2] + n++] = uint32_t(obj);
+        });
+    }
+
+    // Calls fn(objectIndex) for each sphere registered in the cell holding
+    // (x, y, z).  Same lookup as the shader; used by CPU-side checks.
+    template <class F>
+    void visit(float x, float y, float z, F&& fn) const {
+        long c = cellOf(x, y, z);
+        if (c < 0) return;
+        uint32_t first = cellRanges[size_t(c) * 2], n = cellRanges[size_t(c) * 2 + 1];
+        for (uint32_t k = 0; k < n; ++k) fn(objectIndices[first + k]);
+    }
+
+    const SceneGridHeader&       header()  const { return hdr; }
+    const std::vector<uint32_t>& cells()   const { return cellRanges; }
+    const std::vector<uint32_t>& indices() const { return objectIndices; }
+
+private:
+    long cellOf(float x, float y, float z) const {
+        if (hdr.dimX == 0) return -1;
+        int cx = int(std::floor((x - hdr.minX) * hdr.invCellX));
+        int cy = int(std::floor((y - hdr.minY) * hdr.invCellY));
+        int cz = int(std::floor((z - hdr.minZ) * hdr.invCellZ));
+        if (cx < 0 || cy < 0 || cz < 0 || cx >= hdr.dimX || cy >= hdr.dimY || cz >= hdr.dimZ) return -1;
+        return (long(cz) * hdr.dimY + cy) * hdr.dimX + cx;
+    }
+
+    int clampCell(float v, float mn, float inv, int dim) const {
+        return std::max(0, std::min(dim - 1, int(std::floor((v - mn) * inv))));
+    }
+
+    template <class F>
+    void forEachOverlap(const float* posRadius, size_t count, size_t stride, F&& fn) const {
+        for (size_t i = 0; i < count; ++i) {
+            const float* s = posRadius + i * stride;
+            int x0 = clampCell(s[0] - s[3], hdr.minX, hdr.invCellX, hdr.dimX);
+            int x1 = clampCell(s[0] + s[3], hdr.minX, hdr.invCellX, hdr.dimX);
+            int y0 = clampCell(s[1] - s[3], hdr.minY, hdr.invCellY, hdr.dimY);
+            int y1 = clampCell(s[1] + s[3], hdr.minY, hdr.invCellY, hdr.dimY);
+            int z0 = clampCell(s[2] - s[3], hdr.minZ, hdr.invCellZ, hdr.dimZ);
+            int z1 = clampCell(s[2] + s[3], hdr.minZ, hdr.invCellZ, hdr.dimZ);
+            for (int z = z0; z <= z1; ++z)
+                for (int y = y0; y <= y1; ++y)
+                    for (int x = x0; x <= x1; ++x)
+                        fn(i, (size_t(z) * hdr.dimY + y) * hdr.dimX + x);
+        }
+    }
+
+    SceneGridHeader       hdr;
+    std::vector<uint32_t> cellRanges;      // (first, count) per cell
+    std::vector<uint32_t> objectIndices;
+};
+
+#endif // OBJECT_GRID_HPP
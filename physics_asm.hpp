@@ -1,43 +1,69 @@
 #ifndef PHYSICS_ASM_HPP
 #define PHYSICS_ASM_HPP
 
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 // C++ interface to the hand-written assembly physics functions.
 //
 // The correct backend is selected at link time by CMake:
-//   ARM64 (Apple Silicon / Linux AArch64) : physics_asm_arm64.s
-//   x86-64 (Linux / other)                : physics_asm.s
+//   ARM64 (Apple Silicon / Linux AArch64) : physics_asm_arm64.S + physics_asm_batch_arm64.S
+//   x86-64 (Linux / other)                : physics_asm.s       + physics_asm_batch.s
 //
-// Both backends export the same six C-linkage symbols and implement
-// identical mathematical operations, so this header works unchanged on
-// all supported architectures.
+// Both backends export the six scalar functions below and the four batch
+// kernels (batch_distance_squared, batch_accel_jerk, batch_normalize3,
+// batch_axpy), all with C linkage and identical mathematical operations.
+// The batch symbols carry an ISA suffix: _sse, _avx2 and _avx512 on x86-64,
+// _neon on ARM64.  x86-64 also exports physics_asm_cpu_features and the two
+// ray-packet steps.  The wrappers below pick the right symbols, so callers
+// use this header unchanged on all supported architectures.
+//
+// The batched kernels (bottom of this file) work on whole SoA arrays.  x86-64
+// has SSE, AVX2 and AVX-512 versions of each; the widest one the CPU and OS
+// support is picked once, on first use.  ARM64 has a single NEON version.
+//
+// GeodesicRK4 and CartesianRK4 advance packets of four Schwarzschild rays by
+// one RK4 step (geodesic_rk4_sse / cartesian_rk4_sse in physics_asm.s).  Other
+// architectures run the C++ references, which the assembly reproduces
+// operation for operation.
+//
+// Configuring with -DPHYSICS_BACKEND=intrinsics defines PHYSICS_ASM_INTRINSICS
+// and links no assembly: the same functions are then defined inline in
+// physics_intrin.hpp (included at the end of this file) with compiler
+// intrinsics, so calls can be inlined into the surrounding loops.
+
+#if defined(PHYSICS_ASM_INTRINSICS)
+#define PHYSICS_ASM_FN inline           // defined in physics_intrin.hpp
+#else
+#define PHYSICS_ASM_FN extern "C"
+#endif
 
-extern "C" {
-    // Squared Euclidean distance between two 3-D points.
-    // Avoids sqrt — use for distance comparisons and force denominators.
-    float vector_distance_squared(float x1, float y1, float z1,
-                                   float x2, float y2, float z2);
+// Squared Euclidean distance between two 3-D points.
+// Avoids sqrt — use for distance comparisons and force denominators.
+PHYSICS_ASM_FN float vector_distance_squared(float x1, float y1, float z1,
+                                             float x2, float y2, float z2);
 
-    // Gravitational force magnitude: F = G * mass1 * mass2 / distance_squared
-    // All values in SI units (kg, m²).
-    float gravitational_force(float mass1, float mass2, float distance_squared);
+// Gravitational force magnitude: F = G * mass1 * mass2 / distance_squared
+// All values in SI units (kg, m²).
+PHYSICS_ASM_FN float gravitational_force(float mass1, float mass2, float distance_squared);
 
-    // Normalise a 3-D vector in place (sets its length to 1).
-    // No-op if the vector has zero length.
-    void normalize_vector3(float* vector);
+// Normalise a 3-D vector in place (sets its length to 1).
+// No-op if the vector has zero length.
+PHYSICS_ASM_FN void normalize_vector3(float* vector);
 
-    // Dot product of two 3-D vectors: v1 · v2 = x1*x2 + y1*y2 + z1*z2
-    float dot_product3(const float* v1, const float* v2);
+// Dot product of two 3-D vectors: v1 · v2 = x1*x2 + y1*y2 + z1*z2
+PHYSICS_ASM_FN float dot_product3(const float* v1, const float* v2);
 
-    // Element-wise addition: result = v1 + v2
-    void vector_add3(const float* v1, const float* v2, float* result);
+// Element-wise addition: result = v1 + v2
+PHYSICS_ASM_FN void vector_add3(const float* v1, const float* v2, float* result);
 
-    // Scalar multiplication: result = v * scalar
-    void vector_scale3(const float* v, float scalar, float* result);
-}
+// Scalar multiplication: result = v * scalar
+PHYSICS_ASM_FN void vector_scale3(const float* v, float scalar, float* result);
 
-// PhysicsASM namespace — clean C++ wrappers over the C-linkage functions above.
+// PhysicsASM namespace — clean C++ wrappers over the backend functions above.
 namespace PhysicsASM {
 
     inline float DistanceSquared(float x1, float y1, float z1,
@@ -67,4 +93,319 @@ namespace PhysicsASM {
 
 } // namespace PhysicsASM
 
+// ─── Batched SoA kernels ─────────────────────────────────────────────────────
+
+// Sources and target for batch_accel_jerk_*.  The assembly reads the fields
+// at fixed offsets, so the layout is frozen by the static_asserts below.
+struct PhysicsForceBatch {
+    const float* x;  const float* y;  const float* z;      // source positions
+    const float* vx; const float* vy; const float* vz;     // source velocities
+    const float* mass;
+    size_t count;
+    float px, py, pz;       // target position
+    float pvx, pvy, pvz;    // target velocity
+    float k;                // force constant (G, with any unit conversion folded in)
+    float eps2;             // softening², added to r²
+    float velScale;         // converts velocity differences to position units per step
+};
+static_assert(offsetof(PhysicsForceBatch, count) == 56 && offsetof(PhysicsForceBatch, px) == 64 &&
+              offsetof(PhysicsForceBatch, velScale) == 96, "PhysicsForceBatch layout is hard-coded in the assembly");
+
+#define PHYSICS_ASM_BATCH_DECL(isa) \
+    PHYSICS_ASM_FN void batch_distance_squared_##isa(const float* x, const float* y, const float* z, \
+                                                     float px, float py, float pz, float* out, size_t n); \
+    PHYSICS_ASM_FN void batch_accel_jerk_##isa(const PhysicsForceBatch* batch, float* out6); \
+    PHYSICS_ASM_FN void batch_normalize3_##isa(float* x, float* y, float* z, size_t n); \
+    PHYSICS_ASM_FN void batch_axpy_##isa(float a, const float* x, float* y, size_t n);
+
+#if defined(PHYSICS_ASM_INTRINSICS)
+PHYSICS_ASM_BATCH_DECL(intrin)
+#elif defined(__x86_64__) || defined(_M_X64)
+// Bit 0 SSE2, bit 1 AVX2+FMA, bit 2 AVX-512F (each only if the OS saves the registers)
+PHYSICS_ASM_FN unsigned physics_asm_cpu_features(void);
+PHYSICS_ASM_BATCH_DECL(sse)
+PHYSICS_ASM_BATCH_DECL(avx2)
+PHYSICS_ASM_BATCH_DECL(avx512)
+#else
+PHYSICS_ASM_BATCH_DECL(neon)
+#endif
+#undef PHYSICS_ASM_BATCH_DECL
+
+namespace PhysicsASM {
+
+    // One instruction-set flavour of the batched kernels.
+    struct BatchKernels {
+        const char* name;
+        const char* key;    // value of PHYSICS_ASM_ISA that selects it
+        void (*distanceSquared)(const float*, const float*, const float*, float, float, float, float*, size_t);
+        void (*accelJerk)(const PhysicsForceBatch*, float*);
+        void (*normalize)(float*, float*, float*, size_t);
+        void (*axpy)(float, const float*, float*, size_t);
+    };
+
+#if defined(PHYSICS_ASM_INTRINSICS)
+    // One flavour, as wide as the compiler flags allow (see physics_intrin.hpp)
+    enum BatchIsa { BATCH_INTRIN = 0, BATCH_ISA_COUNT = 1 };
+
+    inline const BatchKernels& BatchKernelsFor(BatchIsa);
+    inline bool BatchIsaSupported(BatchIsa) { return true; }
+#elif defined(__x86_64__) || defined(_M_X64)
+    enum BatchIsa { BATCH_SSE = 0, BATCH_AVX2 = 1, BATCH_AVX512 = 2, BATCH_ISA_COUNT = 3 };
+
+    inline const BatchKernels& BatchKernelsFor(BatchIsa isa) {
+        static const BatchKernels table[BATCH_ISA_COUNT] = {
+            { "SSE",     "sse",    batch_distance_squared_sse,    batch_accel_jerk_sse,
+                                   batch_normalize3_sse,          batch_axpy_sse },
+            { "AVX2",    "avx2",   batch_distance_squared_avx2,   batch_accel_jerk_avx2,
+                                   batch_normalize3_avx2,         batch_axpy_avx2 },
+            { "AVX-512", "avx512", batch_distance_squared_avx512, batch_accel_jerk_avx512,
+                                   batch_normalize3_avx512,       batch_axpy_avx512 },
+        };
+        return table[isa];
+    }
+
+    inline bool BatchIsaSupported(BatchIsa isa) {
+        static const unsigned features = physics_asm_cpu_features();
+        return (features >> isa) & 1u;
+    }
+#else
+    enum BatchIsa { BATCH_NEON = 0, BATCH_ISA_COUNT = 1 };
+
+    inline const BatchKernels& BatchKernelsFor(BatchIsa) {
+        static const BatchKernels neon = { "NEON", "neon", batch_distance_squared_neon, batch_accel_jerk_neon,
+                                           batch_normalize3_neon, batch_axpy_neon };
+        return neon;
+    }
+
+    inline bool BatchIsaSupported(BatchIsa) { return true; }   // NEON is mandatory on AArch64
+#endif
+
+    // The widest supported flavour, chosen once.  PHYSICS_ASM_ISA=sse|avx2 forces a
+    // narrower one (for comparisons); anything else keeps the widest.
+    inline const BatchKernels& Batch() {
+        static const BatchKernels& chosen = [] () -> const BatchKernels& {
+            int best = 0;
+            for (int i = 0; i < BATCH_ISA_COUNT; ++i)
+                if (BatchIsaSupported(BatchIsa(i))) best = i;
+            if (const char* cap = std::getenv("PHYSICS_ASM_ISA"))
+                for (int i = 0; i < best; ++i)
+                    if (std::strcmp(cap, BatchKernelsFor(BatchIsa(i)).key) == 0) best = i;
+            return BatchKernelsFor(BatchIsa(best));
+        }();
+        return chosen;
+    }
+
+    // out[i] = |p_i − (px, py, pz)|²
+    inline void DistanceSquaredBatch(const float* x, const float* y, const float* z,
+                                     float px, float py, float pz, float* out, size_t n) {
+#if defined(PHYSICS_ASM_INTRINSICS)
+        batch_distance_squared_intrin(x, y, z, px, py, pz, out, n);
+#else
+        Batch().distanceSquared(x, y, z, px, py, pz, out, n);
+#endif
+    }
+
+    // Acceleration and jerk on one target from every source; out6 = ax, ay, az, jx, jy, jz.
+    // The lanes are summed in a fixed order, so the result depends only on the
+    // inputs and the chosen instruction set, never on threading.
+    inline void AccelJerkBatch(const PhysicsForceBatch& batch, float* out6) {
+#if defined(PHYSICS_ASM_INTRINSICS)
+        batch_accel_jerk_intrin(&batch, out6);
+#else
+        Batch().accelJerk(&batch, out6);
+#endif
+    }
+
+    // Normalises n SoA vectors in place; zero vectors are left unchanged.
+    inline void NormalizeBatch(float* x, float* y, float* z, size_t n) {
+#if defined(PHYSICS_ASM_INTRINSICS)
+        batch_normalize3_intrin(x, y, z, n);
+#else
+        Batch().normalize(x, y, z, n);
+#endif
+    }
+
+    // y[i] += a * x[i]
+    inline void AxpyBatch(float a, const float* x, float* y, size_t n) {
+#if defined(PHYSICS_ASM_INTRINSICS)
+        batch_axpy_intrin(a, x, y, n);
+#else
+        Batch().axpy(a, x, y, n);
+#endif
+    }
+
+    inline const char* BatchIsaName() { return Batch().name; }
+
+    // "asm" or "intrinsics", as chosen with PHYSICS_BACKEND at configure time
+    inline const char* BackendName() {
+#if defined(PHYSICS_ASM_INTRINSICS)
+        return "intrinsics";
+#else
+        return "asm";
+#endif
+    }
+
+} // namespace PhysicsASM
+
+// ─── Geodesic RK4 packets ────────────────────────────────────────────────────
+
+// Four ray states, one per SSE lane.  r, theta, phi, their derivatives and E
+// are advanced in place; x, y, z receive the Cartesian position after the step.
+// The assembly reads the fields at fixed offsets (16 bytes apart).
+struct alignas(16) GeodesicPacket {
+    float r[4], theta[4], phi[4];
+    float dr[4], dtheta[4], dphi[4];
+    float E[4];
+    float x[4], y[4], z[4];
+};
+static_assert(sizeof(GeodesicPacket) == 160 && offsetof(GeodesicPacket, E) == 96 &&
+              offsetof(GeodesicPacket, x) == 112, "GeodesicPacket layout is hard-coded in the assembly");
+
+// Four rays in the trig-free Cartesian form (see CartesianRK4 below).
+struct alignas(16) CartesianPacket {
+    float x[4], y[4], z[4];
+    float vx[4], vy[4], vz[4];
+    float h2[4];            // |x × v|², conserved along the ray
+};
+static_assert(sizeof(CartesianPacket) == 112 && offsetof(CartesianPacket, h2) == 96,
+              "CartesianPacket layout is hard-coded in the assembly");
+
+#if defined(PHYSICS_ASM_INTRINSICS)
+PHYSICS_ASM_FN void cartesian_rk4_intrin(CartesianPacket* packets, size_t count, float dL, float rs);
+#elif defined(__x86_64__) || defined(_M_X64)
+PHYSICS_ASM_FN void geodesic_rk4_sse(GeodesicPacket* packets, size_t count, float dL, float rs);
+PHYSICS_ASM_FN void cartesian_rk4_sse(CartesianPacket* packets, size_t count, float dL, float rs);
+#endif
+
+namespace PhysicsASM {
+
+    // Scalar twin of the assembly's 4-lane sin/cos (Cephes polynomials, π/4
+    // reduction in three parts; about 1 ulp for |x| < 8192).
+    inline void SinCosPoly(float x, float& s, float& c) {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof bits);
+        uint32_t signSin = bits & 0x80000000u;
+        float ax = std::fabs(x);
+        int32_t j = int32_t(ax * 1.27323954473516f);
+        j = (j + 1) & ~1;
+        float y = float(j);
+        signSin ^= uint32_t(j & 4) << 29;
+        uint32_t signCos = uint32_t(~(j - 2) & 4) << 29;
+        ax = ((ax + y * -0.78515625f) + y * -2.4187564849853515625e-4f) + y * -3.77489497744594108e-8f;
+        float z  = ax * ax;
+        float pc = ((((2.443315711809948e-5f * z + -1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z) * z
+                    - z * 0.5f) + 1.0f;
+        float ps = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z + -1.6666654611e-1f) * z * ax + ax;
+        float sv = (j & 2) ? pc : ps, cv = (j & 2) ? ps : pc;
+        std::memcpy(&bits, &sv, sizeof bits);  bits ^= signSin;  std::memcpy(&s, &bits, sizeof bits);
+        std::memcpy(&bits, &cv, sizeof bits);  bits ^= signCos;  std::memcpy(&c, &bits, sizeof bits);
+    }
+
+    // Second derivatives of the Schwarzschild null geodesic (same expressions
+    // as the ray tracers' geodesicRHS).
+    inline void GeodesicRHSReference(float r, float theta, float dr, float dtheta, float dphi,
+                                     float E, float rs, float& ar, float& atheta, float& aphi) {
+        float f     = 1.0f - rs / r;
+        float dt_dL = E / f;
+        float st, ct;
+        SinCosPoly(theta, st, ct);
+        ar     = -(rs / (2.0f * r * r)) * f * dt_dL * dt_dL
+                 + (rs / (2.0f * r * r * f)) * dr * dr
+                 + r * (dtheta * dtheta + st * st * dphi * dphi);
+        atheta = -2.0f * dr * dtheta / r + st * ct * dphi * dphi;
+        aphi   = -2.0f * dr * dphi / r - 2.0f * ct / st * dtheta * dphi;
+    }
+
+    // One RK4 step for every lane of every packet, in plain C++.
+    inline void GeodesicRK4Reference(GeodesicPacket* packets, size_t count, float dL, float rs) {
+        const float half = dL * 0.5f, c = dL / 6.0f;
+        for (size_t n = 0; n < count; ++n) {
+            GeodesicPacket& p = packets[n];
+            for (int l = 0; l < 4; ++l) {
+                const float y0[6] = { p.r[l], p.theta[l], p.phi[l], p.dr[l], p.dtheta[l], p.dphi[l] };
+                float k[6], acc[6], s[6];
+                auto eval = [&](const float* st) {
+                    k[0] = st[3];  k[1] = st[4];  k[2] = st[5];
+                    GeodesicRHSReference(st[0], st[1], st[3], st[4], st[5], p.E[l], rs, k[3], k[4], k[5]);
+                };
+                eval(y0);
+                for (int i = 0; i < 6; ++i) acc[i] = k[i];
+                for (int stage = 1; stage < 4; ++stage) {
+                    const float h = stage < 3 ? half : dL;
+                    for (int i = 0; i < 6; ++i) s[i] = y0[i] + h * k[i];
+                    eval(s);
+                    for (int i = 0; i < 6; ++i) acc[i] += stage < 3 ? 2.0f * k[i] : k[i];
+                }
+                p.r[l]  = y0[0] + c * acc[0];  p.theta[l]  = y0[1] + c * acc[1];  p.phi[l]  = y0[2] + c * acc[2];
+                p.dr[l] = y0[3] + c * acc[3];  p.dtheta[l] = y0[4] + c * acc[4];  p.dphi[l] = y0[5] + c * acc[5];
+
+                float st, ct, sp, cp;
+                SinCosPoly(p.theta[l], st, ct);
+                SinCosPoly(p.phi[l], sp, cp);
+                p.x[l] = p.r[l] * st * cp;
+                p.y[l] = p.r[l] * st * sp;
+                p.z[l] = p.r[l] * ct;
+            }
+        }
+    }
+
+    // One RK4 step of length dL for count packets (4 rays each), rs = Schwarzschild radius.
+    inline void GeodesicRK4(GeodesicPacket* packets, size_t count, float dL, float rs) {
+#if !defined(PHYSICS_ASM_INTRINSICS) && (defined(__x86_64__) || defined(_M_X64))
+        geodesic_rk4_sse(packets, count, dL, rs);
+#else
+        GeodesicRK4Reference(packets, count, dL, rs);
+#endif
+    }
+
+    // Exact Schwarzschild photon orbits in Cartesian form (the spherical step
+    // above omits f on the centrifugal term): with h = |x × v| conserved,
+    // the orbit equation u'' + u = (3/2) r_s u² becomes
+    //   d²x/dλ² = −(3/2) r_s h² x / r⁵
+    // No trig, no pole singularity, no reprojection.  Plain C++ version.
+    inline void CartesianRK4Reference(CartesianPacket* packets, size_t count, float dL, float rs) {
+        const float half = dL * 0.5f, c = dL / 6.0f, krs = -1.5f * rs;
+        for (size_t n = 0; n < count; ++n) {
+            CartesianPacket& p = packets[n];
+            for (int l = 0; l < 4; ++l) {
+                const float y0[6] = { p.x[l], p.y[l], p.z[l], p.vx[l], p.vy[l], p.vz[l] };
+                float k[6], acc[6], s[6];
+                auto eval = [&](const float* st) {
+                    float invR2 = 1.0f / (st[0] * st[0] + st[1] * st[1] + st[2] * st[2]);
+                    float kf    = (p.h2[l] * invR2) * (krs * std::sqrt(invR2)) * invR2;   // stays in float range
+                    k[0] = st[3];       k[1] = st[4];       k[2] = st[5];
+                    k[3] = kf * st[0];  k[4] = kf * st[1];  k[5] = kf * st[2];
+                };
+                eval(y0);
+                for (int i = 0; i < 6; ++i) acc[i] = k[i];
+                for (int stage = 1; stage < 4; ++stage) {
+                    const float h = stage < 3 ? half : dL;
+                    for (int i = 0; i < 6; ++i) s[i] = y0[i] + h * k[i];
+                    eval(s);
+                    for (int i = 0; i < 6; ++i) acc[i] += stage < 3 ? 2.0f * k[i] : k[i];
+                }
+                p.x[l]  = y0[0] + c * acc[0];  p.y[l]  = y0[1] + c * acc[1];  p.z[l]  = y0[2] + c * acc[2];
+                p.vx[l] = y0[3] + c * acc[3];  p.vy[l] = y0[4] + c * acc[4];  p.vz[l] = y0[5] + c * acc[5];
+            }
+        }
+    }
+
+    // One Cartesian RK4 step of length dL for count packets (4 rays each).
+    inline void CartesianRK4(CartesianPacket* packets, size_t count, float dL, float rs) {
+#if defined(PHYSICS_ASM_INTRINSICS)
+        cartesian_rk4_intrin(packets, count, dL, rs);
+#elif defined(__x86_64__) || defined(_M_X64)
+        cartesian_rk4_sse(packets, count, dL, rs);
+#else
+        CartesianRK4Reference(packets, count, dL, rs);
+#endif
+    }
+
+} // namespace PhysicsASM
+
+#if defined(PHYSICS_ASM_INTRINSICS)
+#include "physics_intrin.hpp"
+#endif
+#undef PHYSICS_ASM_FN
+
 #endif // PHYSICS_ASM_HPP
@@ -255,6 +255,507 @@ vector_scale3:
     ret
     .size vector_scale3, .-vector_scale3
 
+/* ============================================================================
+ * geodesic_rk4_sse
+ * Avance des paquets de 4 rayons de Schwarzschild d'un pas RK4 complet
+ * (même équations et même ordre d'opérations que PhysicsASM::GeodesicRK4Reference).
+ * Chaque paquet est en SoA : une voie SSE = un rayon.
+ *
+ * Paramètres:
+ *   %rdi  = GeodesicPacket* (voir physics_asm.hpp)
+ *   %rsi  = nombre de paquets
+ *   %xmm0 = dL (pas du paramètre affine)
+ *   %xmm1 = rs (rayon de Schwarzschild)
+ *
+ * Disposition d'un paquet (octets, 4 flottants par champ):
+ *   0 r, 16 theta, 32 phi, 48 dr, 64 dtheta, 80 dphi, 96 E,
+ *   112 x, 128 y, 144 z (sorties : position cartésienne après le pas)
+ * ============================================================================
+ */
+/* Cadre de pile (adressé via %r8, aligné sur 16) */
+    .set GEO_S_R,    0              /* état de l'étage courant */
+    .set GEO_S_TH,   16
+    .set GEO_S_PH,   32
+    .set GEO_S_DR,   48
+    .set GEO_S_DTH,  64
+    .set GEO_S_DPH,  80
+    .set GEO_K_R,    96             /* dérivées secondes de l'étage (sortie de .Lgeo_rhs) */
+    .set GEO_K_TH,   112
+    .set GEO_K_PH,   128
+    .set GEO_A_R,    144            /* somme k1 + 2k2 + 2k3 + k4 */
+    .set GEO_A_TH,   160
+    .set GEO_A_PH,   176
+    .set GEO_A_DR,   192
+    .set GEO_A_DTH,  208
+    .set GEO_A_DPH,  224
+    .set GEO_RS,     240            /* constantes diffusées */
+    .set GEO_DL,     256
+    .set GEO_HALF,   272
+    .set GEO_C,      288
+    .set GEO_FRAME,  304
+
+/* dst = y0 + h * k, avec h dans %xmm7 */
+.macro GEO_DELTA k, y0, dst
+    movaps  \k(%r8), %xmm0
+    mulps   %xmm7, %xmm0
+    movups  \y0(%rdi), %xmm1
+    addps   %xmm0, %xmm1
+    movaps  %xmm1, \dst(%r8)
+.endm
+
+/* Étage suivant : S = y0 + h * (S.dr, S.dtheta, S.dphi, K) ; positions d'abord,
+ * elles lisent les vitesses de l'étage courant avant qu'on les écrase */
+.macro GEO_STAGE h
+    movaps  \h(%r8), %xmm7
+    GEO_DELTA GEO_S_DR,  0,  GEO_S_R
+    GEO_DELTA GEO_S_DTH, 16, GEO_S_TH
+    GEO_DELTA GEO_S_DPH, 32, GEO_S_PH
+    GEO_DELTA GEO_K_R,   48, GEO_S_DR
+    GEO_DELTA GEO_K_TH,  64, GEO_S_DTH
+    GEO_DELTA GEO_K_PH,  80, GEO_S_DPH
+.endm
+
+/* acc += 2 * k */
+.macro GEO_ACC2 k, acc
+    movaps  \k(%r8), %xmm0
+    addps   %xmm0, %xmm0
+    addps   \acc(%r8), %xmm0
+    movaps  %xmm0, \acc(%r8)
+.endm
+
+/* acc += k */
+.macro GEO_ACC1 k, acc
+    movaps  \k(%r8), %xmm0
+    addps   \acc(%r8), %xmm0
+    movaps  %xmm0, \acc(%r8)
+.endm
+
+/* y = y0 + c * acc, écrit dans le paquet (c dans %xmm7) */
+.macro GEO_FINAL acc, off
+    movaps  \acc(%r8), %xmm0
+    mulps   %xmm7, %xmm0
+    movups  \off(%rdi), %xmm1
+    addps   %xmm0, %xmm1
+    movups  %xmm1, \off(%rdi)
+.endm
+
+    .globl geodesic_rk4_sse
+    .type geodesic_rk4_sse, @function
+geodesic_rk4_sse:
+    pushq   %rbp
+    movq    %rsp, %rbp
+    subq    $GEO_FRAME, %rsp
+    andq    $-16, %rsp
+    movq    %rsp, %r8               /* r8 = base du cadre (rsp bouge pendant les call) */
+
+    shufps  $0, %xmm0, %xmm0        /* dL sur les 4 voies */
+    shufps  $0, %xmm1, %xmm1        /* rs sur les 4 voies */
+    movaps  %xmm1, GEO_RS(%r8)
+    movaps  %xmm0, GEO_DL(%r8)
+    movaps  %xmm0, %xmm2
+    mulps   .Lgeo_half(%rip), %xmm2
+    movaps  %xmm2, GEO_HALF(%r8)    /* dL * 0.5 */
+    divps   .Lgeo_six(%rip), %xmm0
+    movaps  %xmm0, GEO_C(%r8)       /* dL / 6 */
+
+.Lgeo_packet:
+    testq   %rsi, %rsi
+    jz      .Lgeo_done
+
+    /* Étage 1 : S = y0 */
+    movups  0(%rdi), %xmm0
+    movaps  %xmm0, GEO_S_R(%r8)
+    movups  16(%rdi), %xmm0
+    movaps  %xmm0, GEO_S_TH(%r8)
+    movups  32(%rdi), %xmm0
+    movaps  %xmm0, GEO_S_PH(%r8)
+    movups  48(%rdi), %xmm0
+    movaps  %xmm0, GEO_S_DR(%r8)
+    movaps  %xmm0, GEO_A_R(%r8)     /* acc = k1 (partie position = vitesses) */
+    movups  64(%rdi), %xmm0
+    movaps  %xmm0, GEO_S_DTH(%r8)
+    movaps  %xmm0, GEO_A_TH(%r8)
+    movups  80(%rdi), %xmm0
+    movaps  %xmm0, GEO_S_DPH(%r8)
+    movaps  %xmm0, GEO_A_PH(%r8)
+    call    .Lgeo_rhs
+    movaps  GEO_K_R(%r8), %xmm0
+    movaps  %xmm0, GEO_A_DR(%r8)
+    movaps  GEO_K_TH(%r8), %xmm0
+    movaps  %xmm0, GEO_A_DTH(%r8)
+    movaps  GEO_K_PH(%r8), %xmm0
+    movaps  %xmm0, GEO_A_DPH(%r8)
+
+    /* Étage 2 : y0 + dL/2 * k1 */
+    GEO_STAGE GEO_HALF
+    call    .Lgeo_rhs
+    GEO_ACC2 GEO_S_DR,  GEO_A_R
+    GEO_ACC2 GEO_S_DTH, GEO_A_TH
+    GEO_ACC2 GEO_S_DPH, GEO_A_PH
+    GEO_ACC2 GEO_K_R,   GEO_A_DR
+    GEO_ACC2 GEO_K_TH,  GEO_A_DTH
+    GEO_ACC2 GEO_K_PH,  GEO_A_DPH
+
+    /* Étage 3 : y0 + dL/2 * k2 */
+    GEO_STAGE GEO_HALF
+    call    .Lgeo_rhs
+    GEO_ACC2 GEO_S_DR,  GEO_A_R
+    GEO_ACC2 GEO_S_DTH, GEO_A_TH
+    GEO_ACC2 GEO_S_DPH, GEO_A_PH
+    GEO_ACC2 GEO_K_R,   GEO_A_DR
+    GEO_ACC2 GEO_K_TH,  GEO_A_DTH
+    GEO_ACC2 GEO_K_PH,  GEO_A_DPH
+
+    /* Étage 4 : y0 + dL * k3 */
+    GEO_STAGE GEO_DL
+    call    .Lgeo_rhs
+    GEO_ACC1 GEO_S_DR,  GEO_A_R
+    GEO_ACC1 GEO_S_DTH, GEO_A_TH
+    GEO_ACC1 GEO_S_DPH, GEO_A_PH
+    GEO_ACC1 GEO_K_R,   GEO_A_DR
+    GEO_ACC1 GEO_K_TH,  GEO_A_DTH
+    GEO_ACC1 GEO_K_PH,  GEO_A_DPH
+
+    /* y1 = y0 + dL/6 * acc */
+    movaps  GEO_C(%r8), %xmm7
+    GEO_FINAL GEO_A_R,   0
+    GEO_FINAL GEO_A_TH,  16
+    GEO_FINAL GEO_A_PH,  32
+    GEO_FINAL GEO_A_DR,  48
+    GEO_FINAL GEO_A_DTH, 64
+    GEO_FINAL GEO_A_DPH, 80
+
+    /* Reprojection sphérique → cartésienne */
+    movups  16(%rdi), %xmm0
+    call    .Lsincos_ps
+    movaps  %xmm0, %xmm8            /* sin theta */
+    movaps  %xmm1, %xmm9            /* cos theta */
+    movups  32(%rdi), %xmm0
+    call    .Lsincos_ps             /* xmm0 = sin phi, xmm1 = cos phi */
+    movups  0(%rdi), %xmm10         /* r */
+    movaps  %xmm10, %xmm11
+    mulps   %xmm8, %xmm11           /* r sin theta */
+    movaps  %xmm11, %xmm12
+    mulps   %xmm1, %xmm12
+    movups  %xmm12, 112(%rdi)       /* x */
+    mulps   %xmm0, %xmm11
+    movups  %xmm11, 128(%rdi)       /* y */
+    mulps   %xmm9, %xmm10
+    movups  %xmm10, 144(%rdi)       /* z */
+
+    addq    $160, %rdi
+    decq    %rsi
+    jmp     .Lgeo_packet
+
+.Lgeo_done:
+    movq    %rbp, %rsp
+    popq    %rbp
+    ret
+
+/* Second membre des équations géodésiques pour l'étage S (lu dans le cadre %r8,
+ * E lu dans le paquet %rdi).  Écrit K = (d²r, d²theta, d²phi).  Détruit xmm0-xmm15. */
+.Lgeo_rhs:
+    movaps  GEO_S_TH(%r8), %xmm0
+    call    .Lsincos_ps
+    movaps  %xmm0, %xmm8            /* st */
+    movaps  %xmm1, %xmm9            /* ct */
+    movaps  GEO_S_R(%r8), %xmm10    /* r */
+
+    movaps  GEO_RS(%r8), %xmm2
+    divps   %xmm10, %xmm2
+    movaps  .Lgeo_one(%rip), %xmm11
+    subps   %xmm2, %xmm11           /* f = 1 - rs/r */
+    movups  96(%rdi), %xmm12
+    divps   %xmm11, %xmm12          /* dt/dL = E / f */
+
+    movaps  %xmm10, %xmm13
+    addps   %xmm13, %xmm13
+    mulps   %xmm10, %xmm13          /* 2 r r */
+    movaps  GEO_RS(%r8), %xmm2
+    divps   %xmm13, %xmm2
+    mulps   %xmm11, %xmm2
+    mulps   %xmm12, %xmm2
+    mulps   %xmm12, %xmm2           /* rs/(2r²) f (dt/dL)² */
+    mulps   %xmm11, %xmm13          /* 2 r r f */
+    movaps  GEO_RS(%r8), %xmm3
+    divps   %xmm13, %xmm3
+    movaps  GEO_S_DR(%r8), %xmm14   /* dr */
+    mulps   %xmm14, %xmm3
+    mulps   %xmm14, %xmm3           /* rs/(2r²f) dr² */
+    subps   %xmm2, %xmm3
+
+    movaps  GEO_S_DTH(%r8), %xmm4   /* dtheta */
+    movaps  GEO_S_DPH(%r8), %xmm5   /* dphi */
+    movaps  %xmm8, %xmm6
+    mulps   %xmm8, %xmm6
+    mulps   %xmm5, %xmm6
+    mulps   %xmm5, %xmm6            /* st² dphi² */
+    movaps  %xmm4, %xmm7
+    mulps   %xmm4, %xmm7
+    addps   %xmm7, %xmm6
+    mulps   %xmm10, %xmm6           /* r (dtheta² + st² dphi²) */
+    addps   %xmm6, %xmm3
+    movaps  %xmm3, GEO_K_R(%r8)
+
+    movaps  %xmm14, %xmm15
+    mulps   .Lgeo_minus_two(%rip), %xmm15   /* -2 dr */
+    movaps  %xmm15, %xmm2
+    mulps   %xmm4, %xmm2
+    divps   %xmm10, %xmm2           /* -2 dr dtheta / r */
+    movaps  %xmm8, %xmm6
+    mulps   %xmm9, %xmm6
+    mulps   %xmm5, %xmm6
+    mulps   %xmm5, %xmm6            /* st ct dphi² */
+    addps   %xmm6, %xmm2
+    movaps  %xmm2, GEO_K_TH(%r8)
+
+    mulps   %xmm5, %xmm15
+    divps   %xmm10, %xmm15          /* -2 dr dphi / r */
+    movaps  %xmm9, %xmm6
+    addps   %xmm6, %xmm6
+    divps   %xmm8, %xmm6
+    mulps   %xmm4, %xmm6
+    mulps   %xmm5, %xmm6            /* 2 ct/st dtheta dphi */
+    subps   %xmm6, %xmm15
+    movaps  %xmm15, GEO_K_PH(%r8)
+    ret
+
+/* Sinus et cosinus de 4 flottants (polynômes de Cephes, réduction par pi/4 en
+ * trois morceaux ; ~1 ulp pour |x| < 8192).
+ * Entrée: %xmm0 = x.  Sortie: %xmm0 = sin x, %xmm1 = cos x.  Détruit xmm2-xmm7. */
+.Lsincos_ps:
+    movaps  %xmm0, %xmm4
+    andps   .Lgeo_sign(%rip), %xmm4         /* signe du sinus = signe de x */
+    andps   .Lgeo_abs(%rip), %xmm0          /* x = |x| */
+    movaps  %xmm0, %xmm2
+    mulps   .Lgeo_fopi(%rip), %xmm2
+    cvttps2dq %xmm2, %xmm3                  /* j = (int)(|x| * 4/pi) */
+    paddd   .Lgeo_i1(%rip), %xmm3
+    pand    .Lgeo_inot1(%rip), %xmm3        /* j = (j + 1) & ~1 */
+    cvtdq2ps %xmm3, %xmm2                   /* y = (float)j */
+    movdqa  %xmm3, %xmm5
+    movdqa  %xmm3, %xmm6
+    pand    .Lgeo_i4(%rip), %xmm6
+    pslld   $29, %xmm6
+    pxor    %xmm6, %xmm4                    /* j & 4 : le sinus change de signe */
+    pand    .Lgeo_i2(%rip), %xmm3
+    pxor    %xmm6, %xmm6
+    pcmpeqd %xmm6, %xmm3                    /* masque : (j & 2) == 0 → pas d'échange sin/cos */
+    psubd   .Lgeo_i2(%rip), %xmm5
+    pandn   .Lgeo_i4(%rip), %xmm5
+    pslld   $29, %xmm5                      /* signe du cosinus : ~(j - 2) & 4 */
+
+    movaps  %xmm2, %xmm6                    /* x -= y * pi/4, en trois morceaux */
+    mulps   .Lgeo_dp1(%rip), %xmm6
+    addps   %xmm6, %xmm0
+    movaps  %xmm2, %xmm6
+    mulps   .Lgeo_dp2(%rip), %xmm6
+    addps   %xmm6, %xmm0
+    mulps   .Lgeo_dp3(%rip), %xmm2
+    addps   %xmm2, %xmm0
+    movaps  %xmm0, %xmm7
+    mulps   %xmm7, %xmm7                    /* z = x² */
+
+    movaps  .Lgeo_cos0(%rip), %xmm1        /* polynôme du cosinus */
+    mulps   %xmm7, %xmm1
+    addps   .Lgeo_cos1(%rip), %xmm1
+    mulps   %xmm7, %xmm1
+    addps   .Lgeo_cos2(%rip), %xmm1
+    mulps   %xmm7, %xmm1
+    mulps   %xmm7, %xmm1
+    movaps  %xmm7, %xmm6
+    mulps   .Lgeo_half(%rip), %xmm6
+    subps   %xmm6, %xmm1
+    addps   .Lgeo_one(%rip), %xmm1
+
+    movaps  .Lgeo_sin0(%rip), %xmm2        /* polynôme du sinus */
+    mulps   %xmm7, %xmm2
+    addps   .Lgeo_sin1(%rip), %xmm2
+    mulps   %xmm7, %xmm2
+    addps   .Lgeo_sin2(%rip), %xmm2
+    mulps   %xmm7, %xmm2
+    mulps   %xmm0, %xmm2
+    addps   %xmm0, %xmm2
+
+    movaps  %xmm3, %xmm6                    /* sélection selon le masque */
+    andps   %xmm2, %xmm6
+    movaps  %xmm3, %xmm0
+    andnps  %xmm1, %xmm0
+    orps    %xmm6, %xmm0                    /* sin */
+    andps   %xmm3, %xmm1
+    andnps  %xmm2, %xmm3
+    orps    %xmm3, %xmm1                    /* cos */
+    xorps   %xmm4, %xmm0
+    xorps   %xmm5, %xmm1
+    ret
+    .size geodesic_rk4_sse, .-geodesic_rk4_sse
+
+/* ============================================================================
+ * cartesian_rk4_sse
+ * Forme cartésienne des mêmes orbites de photons : avec h = |x × v| conservé,
+ *   d²x/dλ² = −(3/2) rs h² x / r⁵
+ * Un pas RK4 pour des paquets de 4 rayons, sans trigonométrie ni reprojection
+ * (mêmes opérations que PhysicsASM::CartesianRK4Reference).
+ *
+ * Paramètres:
+ *   %rdi  = CartesianPacket* (voir physics_asm.hpp)
+ *   %rsi  = nombre de paquets
+ *   %xmm0 = dL
+ *   %xmm1 = rs
+ *
+ * Disposition d'un paquet (octets, 4 flottants par champ):
+ *   0 x, 16 y, 32 z, 48 vx, 64 vy, 80 vz, 96 h²
+ *
+ * Registres: xmm0-2 = position de l'étage, xmm3-5 = vitesse de l'étage,
+ *            xmm8-13 = somme k1 + 2k2 + 2k3 + k4, xmm15 = −1.5 rs,
+ *            xmm6 = facteur d'accélération, xmm7 / xmm14 temporaires.
+ * dL/2, dL et dL/6 vivent dans la zone rouge (fonction feuille).
+ * ============================================================================
+ */
+/* xmm6 = −1.5 rs h² / r⁵ pour la position xmm0-2 */
+.macro CART_K
+    movaps  %xmm0, %xmm6
+    mulps   %xmm0, %xmm6
+    movaps  %xmm1, %xmm7
+    mulps   %xmm1, %xmm7
+    addps   %xmm7, %xmm6
+    movaps  %xmm2, %xmm7
+    mulps   %xmm2, %xmm7
+    addps   %xmm7, %xmm6            /* r² */
+    movaps  .Lgeo_one(%rip), %xmm7
+    divps   %xmm6, %xmm7            /* 1/r² */
+    sqrtps  %xmm7, %xmm6            /* 1/r */
+    mulps   %xmm15, %xmm6           /* −1.5 rs / r */
+    movups  96(%rdi), %xmm14
+    mulps   %xmm7, %xmm14           /* h² / r² */
+    mulps   %xmm14, %xmm6
+    mulps   %xmm7, %xmm6            /* −1.5 rs h² / r⁵ */
+.endm
+
+/* Accélération de l'étage : la position devient k_v = facteur * position */
+.macro CART_KV
+    mulps   %xmm6, %xmm0
+    mulps   %xmm6, %xmm1
+    mulps   %xmm6, %xmm2
+.endm
+
+/* acc = k (premier étage) */
+.macro CART_ACC_INIT
+    CART_KV
+    movaps  %xmm3, %xmm8
+    movaps  %xmm4, %xmm9
+    movaps  %xmm5, %xmm10
+    movaps  %xmm0, %xmm11
+    movaps  %xmm1, %xmm12
+    movaps  %xmm2, %xmm13
+.endm
+
+/* acc += 2 k */
+.macro CART_ACC2_ONE src, acc
+    movaps  \src, %xmm7
+    addps   %xmm7, %xmm7
+    addps   %xmm7, \acc
+.endm
+.macro CART_ACC2
+    CART_KV
+    CART_ACC2_ONE %xmm3, %xmm8
+    CART_ACC2_ONE %xmm4, %xmm9
+    CART_ACC2_ONE %xmm5, %xmm10
+    CART_ACC2_ONE %xmm0, %xmm11
+    CART_ACC2_ONE %xmm1, %xmm12
+    CART_ACC2_ONE %xmm2, %xmm13
+.endm
+
+/* acc += k */
+.macro CART_ACC1
+    CART_KV
+    addps   %xmm3, %xmm8
+    addps   %xmm4, %xmm9
+    addps   %xmm5, %xmm10
+    addps   %xmm0, %xmm11
+    addps   %xmm1, %xmm12
+    addps   %xmm2, %xmm13
+.endm
+
+/* Étage suivant pour une composante : p = y0.p + h v,  v = y0.v + h k_v (h dans xmm14) */
+.macro CART_NEXT_ONE p, v, off
+    movaps  \v, %xmm7
+    mulps   %xmm14, %xmm7
+    movups  \off(%rdi), %xmm6
+    addps   %xmm7, %xmm6
+    mulps   %xmm14, \p
+    movups  48+\off(%rdi), \v
+    addps   \p, \v
+    movaps  %xmm6, \p
+.endm
+.macro CART_NEXT h
+    movups  \h(%rsp), %xmm14
+    CART_NEXT_ONE %xmm0, %xmm3, 0
+    CART_NEXT_ONE %xmm1, %xmm4, 16
+    CART_NEXT_ONE %xmm2, %xmm5, 32
+.endm
+
+/* y = y0 + c acc (c dans xmm14) */
+.macro CART_FINAL acc, off
+    mulps   %xmm14, \acc
+    movups  \off(%rdi), %xmm7
+    addps   \acc, %xmm7
+    movups  %xmm7, \off(%rdi)
+.endm
+
+    .globl cartesian_rk4_sse
+    .type cartesian_rk4_sse, @function
+cartesian_rk4_sse:
+    shufps  $0, %xmm0, %xmm0        /* dL sur les 4 voies */
+    movups  %xmm0, -32(%rsp)
+    movaps  %xmm0, %xmm2
+    mulps   .Lgeo_half(%rip), %xmm2
+    movups  %xmm2, -16(%rsp)        /* dL * 0.5 */
+    divps   .Lgeo_six(%rip), %xmm0
+    movups  %xmm0, -48(%rsp)        /* dL / 6 */
+    shufps  $0, %xmm1, %xmm1
+    mulps   .Lcart_minus_1_5(%rip), %xmm1
+    movaps  %xmm1, %xmm15           /* −1.5 rs */
+
+.Lcart_packet:
+    testq   %rsi, %rsi
+    jz      .Lcart_done
+
+    movups  0(%rdi), %xmm0          /* étage 1 : y0 */
+    movups  16(%rdi), %xmm1
+    movups  32(%rdi), %xmm2
+    movups  48(%rdi), %xmm3
+    movups  64(%rdi), %xmm4
+    movups  80(%rdi), %xmm5
+
+    CART_K
+    CART_ACC_INIT
+    CART_NEXT -16                   /* y0 + dL/2 k1 */
+    CART_K
+    CART_ACC2
+    CART_NEXT -16                   /* y0 + dL/2 k2 */
+    CART_K
+    CART_ACC2
+    CART_NEXT -32                   /* y0 + dL k3 */
+    CART_K
+    CART_ACC1
+
+    movups  -48(%rsp), %xmm14
+    CART_FINAL %xmm8,  0
+    CART_FINAL %xmm9,  16
+    CART_FINAL %xmm10, 32
+    CART_FINAL %xmm11, 48
+    CART_FINAL %xmm12, 64
+    CART_FINAL %xmm13, 80
+
+    addq    $112, %rdi
+    decq    %rsi
+    jmp     .Lcart_packet
+
+.Lcart_done:
+    ret
+    .size cartesian_rk4_sse, .-cartesian_rk4_sse
+
 /* ============================================================================
  * Section de données - constantes
  * ============================================================================
@@ -264,4 +765,28 @@ vector_scale3:
 grav_const:
     .float 6.67430e-11              /* Constante gravitationnelle G */
 
+/* Constantes vectorielles de geodesic_rk4_sse (4 voies, alignées sur 16) */
+    .align 16
+.Lgeo_one:       .float 1.0, 1.0, 1.0, 1.0
+.Lgeo_half:      .float 0.5, 0.5, 0.5, 0.5
+.Lgeo_six:       .float 6.0, 6.0, 6.0, 6.0
+.Lgeo_minus_two: .float -2.0, -2.0, -2.0, -2.0
+.Lcart_minus_1_5: .float -1.5, -1.5, -1.5, -1.5
+.Lgeo_sign:      .long 0x80000000, 0x80000000, 0x80000000, 0x80000000
+.Lgeo_abs:       .long 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF
+.Lgeo_fopi:      .float 1.27323954473516, 1.27323954473516, 1.27323954473516, 1.27323954473516
+.Lgeo_i1:        .long 1, 1, 1, 1
+.Lgeo_inot1:     .long -2, -2, -2, -2
+.Lgeo_i2:        .long 2, 2, 2, 2
+.Lgeo_i4:        .long 4, 4, 4, 4
+.Lgeo_dp1:       .float -0.78515625, -0.78515625, -0.78515625, -0.78515625
+.Lgeo_dp2:       .float -2.4187564849853515625e-4, -2.4187564849853515625e-4, -2.4187564849853515625e-4, -2.4187564849853515625e-4
+.Lgeo_dp3:       .float -3.77489497744594108e-8, -3.77489497744594108e-8, -3.77489497744594108e-8, -3.77489497744594108e-8
+.Lgeo_cos0:      .float 2.443315711809948e-5, 2.443315711809948e-5, 2.443315711809948e-5, 2.443315711809948e-5
+.Lgeo_cos1:      .float -1.388731625493765e-3, -1.388731625493765e-3, -1.388731625493765e-3, -1.388731625493765e-3
+.Lgeo_cos2:      .float 4.166664568298827e-2, 4.166664568298827e-2, 4.166664568298827e-2, 4.166664568298827e-2
+.Lgeo_sin0:      .float -1.9515295891e-4, -1.9515295891e-4, -1.9515295891e-4, -1.9515295891e-4
+.Lgeo_sin1:      .float 8.3321608736e-3, 8.3321608736e-3, 8.3321608736e-3, 8.3321608736e-3
+.Lgeo_sin2:      .float -1.6666654611e-1, -1.6666654611e-1, -1.6666654611e-1, -1.6666654611e-1
+
     .section .note.GNU-stack,"",@progbits
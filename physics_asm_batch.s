@@ -0,0 +1,892 @@
+/*
+ * Noyaux "tableau" pour les boucles N-corps et grille : au lieu d'un appel par élément,
+ * un appel traite n éléments stockés en SoA (x[], y[], z[] séparés).
+ *
+ * Chaque noyau existe en trois largeurs :
+ *   _sse     4 flottants / instruction  (SSE2, toujours présent en x86-64)
+ *   _avx2    8 flottants / instruction  (AVX2 + FMA)
+ *   _avx512 16 flottants / instruction  (AVX-512F, queue de boucle masquée avec k1)
+ * Le choix se fait une seule fois au démarrage (physics_asm.hpp) d'après
+ * physics_asm_cpu_features, qui interroge CPUID et XGETBV.
+ *
+ * Règle commune : boucle vectorielle, réduction horizontale des accumulateurs, puis
+ * queue scalaire (ss) pour les n % largeur derniers éléments (SSE / AVX2).
+ *
+ * Cible: x86-64 (Linux/macOS)
+ * Syntaxe: AT&T (GNU Assembler)
+ * Convention d'appel: System V AMD64 ABI
+ * ============================================================================
+ */
+
+    .text
+
+/* ============================================================================
+ * physics_asm_cpu_features
+ * Retourne un masque des jeux d'instructions utilisables (CPU ET système) :
+ *   bit 0 : SSE2  (toujours)
+ *   bit 1 : AVX2 + FMA, registres ymm sauvegardés par l'OS
+ *   bit 2 : AVX-512F + BMI2, registres zmm / k sauvegardés par l'OS
+ *
+ * Retour:
+ *   %eax = masque
+ * ============================================================================
+ */
+    .globl physics_asm_cpu_features
+    .type physics_asm_cpu_features, @function
+physics_asm_cpu_features:
+    pushq   %rbx                    /* cpuid écrase rbx (callee-saved) */
+    movl    $1, %r8d                /* r8d = résultat, SSE2 de base */
+
+    xorl    %eax, %eax
+    cpuid
+    cmpl    $7, %eax                /* feuille 7 disponible ? */
+    jb      .Lcpu_done
+
+    movl    $1, %eax
+    cpuid
+    andl    $0x18001000, %ecx       /* FMA (12) | OSXSAVE (27) | AVX (28) */
+    cmpl    $0x18001000, %ecx
+    jne     .Lcpu_done
+
+    xorl    %ecx, %ecx
+    xgetbv                          /* eax = XCR0 : états sauvegardés par l'OS */
+    movl    %eax, %r9d
+    andl    $0x06, %eax             /* XMM | YMM */
+    cmpl    $0x06, %eax
+    jne     .Lcpu_done
+
+    movl    $7, %eax
+    xorl    %ecx, %ecx
+    cpuid                           /* ebx = feuille 7 */
+    testl   $0x20, %ebx             /* AVX2 (5) */
+    jz      .Lcpu_done
+    orl     $2, %r8d
+
+    andl    $0x10100, %ebx          /* AVX-512F (16) | BMI2 (8) */
+    cmpl    $0x10100, %ebx
+    jne     .Lcpu_done
+    andl    $0xE6, %r9d             /* XMM | YMM | opmask | ZMM_Hi256 | Hi16_ZMM */
+    cmpl    $0xE6, %r9d
+    jne     .Lcpu_done
+    orl     $4, %r8d
+
+.Lcpu_done:
+    movl    %r8d, %eax
+    popq    %rbx
+    ret
+    .size physics_asm_cpu_features, .-physics_asm_cpu_features
+
+
+/* ============================================================================
+ * batch_distance_squared_{sse,avx2,avx512}
+ * out[i] = (x[i]-px)^2 + (y[i]-py)^2 + (z[i]-pz)^2
+ *
+ * Paramètres:
+ *   %rdi = x, %rsi = y, %rdx = z (tableaux de flottants)
+ *   %xmm0 = px, %xmm1 = py, %xmm2 = pz
+ *   %rcx = out
+ *   %r8  = n
+ * ============================================================================
+ */
+
+/* Un pas, SSE. S = ps (4 éléments) ou ss (1 élément), LD = movups ou movss */
+.macro DIST_SSE S, LD
+    \LD     (%rdi,%rax,4), %xmm3
+    sub\S   %xmm0, %xmm3            /* dx */
+    mul\S   %xmm3, %xmm3
+    \LD     (%rsi,%rax,4), %xmm4
+    sub\S   %xmm1, %xmm4            /* dy */
+    mul\S   %xmm4, %xmm4
+    \LD     (%rdx,%rax,4), %xmm5
+    sub\S   %xmm2, %xmm5            /* dz */
+    mul\S   %xmm5, %xmm5
+    add\S   %xmm4, %xmm3
+    add\S   %xmm5, %xmm3
+    \LD     %xmm3, (%rcx,%rax,4)
+.endm
+
+    .globl batch_distance_squared_sse
+    .type batch_distance_squared_sse, @function
+batch_distance_squared_sse:
+    shufps  $0, %xmm0, %xmm0        /* diffusion de px sur les 4 voies */
+    shufps  $0, %xmm1, %xmm1
+    shufps  $0, %xmm2, %xmm2
+    xorl    %eax, %eax              /* i = 0 */
+    movq    %r8, %r9
+    andq    $-4, %r9                /* r9 = n arrondi au multiple de 4 */
+.Lds_sse_loop:
+    cmpq    %r9, %rax
+    jae     .Lds_sse_tail
+    DIST_SSE ps, movups
+    addq    $4, %rax
+    jmp     .Lds_sse_loop
+.Lds_sse_tail:
+    cmpq    %r8, %rax
+    jae     .Lds_sse_done
+    DIST_SSE ss, movss
+    incq    %rax
+    jmp     .Lds_sse_tail
+.Lds_sse_done:
+    ret
+    .size batch_distance_squared_sse, .-batch_distance_squared_sse
+
+/* Un pas, AVX. R = ymm ou xmm, S = ps ou ss, LD = vmovups ou vmovss */
+.macro DIST_AVX R, S, LD
+    \LD     (%rdi,%rax,4), %\R\()3
+    vsub\S  %\R\()0, %\R\()3, %\R\()3
+    \LD     (%rsi,%rax,4), %\R\()4
+    vsub\S  %\R\()1, %\R\()4, %\R\()4
+    \LD     (%rdx,%rax,4), %\R\()5
+    vsub\S  %\R\()2, %\R\()5, %\R\()5
+    vmul\S  %\R\()3, %\R\()3, %\R\()3
+    vfmadd231\S %\R\()4, %\R\()4, %\R\()3
+    vfmadd231\S %\R\()5, %\R\()5, %\R\()3
+    \LD     %\R\()3, (%rcx,%rax,4)
+.endm
+
+    .globl batch_distance_squared_avx2
+    .type batch_distance_squared_avx2, @function
+batch_distance_squared_avx2:
+    vbroadcastss %xmm0, %ymm0
+    vbroadcastss %xmm1, %ymm1
+    vbroadcastss %xmm2, %ymm2
+    xorl    %eax, %eax
+    movq    %r8, %r9
+    andq    $-8, %r9
+.Lds_avx2_loop:
+    cmpq    %r9, %rax
+    jae     .Lds_avx2_tail
+    DIST_AVX ymm, ps, vmovups
+    addq    $8, %rax
+    jmp     .Lds_avx2_loop
+.Lds_avx2_tail:
+    cmpq    %r8, %rax
+    jae     .Lds_avx2_done
+    DIST_AVX xmm, ss, vmovss
+    incq    %rax
+    jmp     .Lds_avx2_tail
+.Lds_avx2_done:
+    vzeroupper
+    ret
+    .size batch_distance_squared_avx2, .-batch_distance_squared_avx2
+
+    .globl batch_distance_squared_avx512
+    .type batch_distance_squared_avx512, @function
+batch_distance_squared_avx512:
+    vbroadcastss %xmm0, %zmm0
+    vbroadcastss %xmm1, %zmm1
+    vbroadcastss %xmm2, %zmm2
+    xorl    %eax, %eax
+.Lds_512_loop:
+    movq    %r8, %r9
+    subq    %rax, %r9               /* r9 = éléments restants */
+    jbe     .Lds_512_done
+    kxnorw  %k1, %k1, %k1           /* 16 voies actives... */
+    cmpq    $16, %r9
+    jae     .Lds_512_step
+    bzhil   %r9d, .Lall_ones(%rip), %r9d
+    kmovw   %r9d, %k1               /* ...sauf en queue : (1 << reste) - 1 */
+.Lds_512_step:
+    vmovups (%rdi,%rax,4), %zmm3{%k1}{z}
+    vsubps  %zmm0, %zmm3, %zmm3
+    vmovups (%rsi,%rax,4), %zmm4{%k1}{z}
+    vsubps  %zmm1, %zmm4, %zmm4
+    vmovups (%rdx,%rax,4), %zmm5{%k1}{z}
+    vsubps  %zmm2, %zmm5, %zmm5
+    vmulps  %zmm3, %zmm3, %zmm3
+    vfmadd231ps %zmm4, %zmm4, %zmm3
+    vfmadd231ps %zmm5, %zmm5, %zmm3
+    vmovups %zmm3, (%rcx,%rax,4){%k1}
+    addq    $16, %rax
+    jmp     .Lds_512_loop
+.Lds_512_done:
+    vzeroupper
+    ret
+    .size batch_distance_squared_avx512, .-batch_distance_squared_avx512
+
+
+/* ============================================================================
+ * batch_accel_jerk_{sse,avx2,avx512}
+ * Accélération et jerk sur une cible, sommés sur toutes les sources j :
+ *   a    = Σ k m_j d / r³
+ *   jerk = Σ k m_j [ dv / r³ − 3 (d·dv) d / r⁵ ]
+ * avec d = pos_j − cible, dv = (vel_j − vel_cible) * velScale, r² = |d|² + eps2.
+ * Les sources avec r² <= 0 (la cible elle-même sans adoucissement) sont ignorées.
+ *
+ * Paramètres:
+ *   %rdi = const PhysicsForceBatch* (voir physics_asm.hpp pour la disposition)
+ *   %rsi = float out[6] : ax, ay, az, jx, jy, jz
+ *
+ * Disposition de PhysicsForceBatch (octets):
+ *   0 x, 8 y, 16 z, 24 vx, 32 vy, 40 vz, 48 mass, 56 count,
+ *   64 px, 68 py, 72 pz, 76 pvx, 80 pvy, 84 pvz, 88 k, 92 eps2, 96 velScale
+ * ============================================================================
+ */
+
+/* Constantes diffusées dans la pile (pas de 32 octets pour servir aussi l'AVX2) */
+    .set AJ_PX,    0
+    .set AJ_PY,    32
+    .set AJ_PZ,    64
+    .set AJ_PVX,   96
+    .set AJ_PVY,   128
+    .set AJ_PVZ,   160
+    .set AJ_K,     192
+    .set AJ_EPS,   224
+    .set AJ_VS,    256
+    .set AJ_THREE, 288
+    .set AJ_ONE,   320
+    .set AJ_OUT,   352
+    .set AJ_N,     360
+    .set AJ_FRAME, 384
+
+/* Prologue commun SSE / AVX2 : cadre aligné sur 32, pointeurs dans les registres.
+ * BCAST = macro de diffusion d'un flottant de la structure vers un emplacement de pile. */
+.macro AJ_PROLOGUE BCAST, WIDTH
+    pushq   %rbp
+    movq    %rsp, %rbp
+    subq    $AJ_FRAME, %rsp
+    andq    $-32, %rsp
+    \BCAST  64, AJ_PX
+    \BCAST  68, AJ_PY
+    \BCAST  72, AJ_PZ
+    \BCAST  76, AJ_PVX
+    \BCAST  80, AJ_PVY
+    \BCAST  84, AJ_PVZ
+    \BCAST  88, AJ_K
+    \BCAST  92, AJ_EPS
+    \BCAST  96, AJ_VS
+    \BCAST  .Lthree, AJ_THREE, rip
+    \BCAST  .Lone, AJ_ONE, rip
+    movq    %rsi, AJ_OUT(%rsp)
+    movq    0(%rdi), %r8            /* x */
+    movq    8(%rdi), %r9            /* y */
+    movq    16(%rdi), %r10          /* z */
+    movq    24(%rdi), %r11          /* vx */
+    movq    32(%rdi), %rcx          /* vy */
+    movq    40(%rdi), %rdx          /* vz */
+    movq    48(%rdi), %rax          /* masses */
+    movq    56(%rdi), %rdi          /* n */
+    movq    %rdi, AJ_N(%rsp)
+    andq    $-\WIDTH, %rdi          /* rdi = n arrondi à la largeur du vecteur */
+    xorl    %esi, %esi              /* rsi = j */
+.endm
+
+.macro BCAST_SSE off, slot, base=rdi
+    .ifc \base,rip
+    movss   \off(%rip), %xmm0
+    .else
+    movss   \off(%rdi), %xmm0
+    .endif
+    shufps  $0, %xmm0, %xmm0
+    movaps  %xmm0, \slot(%rsp)
+.endm
+
+.macro BCAST_AVX off, slot, base=rdi
+    .ifc \base,rip
+    vbroadcastss \off(%rip), %ymm0
+    .else
+    vbroadcastss \off(%rdi), %ymm0
+    .endif
+    vmovaps %ymm0, \slot(%rsp)
+.endm
+
+/* Un pas, SSE (S = ps ou ss, LD = movups ou movss).
+ * Accumulateurs : xmm10-12 = a, xmm13-15 = jerk. Même ordre d'opérations que AccelJerk en C++. */
+.macro AJ_SSE S, LD
+    \LD     (%r8,%rsi,4), %xmm0
+    sub\S   AJ_PX(%rsp), %xmm0      /* dx */
+    \LD     (%r9,%rsi,4), %xmm1
+    sub\S   AJ_PY(%rsp), %xmm1      /* dy */
+    \LD     (%r10,%rsi,4), %xmm2
+    sub\S   AJ_PZ(%rsp), %xmm2      /* dz */
+    movaps  %xmm0, %xmm3
+    mul\S   %xmm3, %xmm3
+    movaps  %xmm1, %xmm4
+    mul\S   %xmm4, %xmm4
+    add\S   %xmm4, %xmm3
+    movaps  %xmm2, %xmm4
+    mul\S   %xmm4, %xmm4
+    add\S   %xmm4, %xmm3
+    add\S   AJ_EPS(%rsp), %xmm3     /* r2 */
+    xorps   %xmm9, %xmm9
+    cmplt\S %xmm3, %xmm9            /* xmm9 = (0 < r2) */
+    sqrt\S  %xmm3, %xmm3
+    movaps  AJ_ONE(%rsp), %xmm4
+    div\S   %xmm3, %xmm4            /* 1/r */
+    andps   %xmm9, %xmm4            /* r2 <= 0 : 1/r = 0, donc aucune contribution */
+    movaps  %xmm4, %xmm5
+    mul\S   %xmm5, %xmm5            /* 1/r² */
+    \LD     (%rax,%rsi,4), %xmm3
+    mul\S   AJ_K(%rsp), %xmm3
+    mul\S   %xmm4, %xmm3
+    mul\S   %xmm5, %xmm3            /* km3 = k m / r³ */
+    \LD     (%r11,%rsi,4), %xmm6
+    sub\S   AJ_PVX(%rsp), %xmm6
+    mul\S   AJ_VS(%rsp), %xmm6      /* dvx */
+    \LD     (%rcx,%rsi,4), %xmm7
+    sub\S   AJ_PVY(%rsp), %xmm7
+    mul\S   AJ_VS(%rsp), %xmm7      /* dvy */
+    \LD     (%rdx,%rsi,4), %xmm8
+    sub\S   AJ_PVZ(%rsp), %xmm8
+    mul\S   AJ_VS(%rsp), %xmm8      /* dvz */
+    movaps  %xmm0, %xmm4
+    mul\S   %xmm6, %xmm4
+    movaps  %xmm1, %xmm9
+    mul\S   %xmm7, %xmm9
+    add\S   %xmm9, %xmm4
+    movaps  %xmm2, %xmm9
+    mul\S   %xmm8, %xmm9
+    add\S   %xmm9, %xmm4
+    mul\S   AJ_THREE(%rsp), %xmm4
+    mul\S   %xmm5, %xmm4            /* rv3 = 3 (d·dv) / r² */
+    movaps  %xmm3, %xmm9
+    mul\S   %xmm0, %xmm9
+    add\S   %xmm9, %xmm10           /* ax */
+    movaps  %xmm3, %xmm9
+    mul\S   %xmm1, %xmm9
+    add\S   %xmm9, %xmm11           /* ay */
+    movaps  %xmm3, %xmm9
+    mul\S   %xmm2, %xmm9
+    add\S   %xmm9, %xmm12           /* az */
+    mul\S   %xmm4, %xmm0
+    sub\S   %xmm0, %xmm6
+    mul\S   %xmm3, %xmm6
+    add\S   %xmm6, %xmm13           /* jx */
+    mul\S   %xmm4, %xmm1
+    sub\S   %xmm1, %xmm7
+    mul\S   %xmm3, %xmm7
+    add\S   %xmm7, %xmm14           /* jy */
+    mul\S   %xmm4, %xmm2
+    sub\S   %xmm2, %xmm8
+    mul\S   %xmm3, %xmm8
+    add\S   %xmm8, %xmm15           /* jz */
+.endm
+
+/* Somme des 4 voies de \r dans sa voie 0 (xmm0 en temporaire) */
+.macro HSUM_SSE r
+    movaps  \r, %xmm0
+    movhlps \r, %xmm0
+    addps   %xmm0, \r
+    movaps  \r, %xmm0
+    shufps  $0x55, %xmm0, %xmm0
+    addss   %xmm0, \r
+.endm
+
+    .globl batch_accel_jerk_sse
+    .type batch_accel_jerk_sse, @function
+batch_accel_jerk_sse:
+    AJ_PROLOGUE BCAST_SSE, 4
+    xorps   %xmm10, %xmm10
+    xorps   %xmm11, %xmm11
+    xorps   %xmm12, %xmm12
+    xorps   %xmm13, %xmm13
+    xorps   %xmm14, %xmm14
+    xorps   %xmm15, %xmm15
+.Laj_sse_loop:
+    cmpq    %rdi, %rsi
+    jae     .Laj_sse_reduce
+    AJ_SSE  ps, movups
+    addq    $4, %rsi
+    jmp     .Laj_sse_loop
+.Laj_sse_reduce:
+    HSUM_SSE %xmm10
+    HSUM_SSE %xmm11
+    HSUM_SSE %xmm12
+    HSUM_SSE %xmm13
+    HSUM_SSE %xmm14
+    HSUM_SSE %xmm15
+    movq    AJ_N(%rsp), %rdi
+.Laj_sse_tail:
+    cmpq    %rdi, %rsi
+    jae     .Laj_sse_store
+    AJ_SSE  ss, movss
+    incq    %rsi
+    jmp     .Laj_sse_tail
+.Laj_sse_store:
+    movq    AJ_OUT(%rsp), %rax
+    movss   %xmm10, 0(%rax)
+    movss   %xmm11, 4(%rax)
+    movss   %xmm12, 8(%rax)
+    movss   %xmm13, 12(%rax)
+    movss   %xmm14, 16(%rax)
+    movss   %xmm15, 20(%rax)
+    movq    %rbp, %rsp
+    popq    %rbp
+    ret
+    .size batch_accel_jerk_sse, .-batch_accel_jerk_sse
+
+/* Un pas, AVX2 + FMA (R = ymm ou xmm, S = ps ou ss, LD = vmovups ou vmovss) */
+.macro AJ_AVX R, S, LD
+    \LD     (%r8,%rsi,4), %\R\()0
+    vsub\S  AJ_PX(%rsp), %\R\()0, %\R\()0
+    \LD     (%r9,%rsi,4), %\R\()1
+    vsub\S  AJ_PY(%rsp), %\R\()1, %\R\()1
+    \LD     (%r10,%rsi,4), %\R\()2
+    vsub\S  AJ_PZ(%rsp), %\R\()2, %\R\()2
+    vmul\S  %\R\()0, %\R\()0, %\R\()3
+    vfmadd231\S %\R\()1, %\R\()1, %\R\()3
+    vfmadd231\S %\R\()2, %\R\()2, %\R\()3
+    vadd\S  AJ_EPS(%rsp), %\R\()3, %\R\()3
+    vxorps  %\R\()9, %\R\()9, %\R\()9
+    vcmplt\S %\R\()3, %\R\()9, %\R\()9
+    .ifc \S,ss
+    vsqrtss %xmm3, %xmm3, %xmm3
+    .else
+    vsqrtps %\R\()3, %\R\()3
+    .endif
+    vmovaps AJ_ONE(%rsp), %\R\()4
+    vdiv\S  %\R\()3, %\R\()4, %\R\()4
+    vandps  %\R\()9, %\R\()4, %\R\()4
+    vmul\S  %\R\()4, %\R\()4, %\R\()5
+    \LD     (%rax,%rsi,4), %\R\()3
+    vmul\S  AJ_K(%rsp), %\R\()3, %\R\()3
+    vmul\S  %\R\()4, %\R\()3, %\R\()3
+    vmul\S  %\R\()5, %\R\()3, %\R\()3
+    \LD     (%r11,%rsi,4), %\R\()6
+    vsub\S  AJ_PVX(%rsp), %\R\()6, %\R\()6
+    vmul\S  AJ_VS(%rsp), %\R\()6, %\R\()6
+    \LD     (%rcx,%rsi,4), %\R\()7
+    vsub\S  AJ_PVY(%rsp), %\R\()7, %\R\()7
+    vmul\S  AJ_VS(%rsp), %\R\()7, %\R\()7
+    \LD     (%rdx,%rsi,4), %\R\()8
+    vsub\S  AJ_PVZ(%rsp), %\R\()8, %\R\()8
+    vmul\S  AJ_VS(%rsp), %\R\()8, %\R\()8
+    vmul\S  %\R\()6, %\R\()0, %\R\()4
+    vfmadd231\S %\R\()7, %\R\()1, %\R\()4
+    vfmadd231\S %\R\()8, %\R\()2, %\R\()4
+    vmul\S  AJ_THREE(%rsp), %\R\()4, %\R\()4
+    vmul\S  %\R\()5, %\R\()4, %\R\()4
+    vfmadd231\S %\R\()0, %\R\()3, %\R\()10
+    vfmadd231\S %\R\()1, %\R\()3, %\R\()11
+    vfmadd231\S %\R\()2, %\R\()3, %\R\()12
+    vfnmadd231\S %\R\()4, %\R\()0, %\R\()6
+    vfnmadd231\S %\R\()4, %\R\()1, %\R\()7
+    vfnmadd231\S %\R\()4, %\R\()2, %\R\()8
+    vfmadd231\S %\R\()6, %\R\()3, %\R\()13
+    vfmadd231\S %\R\()7, %\R\()3, %\R\()14
+    vfmadd231\S %\R\()8, %\R\()3, %\R\()15
+.endm
+
+/* Somme des 8 voies de ymm\n dans la voie 0 de xmm\n (xmm0 en temporaire) */
+.macro HSUM_AVX n
+    vextractf128 $1, %ymm\n, %xmm0
+    vaddps  %xmm0, %xmm\n, %xmm\n
+    vmovhlps %xmm\n, %xmm\n, %xmm0
+    vaddps  %xmm0, %xmm\n, %xmm\n
+    vmovshdup %xmm\n, %xmm0
+    vaddss  %xmm0, %xmm\n, %xmm\n
+.endm
+
+    .globl batch_accel_jerk_avx2
+    .type batch_accel_jerk_avx2, @function
+batch_accel_jerk_avx2:
+    AJ_PROLOGUE BCAST_AVX, 8
+    vxorps  %ymm10, %ymm10, %ymm10
+    vxorps  %ymm11, %ymm11, %ymm11
+    vxorps  %ymm12, %ymm12, %ymm12
+    vxorps  %ymm13, %ymm13, %ymm13
+    vxorps  %ymm14, %ymm14, %ymm14
+    vxorps  %ymm15, %ymm15, %ymm15
+.Laj_avx2_loop:
+    cmpq    %rdi, %rsi
+    jae     .Laj_avx2_reduce
+    AJ_AVX  ymm, ps, vmovups
+    addq    $8, %rsi
+    jmp     .Laj_avx2_loop
+.Laj_avx2_reduce:
+    HSUM_AVX 10
+    HSUM_AVX 11
+    HSUM_AVX 12
+    HSUM_AVX 13
+    HSUM_AVX 14
+    HSUM_AVX 15
+    movq    AJ_N(%rsp), %rdi
+.Laj_avx2_tail:
+    cmpq    %rdi, %rsi
+    jae     .Laj_avx2_store
+    AJ_AVX  xmm, ss, vmovss
+    incq    %rsi
+    jmp     .Laj_avx2_tail
+.Laj_avx2_store:
+    movq    AJ_OUT(%rsp), %rax
+    vmovss  %xmm10, 0(%rax)
+    vmovss  %xmm11, 4(%rax)
+    vmovss  %xmm12, 8(%rax)
+    vmovss  %xmm13, 12(%rax)
+    vmovss  %xmm14, 16(%rax)
+    vmovss  %xmm15, 20(%rax)
+    movq    %rbp, %rsp
+    popq    %rbp
+    vzeroupper
+    ret
+    .size batch_accel_jerk_avx2, .-batch_accel_jerk_avx2
+
+/* AVX-512 : 32 registres zmm, les constantes restent en registres (zmm16-26, zmm27 = 0),
+ * plus de queue scalaire : la dernière itération charge sous masque k1 (voies hors
+ * tableau = 0) et k2 = k1 & (r2 > 0) annule leur 1/r. */
+    .globl batch_accel_jerk_avx512
+    .type batch_accel_jerk_avx512, @function
+batch_accel_jerk_avx512:
+    pushq   %rbx
+    pushq   %rsi                    /* out */
+    vbroadcastss 64(%rdi), %zmm16   /* px */
+    vbroadcastss 68(%rdi), %zmm17   /* py */
+    vbroadcastss 72(%rdi), %zmm18   /* pz */
+    vbroadcastss 76(%rdi), %zmm19   /* pvx */
+    vbroadcastss 80(%rdi), %zmm20   /* pvy */
+    vbroadcastss 84(%rdi), %zmm21   /* pvz */
+    vbroadcastss 88(%rdi), %zmm22   /* k */
+    vbroadcastss 92(%rdi), %zmm23   /* eps2 */
+    vbroadcastss 96(%rdi), %zmm24   /* velScale */
+    vbroadcastss .Lthree(%rip), %zmm25
+    vbroadcastss .Lone(%rip), %zmm26
+    vpxord  %zmm27, %zmm27, %zmm27
+    movq    0(%rdi), %r8
+    movq    8(%rdi), %r9
+    movq    16(%rdi), %r10
+    movq    24(%rdi), %r11
+    movq    32(%rdi), %rcx
+    movq    40(%rdi), %rdx
+    movq    48(%rdi), %rax
+    movq    56(%rdi), %rdi          /* n */
+    xorl    %esi, %esi
+    vpxord  %zmm10, %zmm10, %zmm10
+    vpxord  %zmm11, %zmm11, %zmm11
+    vpxord  %zmm12, %zmm12, %zmm12
+    vpxord  %zmm13, %zmm13, %zmm13
+    vpxord  %zmm14, %zmm14, %zmm14
+    vpxord  %zmm15, %zmm15, %zmm15
+.Laj_512_loop:
+    movq    %rdi, %rbx
+    subq    %rsi, %rbx
+    jbe     .Laj_512_reduce
+    kxnorw  %k1, %k1, %k1
+    cmpq    $16, %rbx
+    jae     .Laj_512_step
+    bzhil   %ebx, .Lall_ones(%rip), %ebx
+    kmovw   %ebx, %k1
+.Laj_512_step:
+    vmovups (%r8,%rsi,4), %zmm0{%k1}{z}
+    vsubps  %zmm16, %zmm0, %zmm0
+    vmovups (%r9,%rsi,4), %zmm1{%k1}{z}
+    vsubps  %zmm17, %zmm1, %zmm1
+    vmovups (%r10,%rsi,4), %zmm2{%k1}{z}
+    vsubps  %zmm18, %zmm2, %zmm2
+    vmulps  %zmm0, %zmm0, %zmm3
+    vfmadd231ps %zmm1, %zmm1, %zmm3
+    vfmadd231ps %zmm2, %zmm2, %zmm3
+    vaddps  %zmm23, %zmm3, %zmm3
+    vcmpltps %zmm3, %zmm27, %k2{%k1}
+    vsqrtps %zmm3, %zmm3
+    vdivps  %zmm3, %zmm26, %zmm4{%k2}{z}
+    vmulps  %zmm4, %zmm4, %zmm5
+    vmovups (%rax,%rsi,4), %zmm3{%k1}{z}
+    vmulps  %zmm22, %zmm3, %zmm3
+    vmulps  %zmm4, %zmm3, %zmm3
+    vmulps  %zmm5, %zmm3, %zmm3
+    vmovups (%r11,%rsi,4), %zmm6{%k1}{z}
+    vsubps  %zmm19, %zmm6, %zmm6
+    vmulps  %zmm24, %zmm6, %zmm6
+    vmovups (%rcx,%rsi,4), %zmm7{%k1}{z}
+    vsubps  %zmm20, %zmm7, %zmm7
+    vmulps  %zmm24, %zmm7, %zmm7
+    vmovups (%rdx,%rsi,4), %zmm8{%k1}{z}
+    vsubps  %zmm21, %zmm8, %zmm8
+    vmulps  %zmm24, %zmm8, %zmm8
+    vmulps  %zmm6, %zmm0, %zmm4
+    vfmadd231ps %zmm7, %zmm1, %zmm4
+    vfmadd231ps %zmm8, %zmm2, %zmm4
+    vmulps  %zmm25, %zmm4, %zmm4
+    vmulps  %zmm5, %zmm4, %zmm4
+    vfmadd231ps %zmm0, %zmm3, %zmm10
+    vfmadd231ps %zmm1, %zmm3, %zmm11
+    vfmadd231ps %zmm2, %zmm3, %zmm12
+    vfnmadd231ps %zmm4, %zmm0, %zmm6
+    vfnmadd231ps %zmm4, %zmm1, %zmm7
+    vfnmadd231ps %zmm4, %zmm2, %zmm8
+    vfmadd231ps %zmm6, %zmm3, %zmm13
+    vfmadd231ps %zmm7, %zmm3, %zmm14
+    vfmadd231ps %zmm8, %zmm3, %zmm15
+    addq    $16, %rsi
+    jmp     .Laj_512_loop
+.Laj_512_reduce:
+    .irp n, 10, 11, 12, 13, 14, 15
+    vextractf64x4 $1, %zmm\n, %ymm0
+    vaddps  %ymm0, %ymm\n, %ymm\n
+    HSUM_AVX \n
+    .endr
+    popq    %rax                    /* out */
+    vmovss  %xmm10, 0(%rax)
+    vmovss  %xmm11, 4(%rax)
+    vmovss  %xmm12, 8(%rax)
+    vmovss  %xmm13, 12(%rax)
+    vmovss  %xmm14, 16(%rax)
+    vmovss  %xmm15, 20(%rax)
+    popq    %rbx
+    vzeroupper
+    ret
+    .size batch_accel_jerk_avx512, .-batch_accel_jerk_avx512
+
+
+/* ============================================================================
+ * batch_normalize3_{sse,avx2,avx512}
+ * Normalise n vecteurs SoA sur place ; les vecteurs nuls restent nuls
+ * (diviseur remplacé par 1 au lieu d'un branchement).
+ *
+ * Paramètres:
+ *   %rdi = x, %rsi = y, %rdx = z
+ *   %rcx = n
+ * ============================================================================
+ */
+
+.macro NORM_SSE S, LD
+    \LD     (%rdi,%rax,4), %xmm0
+    \LD     (%rsi,%rax,4), %xmm1
+    \LD     (%rdx,%rax,4), %xmm2
+    movaps  %xmm0, %xmm3
+    mul\S   %xmm3, %xmm3
+    movaps  %xmm1, %xmm4
+    mul\S   %xmm4, %xmm4
+    add\S   %xmm4, %xmm3
+    movaps  %xmm2, %xmm4
+    mul\S   %xmm4, %xmm4
+    add\S   %xmm4, %xmm3
+    sqrt\S  %xmm3, %xmm3            /* longueur */
+    xorps   %xmm4, %xmm4
+    cmpeq\S %xmm3, %xmm4            /* xmm4 = (longueur == 0) */
+    movaps  %xmm4, %xmm5
+    andps   %xmm7, %xmm5            /* 1.0 là où c'est nul */
+    andnps  %xmm3, %xmm4            /* longueur ailleurs */
+    orps    %xmm5, %xmm4            /* diviseur */
+    div\S   %xmm4, %xmm0
+    div\S   %xmm4, %xmm1
+    div\S   %xmm4, %xmm2
+    \LD     %xmm0, (%rdi,%rax,4)
+    \LD     %xmm1, (%rsi,%rax,4)
+    \LD     %xmm2, (%rdx,%rax,4)
+.endm
+
+    .globl batch_normalize3_sse
+    .type batch_normalize3_sse, @function
+batch_normalize3_sse:
+    movss   .Lone(%rip), %xmm7
+    shufps  $0, %xmm7, %xmm7
+    xorl    %eax, %eax
+    movq    %rcx, %r9
+    andq    $-4, %r9
+.Lnm_sse_loop:
+    cmpq    %r9, %rax
+    jae     .Lnm_sse_tail
+    NORM_SSE ps, movups
+    addq    $4, %rax
+    jmp     .Lnm_sse_loop
+.Lnm_sse_tail:
+    cmpq    %rcx, %rax
+    jae     .Lnm_sse_done
+    NORM_SSE ss, movss
+    incq    %rax
+    jmp     .Lnm_sse_tail
+.Lnm_sse_done:
+    ret
+    .size batch_normalize3_sse, .-batch_normalize3_sse
+
+.macro NORM_AVX R, S, LD
+    \LD     (%rdi,%rax,4), %\R\()0
+    \LD     (%rsi,%rax,4), %\R\()1
+    \LD     (%rdx,%rax,4), %\R\()2
+    vmul\S  %\R\()0, %\R\()0, %\R\()3
+    vfmadd231\S %\R\()1, %\R\()1, %\R\()3
+    vfmadd231\S %\R\()2, %\R\()2, %\R\()3
+    .ifc \S,ss
+    vsqrtss %xmm3, %xmm3, %xmm3
+    .else
+    vsqrtps %\R\()3, %\R\()3
+    .endif
+    vxorps  %\R\()4, %\R\()4, %\R\()4
+    vcmpeq\S %\R\()4, %\R\()3, %\R\()4
+    vblendvps %\R\()4, %\R\()7, %\R\()3, %\R\()3   /* 1.0 si longueur nulle */
+    vdiv\S  %\R\()3, %\R\()0, %\R\()0
+    vdiv\S  %\R\()3, %\R\()1, %\R\()1
+    vdiv\S  %\R\()3, %\R\()2, %\R\()2
+    \LD     %\R\()0, (%rdi,%rax,4)
+    \LD     %\R\()1, (%rsi,%rax,4)
+    \LD     %\R\()2, (%rdx,%rax,4)
+.endm
+
+    .globl batch_normalize3_avx2
+    .type batch_normalize3_avx2, @function
+batch_normalize3_avx2:
+    vbroadcastss .Lone(%rip), %ymm7
+    xorl    %eax, %eax
+    movq    %rcx, %r9
+    andq    $-8, %r9
+.Lnm_avx2_loop:
+    cmpq    %r9, %rax
+    jae     .Lnm_avx2_tail
+    NORM_AVX ymm, ps, vmovups
+    addq    $8, %rax
+    jmp     .Lnm_avx2_loop
+.Lnm_avx2_tail:
+    cmpq    %rcx, %rax
+    jae     .Lnm_avx2_done
+    NORM_AVX xmm, ss, vmovss
+    incq    %rax
+    jmp     .Lnm_avx2_tail
+.Lnm_avx2_done:
+    vzeroupper
+    ret
+    .size batch_normalize3_avx2, .-batch_normalize3_avx2
+
+    .globl batch_normalize3_avx512
+    .type batch_normalize3_avx512, @function
+batch_normalize3_avx512:
+    vbroadcastss .Lone(%rip), %zmm7
+    vpxord  %zmm6, %zmm6, %zmm6
+    xorl    %eax, %eax
+.Lnm_512_loop:
+    movq    %rcx, %r9
+    subq    %rax, %r9
+    jbe     .Lnm_512_done
+    kxnorw  %k1, %k1, %k1
+    cmpq    $16, %r9
+    jae     .Lnm_512_step
+    bzhil   %r9d, .Lall_ones(%rip), %r9d
+    kmovw   %r9d, %k1
+.Lnm_512_step:
+    vmovups (%rdi,%rax,4), %zmm0{%k1}{z}
+    vmovups (%rsi,%rax,4), %zmm1{%k1}{z}
+    vmovups (%rdx,%rax,4), %zmm2{%k1}{z}
+    vmulps  %zmm0, %zmm0, %zmm3
+    vfmadd231ps %zmm1, %zmm1, %zmm3
+    vfmadd231ps %zmm2, %zmm2, %zmm3
+    vsqrtps %zmm3, %zmm3
+    vcmpeqps %zmm6, %zmm3, %k2
+    vmovaps %zmm7, %zmm3{%k2}       /* 1.0 si longueur nulle */
+    vdivps  %zmm3, %zmm0, %zmm0
+    vdivps  %zmm3, %zmm1, %zmm1
+    vdivps  %zmm3, %zmm2, %zmm2
+    vmovups %zmm0, (%rdi,%rax,4){%k1}
+    vmovups %zmm1, (%rsi,%rax,4){%k1}
+    vmovups %zmm2, (%rdx,%rax,4){%k1}
+    addq    $16, %rax
+    jmp     .Lnm_512_loop
+.Lnm_512_done:
+    vzeroupper
+    ret
+    .size batch_normalize3_avx512, .-batch_normalize3_avx512
+
+
+/* ============================================================================
+ * batch_axpy_{sse,avx2,avx512}
+ * y[i] += a * x[i]   (FMA en AVX2 / AVX-512 : un arrondi de moins qu'en SSE)
+ *
+ * Paramètres:
+ *   %xmm0 = a
+ *   %rdi = x, %rsi = y
+ *   %rdx = n
+ * ============================================================================
+ */
+
+.macro AXPY_SSE S, LD
+    \LD     (%rdi,%rax,4), %xmm1
+    mul\S   %xmm0, %xmm1
+    \LD     (%rsi,%rax,4), %xmm2
+    add\S   %xmm1, %xmm2
+    \LD     %xmm2, (%rsi,%rax,4)
+.endm
+
+    .globl batch_axpy_sse
+    .type batch_axpy_sse, @function
+batch_axpy_sse:
+    shufps  $0, %xmm0, %xmm0
+    xorl    %eax, %eax
+    movq    %rdx, %r9
+    andq    $-4, %r9
+.Lax_sse_loop:
+    cmpq    %r9, %rax
+    jae     .Lax_sse_tail
+    AXPY_SSE ps, movups
+    addq    $4, %rax
+    jmp     .Lax_sse_loop
+.Lax_sse_tail:
+    cmpq    %rdx, %rax
+    jae     .Lax_sse_done
+    AXPY_SSE ss, movss
+    incq    %rax
+    jmp     .Lax_sse_tail
+.Lax_sse_done:
+    ret
+    .size batch_axpy_sse, .-batch_axpy_sse
+
+.macro AXPY_AVX R, S, LD
+    \LD     (%rsi,%rax,4), %\R\()2
+    \LD     (%rdi,%rax,4), %\R\()1
+    vfmadd231\S %\R\()1, %\R\()0, %\R\()2
+    \LD     %\R\()2, (%rsi,%rax,4)
+.endm
+
+    .globl batch_axpy_avx2
+    .type batch_axpy_avx2, @function
+batch_axpy_avx2:
+    vbroadcastss %xmm0, %ymm0
+    xorl    %eax, %eax
+    movq    %rdx, %r9
+    andq    $-8, %r9
+.Lax_avx2_loop:
+    cmpq    %r9, %rax
+    jae     .Lax_avx2_tail
+    AXPY_AVX ymm, ps, vmovups
+    addq    $8, %rax
+    jmp     .Lax_avx2_loop
+.Lax_avx2_tail:
+    cmpq    %rdx, %rax
+    jae     .Lax_avx2_done
+    AXPY_AVX xmm, ss, vmovss
+    incq    %rax
+    jmp     .Lax_avx2_tail
+.Lax_avx2_done:
+    vzeroupper
+    ret
+    .size batch_axpy_avx2, .-batch_axpy_avx2
+
+    .globl batch_axpy_avx512
+    .type batch_axpy_avx512, @function
+batch_axpy_avx512:
+    vbroadcastss %xmm0, %zmm0
+    xorl    %eax, %eax
+.Lax_512_loop:
+    movq    %rdx, %r9
+    subq    %rax, %r9
+    jbe     .Lax_512_done
+    kxnorw  %k1, %k1, %k1
+    cmpq    $16, %r9
+    jae     .Lax_512_step
+    bzhil   %r9d, .Lall_ones(%rip), %r9d
+    kmovw   %r9d, %k1
+.Lax_512_step:
+    vmovups (%rsi,%rax,4), %zmm2{%k1}{z}
+    vmovups (%rdi,%rax,4), %zmm1{%k1}{z}
+    vfmadd231ps %zmm1, %zmm0, %zmm2
+    vmovups %zmm2, (%rsi,%rax,4){%k1}
+    addq    $16, %rax
+    jmp     .Lax_512_loop
+.Lax_512_done:
+    vzeroupper
+    ret
+    .size batch_axpy_avx512, .-batch_axpy_avx512
+
+
+/* ============================================================================
+ * Section de données - constantes
+ * ============================================================================
+ */
+    .section .rodata
+    .align 4
+.Lone:
+    .float 1.0
+.Lthree:
+    .float 3.0
+.Lall_ones:
+    .long 0xFFFFFFFF
+
+    .section .note.GNU-stack,"",@progbits
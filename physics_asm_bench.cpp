@@ -0,0 +1,567 @@
+#include "physics_asm.hpp"
+#include "cpu_tracer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+
+// Suite de micro-benchmarks pour PhysicsASM.
+//
+// Contrairement à `PhysicsASM_Demo --benchmark` (un million d'appels sur des constantes), chaque noyau
+// tableau tourne ici sur de vrais tableaux SoA de 1K à 16M éléments, en cache comme en flux mémoire,
+// et chaque mesure est répétée : on rapporte la médiane et l'écart absolu médian (MAD).
+//
+// Variantes comparées pour chaque noyau tableau :
+//   asm-<ISA>     les noyaux de physics_asm_batch.s / _arm64.S (tous les jeux d'instructions supportés),
+//                 ou hdr-intrin (en-tête) si le projet est configuré avec PHYSICS_BACKEND=intrinsics
+//   cpp           boucle C++ scalaire, vectorisation automatique désactivée
+//   cpp-autovec   la même boucle, vectorisation automatique du compilateur permise (les réductions
+//                 flottantes d'accel_jerk restent scalaires : il faudrait -ffast-math pour les réordonner)
+//   intrin-<ISA>  intrinsèques SSE (x86-64) ou NEON (ARM64) sur 4 voies
+// Plus une section latence : les fonctions scalaires enchaînées (chaque résultat alimente l'appel suivant),
+// et, sur demande, une section trace : une image du traceur CPU par variante du noyau par pixel.
+
+// ─── Barrières d'optimisation ────────────────────────────────────────────────
+// Empêche le compilateur de fusionner ou de supprimer des appels répétés
+static inline void ClobberMemory() { asm volatile("" ::: "memory"); }
+// Le compilateur doit considérer la valeur comme lue : le calcul qui la produit reste
+template <typename T>
+static inline void DoNotOptimize(const T& value) { asm volatile("" : : "r,m"(value) : "memory"); }
+
+#define BENCH_NOINLINE __attribute__((noinline))
+#if defined(__clang__)
+#define BENCH_NOVEC_FN
+#define BENCH_NOVEC_LOOP _Pragma("clang loop vectorize(disable) interleave(disable)")
+#else
+#define BENCH_NOVEC_FN   __attribute__((optimize("no-tree-vectorize")))
+#define BENCH_NOVEC_LOOP
+#endif
+
+// ─── Variantes C++ ───────────────────────────────────────────────────────────
+// Un seul corps de boucle, estampillé deux fois : scalaire (cpp) et auto-vectorisable (cpp-autovec).
+// Mêmes opérations que l'assembleur : r² + eps² masqué s'il est nul, longueur nulle laissée telle quelle.
+#define BENCH_CPP_KERNELS(suffix, FN_ATTR, LOOP_ATTR)                                                   \
+    FN_ATTR BENCH_NOINLINE static void distance_squared_##suffix(                                     \
+            const float* __restrict x, const float* __restrict y, const float* __restrict z,          \
+            float px, float py, float pz, float* __restrict out, size_t n) {                          \
+        LOOP_ATTR                                                                                     \
+        for (size_t i = 0; i < n; ++i) {                                                              \
+            float dx = x[i] - px, dy = y[i] - py, dz = z[i] - pz;                                     \
+            out[i] = dx * dx + dy * dy + dz * dz;                                                     \
+        }                                                                                             \
+    }                                                                                                 \
+    FN_ATTR BENCH_NOINLINE static void accel_jerk_##suffix(const PhysicsForceBatch* b, float* out6) { \
+        const float *x = b->x, *y = b->y, *z = b->z, *vx = b->vx, *vy = b->vy, *vz = b->vz;           \
+        const float *m = b->mass;                                                                     \
+        const float px = b->px, py = b->py, pz = b->pz, pvx = b->pvx, pvy = b->pvy, pvz = b->pvz;     \
+        const float k = b->k, eps2 = b->eps2, vs = b->velScale;                                       \
+        float ax = 0, ay = 0, az = 0, jx = 0, jy = 0, jz = 0;                                         \
+        LOOP_ATTR                                                                                     \
+        for (size_t j = 0; j < b->count; ++j) {                                                       \
+            float dx = x[j] - px, dy = y[j] - py, dz = z[j] - pz;                                     \
+            float r2 = dx * dx + dy * dy + dz * dz + eps2;                                            \
+            float invR = r2 > 0.0f ? 1.0f / std::sqrt(r2) : 0.0f;                                     \
+            float invR2 = invR * invR;                                                                \
+            float km3 = k * m[j] * invR * invR2;                                                      \
+            float dvx = (vx[j] - pvx) * vs, dvy = (vy[j] - pvy) * vs, dvz = (vz[j] - pvz) * vs;       \
+            float rv3 = 3.0f * (dx * dvx + dy * dvy + dz * dvz) * invR2;                              \
+            ax += km3 * dx;  ay += km3 * dy;  az += km3 * dz;                                         \
+            jx += km3 * (dvx - rv3 * dx);  jy += km3 * (dvy - rv3 * dy);  jz += km3 * (dvz - rv3 * dz); \
+        }                                                                                             \
+        out6[0] = ax; out6[1] = ay; out6[2] = az; out6[3] = jx; out6[4] = jy; out6[5] = jz;           \
+    }                                                                                                 \
+    FN_ATTR BENCH_NOINLINE static void normalize3_##suffix(                                           \
+            float* __restrict x, float* __restrict y, float* __restrict z, size_t n) {                \
+        LOOP_ATTR                                                                                     \
+        for (size_t i = 0; i < n; ++i) {                                                              \
+            float len = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);                           \
+            len = len > 0.0f ? len : 1.0f;                                                            \
+            x[i] /= len;  y[i] /= len;  z[i] /= len;                                                  \
+        }                                                                                             \
+    }                                                                                                 \
+    FN_ATTR BENCH_NOINLINE static void axpy_##suffix(float a, const float* __restrict x,              \
+                                                     float* __restrict y, size_t n) {                 \
+        LOOP_ATTR                                                                                     \
+        for (size_t i = 0; i < n; ++i) y[i] += a * x[i];                                              \
+    }
+
+BENCH_CPP_KERNELS(scalar, BENCH_NOVEC_FN, BENCH_NOVEC_LOOP)
+BENCH_CPP_KERNELS(autovec, , )
+#undef BENCH_CPP_KERNELS
+
+// ─── Variante intrinsèques (4 voies) ─────────────────────────────────────────
+// Petite couche commune SSE / NEON, pour écrire chaque noyau une seule fois
+namespace Simd4 {
+#if defined(__x86_64__) || defined(_M_X64)
+    static const char* const Name = "intrin-SSE";
+    using V = __m128;
+    inline V    Load(const float* p)       { return _mm_loadu_ps(p); }
+    inline void Store(float* p, V v)       { _mm_storeu_ps(p, v); }
+    inline V    Set1(float s)              { return _mm_set1_ps(s); }
+    inline V    Add(V a, V b)              { return _mm_add_ps(a, b); }
+    inline V    Sub(V a, V b)              { return _mm_sub_ps(a, b); }
+    inline V    Mul(V a, V b)              { return _mm_mul_ps(a, b); }
+    inline V    Div(V a, V b)              { return _mm_div_ps(a, b); }
+    inline V    Sqrt(V a)                  { return _mm_sqrt_ps(a); }
+    inline V    IfPositive(V c, V a, V b)  {                     // c > 0 ? a : b
+        V m = _mm_cmpgt_ps(c, _mm_setzero_ps());
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+#else
+    static const char* const Name = "intrin-NEON";
+    using V = float32x4_t;
+    inline V    Load(const float* p)       { return vld1q_f32(p); }
+    inline void Store(float* p, V v)       { vst1q_f32(p, v); }
+    inline V    Set1(float s)              { return vdupq_n_f32(s); }
+    inline V    Add(V a, V b)              { return vaddq_f32(a, b); }
+    inline V    Sub(V a, V b)              { return vsubq_f32(a, b); }
+    inline V    Mul(V a, V b)              { return vmulq_f32(a, b); }
+    inline V    Div(V a, V b)              { return vdivq_f32(a, b); }
+    inline V    Sqrt(V a)                  { return vsqrtq_f32(a); }
+    inline V    IfPositive(V c, V a, V b)  { return vbslq_f32(vcgtq_f32(c, vdupq_n_f32(0.0f)), a, b); }
+#endif
+    // Somme des voies dans un ordre fixe : (0 + 1) + (2 + 3)
+    inline float HSum(V v) {
+        alignas(16) float l[4];
+        Store(l, v);
+        return (l[0] + l[1]) + (l[2] + l[3]);
+    }
+}
+
+BENCH_NOINLINE static void distance_squared_intrin(const float* x, const float* y, const float* z,
+                                                   float px, float py, float pz, float* out, size_t n) {
+    using namespace Simd4;
+    const V vpx = Set1(px), vpy = Set1(py), vpz = Set1(pz);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        V dx = Sub(Load(x + i), vpx), dy = Sub(Load(y + i), vpy), dz = Sub(Load(z + i), vpz);
+        Store(out + i, Add(Add(Mul(dx, dx), Mul(dy, dy)), Mul(dz, dz)));
+    }
+    distance_squared_scalar(x + i, y + i, z + i, px, py, pz, out + i, n - i);
+}
+
+BENCH_NOINLINE static void accel_jerk_intrin(const PhysicsForceBatch* b, float* out6) {
+    using namespace Simd4;
+    const V px = Set1(b->px), py = Set1(b->py), pz = Set1(b->pz);
+    const V pvx = Set1(b->pvx), pvy = Set1(b->pvy), pvz = Set1(b->pvz);
+    const V k = Set1(b->k), eps2 = Set1(b->eps2), vs = Set1(b->velScale);
+    const V one = Set1(1.0f), three = Set1(3.0f), zero = Set1(0.0f);
+    V ax = zero, ay = zero, az = zero, jx = zero, jy = zero, jz = zero;
+    size_t j = 0;
+    for (; j + 4 <= b->count; j += 4) {
+        V dx = Sub(Load(b->x + j), px), dy = Sub(Load(b->y + j), py), dz = Sub(Load(b->z + j), pz);
+        V r2 = Add(Add(Add(Mul(dx, dx), Mul(dy, dy)), Mul(dz, dz)), eps2);
+        V invR = IfPositive(r2, Div(one, Sqrt(r2)), zero);
+        V invR2 = Mul(invR, invR);
+        V km3 = Mul(Mul(Mul(k, Load(b->mass + j)), invR), invR2);
+        V dvx = Mul(Sub(Load(b->vx + j), pvx), vs);
+        V dvy = Mul(Sub(Load(b->vy + j), pvy), vs);
+        V dvz = Mul(Sub(Load(b->vz + j), pvz), vs);
+        V rv3 = Mul(Mul(three, Add(Add(Mul(dx, dvx), Mul(dy, dvy)), Mul(dz, dvz))), invR2);
+        ax = Add(ax, Mul(km3, dx));  ay = Add(ay, Mul(km3, dy));  az = Add(az, Mul(km3, dz));
+        jx = Add(jx, Mul(km3, Sub(dvx, Mul(rv3, dx))));
+        jy = Add(jy, Mul(km3, Sub(dvy, Mul(rv3, dy))));
+        jz = Add(jz, Mul(km3, Sub(dvz, Mul(rv3, dz))));
+    }
+    // Queue scalaire sur les sources restantes, ajoutée aux sommes des voies
+    PhysicsForceBatch tail = *b;
+    tail.x += j; tail.y += j; tail.z += j; tail.vx += j; tail.vy += j; tail.vz += j; tail.mass += j;
+    tail.count = b->count - j;
+    accel_jerk_scalar(&tail, out6);
+    const V sums[6] = { ax, ay, az, jx, jy, jz };
+    for (int c = 0; c < 6; ++c) out6[c] += HSum(sums[c]);
+}
+
+BENCH_NOINLINE static void normalize3_intrin(float* x, float* y, float* z, size_t n) {
+    using namespace Simd4;
+    const V one = Set1(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        V vx = Load(x + i), vy = Load(y + i), vz = Load(z + i);
+        V len = Sqrt(Add(Add(Mul(vx, vx), Mul(vy, vy)), Mul(vz, vz)));
+        len = IfPositive(len, len, one);
+        Store(x + i, Div(vx, len));  Store(y + i, Div(vy, len));  Store(z + i, Div(vz, len));
+    }
+    normalize3_scalar(x + i, y + i, z + i, n - i);
+}
+
+BENCH_NOINLINE static void axpy_intrin(float a, const float* x, float* y, size_t n) {
+    using namespace Simd4;
+    const V va = Set1(a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) Store(y + i, Add(Load(y + i), Mul(va, Load(x + i))));
+    axpy_scalar(a, x + i, y + i, n - i);
+}
+
+// Toutes les variantes tableau, sous la même forme que PhysicsASM::BatchKernels
+static std::vector<PhysicsASM::BatchKernels> AllVariants() {
+#if defined(PHYSICS_ASM_INTRINSICS)
+    static const char* const asmNames[PhysicsASM::BATCH_ISA_COUNT] = { "hdr-intrin" };
+#elif defined(__x86_64__) || defined(_M_X64)
+    static const char* const asmNames[PhysicsASM::BATCH_ISA_COUNT] = { "asm-SSE", "asm-AVX2", "asm-AVX-512" };
+#else
+    static const char* const asmNames[PhysicsASM::BATCH_ISA_COUNT] = { "asm-NEON" };
+#endif
+    std::vector<PhysicsASM::BatchKernels> v;
+    for (int isa = 0; isa < PhysicsASM::BATCH_ISA_COUNT; ++isa)
+        if (PhysicsASM::BatchIsaSupported(PhysicsASM::BatchIsa(isa))) {
+            v.push_back(PhysicsASM::BatchKernelsFor(PhysicsASM::BatchIsa(isa)));
+            v.back().name = asmNames[isa];
+        }
+    v.push_back({ "cpp",         "cpp",         distance_squared_scalar,  accel_jerk_scalar,
+                                                normalize3_scalar,        axpy_scalar });
+    v.push_back({ "cpp-autovec", "cpp-autovec", distance_squared_autovec, accel_jerk_autovec,
+                                                normalize3_autovec,       axpy_autovec });
+    v.push_back({ Simd4::Name,   "intrin",      distance_squared_intrin,  accel_jerk_intrin,
+                                                normalize3_intrin,        axpy_intrin });
+    return v;
+}
+
+// ─── Variantes scalaires C++ pour la latence ─────────────────────────────────
+// Hors ligne, comme les fonctions assembleur : on compare des appels, pas du code inliné
+namespace Latency {
+    BENCH_NOINLINE float DistanceSquared(float x1, float y1, float z1, float x2, float y2, float z2) {
+        float dx = x2 - x1, dy = y2 - y1, dz = z2 - z1;
+        return dx * dx + dy * dy + dz * dz;
+    }
+    BENCH_NOINLINE float GravitationalForce(float m1, float m2, float distSq) {
+        return (6.67430e-11f * m1 * m2) / distSq;
+    }
+    BENCH_NOINLINE void Normalize(float* v) {
+        float mag = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (mag > 0.0f) { v[0] /= mag; v[1] /= mag; v[2] /= mag; }
+    }
+    BENCH_NOINLINE float DotProduct(const float* a, const float* b) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+}
+
+// ─── Mesure et statistiques ──────────────────────────────────────────────────
+struct Stats { double median, mad, min; };
+
+static Stats Summarize(std::vector<double> s) {
+    auto median = [](std::vector<double>& v) {
+        std::sort(v.begin(), v.end());
+        size_t h = v.size() / 2;
+        return v.size() % 2 ? v[h] : 0.5 * (v[h - 1] + v[h]);
+    };
+    Stats st;
+    st.median = median(s);
+    st.min = s.front();
+    for (double& x : s) x = std::abs(x - st.median);
+    st.mad = median(s);
+    return st;
+}
+
+struct Options {
+    std::vector<size_t> sizes = { 1u << 10, 1u << 12, 1u << 14, 1u << 16, 1u << 18, 1u << 20, 1u << 22, 1u << 24 };
+    std::vector<std::string> kernels = { "latency", "distance_squared", "accel_jerk", "normalize3", "axpy" };
+    int traceWidth = 40;        // --trace-width : largeur de l'image tracée (hauteur = 3/4)
+    int reps = 11;              // --reps : échantillons par mesure
+    double minMs = 2.0;         // --min-ms : durée minimale d'un échantillon
+    std::string csv, json;      // --csv / --json fichier ("-" = sortie standard)
+};
+
+// Durée moyenne d'un appel (ns) : un échantillon enchaîne `iters` appels.  Le nombre d'appels est doublé
+// jusqu'à ce qu'un échantillon dure au moins minMs ; ce calibrage sert aussi d'échauffement (caches,
+// TLB, fréquence).  Les tableaux de plusieurs Mo dépassent minMs en un appel : un appel par échantillon.
+template <class F>
+static Stats Measure(F&& call, const Options& o, size_t& itersOut) {
+    using Clock = std::chrono::steady_clock;
+    auto sample = [&](size_t iters) {
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < iters; ++i) { call(); ClobberMemory(); }
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+    };
+    size_t iters = 1;
+    while (sample(iters) < o.minMs * 1e6 && iters < (size_t(1) << 30)) iters *= 2;
+    std::vector<double> perCall(o.reps);
+    for (double& t : perCall) t = sample(iters) / double(iters);
+    itersOut = iters;
+    return Summarize(perCall);
+}
+
+struct Result {
+    std::string kind, kernel, variant;      // kind : "latency" ou "throughput"
+    size_t n;                               // éléments par appel (1 pour la latence)
+    size_t bytes;                           // octets lus + écrits par appel
+    size_t iters;                           // appels par échantillon
+    Stats  ns;                              // ns par appel
+};
+
+// Taille lisible : 1536 -> "1.5K", 16777216 -> "16M"
+static std::string HumanSize(double v, const char* unit = "") {
+    const char* suffix[] = { "", "K", "M", "G" };
+    int s = 0;
+    while (v >= 1024.0 && s < 3) { v /= 1024.0; ++s; }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), v == std::floor(v) ? "%.0f%s%s" : "%.1f%s%s", v, suffix[s], unit);
+    return buf;
+}
+
+static void PrintRow(const Result& r) {
+    const double nsElem = r.ns.median / double(r.n);
+    std::cout << "  " << std::left << std::setw(21) << r.kernel << std::setw(13) << r.variant << std::right
+              << std::setw(7) << HumanSize(double(r.n))
+              << std::setw(9) << (r.bytes ? HumanSize(double(r.bytes), "o") : std::string("-"))
+              << std::fixed << std::setprecision(3)
+              << std::setw(13) << nsElem << " ±" << std::setw(7) << (r.ns.mad / double(r.n))
+              << std::setprecision(2)
+              << std::setw(10) << (double(r.n) / r.ns.median)
+              << std::setw(9) << (double(r.bytes) / r.ns.median) << std::endl;
+}
+
+// ─── Noyaux tableau ──────────────────────────────────────────────────────────
+// Tableau de flottants aligné sur 64 octets (une ligne de cache)
+struct AlignedArray {
+    float* p;
+    explicit AlignedArray(size_t n)
+        : p(static_cast<float*>(std::aligned_alloc(64, ((n * sizeof(float) + 63) / 64) * 64))) {}
+    ~AlignedArray() { std::free(p); }
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+};
+
+// Remplit a[0..n) de valeurs pseudo-aléatoires reproductibles dans [lo, hi)
+static void Fill(float* a, size_t n, uint32_t seed, float lo, float hi) {
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        a[i] = lo + (hi - lo) * (float(seed >> 8) / float(1u << 24));
+    }
+}
+
+static void RunThroughput(const std::string& kernel, const Options& o, std::vector<Result>& results) {
+    const auto variants = AllVariants();
+    for (size_t n : o.sizes) {
+        AlignedArray x(n), y(n), z(n), vx(n), vy(n), vz(n), m(n), out(n);
+        Fill(x.p, n, 1, -10.0f, 10.0f);  Fill(y.p, n, 2, -10.0f, 10.0f);  Fill(z.p, n, 3, -10.0f, 10.0f);
+        Fill(vx.p, n, 4, -1.0f, 1.0f);   Fill(vy.p, n, 5, -1.0f, 1.0f);   Fill(vz.p, n, 6, -1.0f, 1.0f);
+        Fill(m.p, n, 7, 0.1f, 5.0f);     Fill(out.p, n, 8, 0.0f, 1.0f);
+
+        for (const auto& k : variants) {
+            Result r{ "throughput", kernel, k.name, n, 0, 0, {} };
+            float out6[6] = {};
+            if (kernel == "distance_squared") {
+                r.bytes = 16 * n;        // x, y, z lus, out écrit
+                r.ns = Measure([&] { k.distanceSquared(x.p, y.p, z.p, 0.5f, -0.25f, 1.0f, out.p, n); }, o, r.iters);
+                DoNotOptimize(out.p[n - 1]);
+            } else if (kernel == "accel_jerk") {
+                r.bytes = 28 * n;        // positions, vitesses et masses des sources
+                PhysicsForceBatch b;
+                b.x = x.p; b.y = y.p; b.z = z.p; b.vx = vx.p; b.vy = vy.p; b.vz = vz.p; b.mass = m.p;
+                b.count = n;
+                b.px = 0.5f; b.py = 0.5f; b.pz = 0.5f; b.pvx = b.pvy = b.pvz = 0.0f;
+                b.k = 1.0f; b.eps2 = 0.01f; b.velScale = 1.0f;
+                r.ns = Measure([&] { k.accelJerk(&b, out6); }, o, r.iters);
+                DoNotOptimize(out6[0]);
+            } else if (kernel == "normalize3") {
+                r.bytes = 24 * n;        // x, y, z lus puis réécrits
+                r.ns = Measure([&] { k.normalize(x.p, y.p, z.p, n); }, o, r.iters);
+                DoNotOptimize(x.p[n - 1]);
+            } else {
+                r.bytes = 12 * n;        // x lu, y lu puis réécrit
+                r.ns = Measure([&] { k.axpy(1e-7f, x.p, out.p, n); }, o, r.iters);
+                DoNotOptimize(out.p[n - 1]);
+            }
+            PrintRow(r);
+            results.push_back(r);
+        }
+    }
+}
+
+// ─── Latence des fonctions scalaires ─────────────────────────────────────────
+// Chaque appel dépend du résultat du précédent : on mesure la latence d'un appel, pas le débit
+static void RunLatency(const Options& o, std::vector<Result>& results) {
+    const char* backend = PhysicsASM::BackendName();     // "asm" ou "intrinsics"
+    auto add = [&](const char* kernel, const char* variant, size_t bytes, auto&& call) {
+        Result r{ "latency", kernel, variant, 1, bytes, 0, {} };
+        r.ns = Measure(call, o, r.iters);
+        PrintRow(r);
+        results.push_back(r);
+    };
+
+    float d = 1.0f;
+    add("distance_squared", backend, 0, [&] { d = PhysicsASM::DistanceSquared(d * 1e-3f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f); });
+    add("distance_squared", "cpp", 0, [&] { d = Latency::DistanceSquared(d * 1e-3f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f); });
+    float f = 1.0f;
+    add("gravitational_force", backend, 0, [&] { f = PhysicsASM::GravitationalForce(5.0f + f, 3.0f, 2.0f); });
+    add("gravitational_force", "cpp", 0, [&] { f = Latency::GravitationalForce(5.0f + f, 3.0f, 2.0f); });
+    // Seule la composante x porte la dépendance ; y et z sont réinitialisés à chaque appel (sinon dénormaux)
+    float v[3] = { 3.0f, 4.0f, 5.0f };
+    add("normalize", backend, 24, [&] { v[0] += 3.0f; v[1] = 4.0f; v[2] = 5.0f; PhysicsASM::Normalize(v); });
+    add("normalize", "cpp", 24, [&] { v[0] += 3.0f; v[1] = 4.0f; v[2] = 5.0f; Latency::Normalize(v); });
+    float a[3] = { 1.0f, 2.0f, 3.0f }, b[3] = { 4.0f, 5.0f, 6.0f }, dot = 0.0f;
+    add("dot_product", backend, 24, [&] { a[0] = dot * 1e-3f; dot = PhysicsASM::DotProduct(a, b); });
+    add("dot_product", "cpp", 24, [&] { a[0] = dot * 1e-3f; dot = Latency::DotProduct(a, b); });
+    DoNotOptimize(d + f + v[0] + dot);
+}
+
+// ─── Noyau du traceur CPU ────────────────────────────────────────────────────
+// Une image complète sur un seul thread pour chaque instanciation de CpuTracer::TraceBand :
+// intégrateur sphérique / cartésien × disque × objets.  Même scène que BlackHole_space_cpu (Sgr A*,
+// deux étoiles), caméra à sa distance de départ, un peu au-dessus du disque.  Un rayon qui s'échappe
+// fait ses 60000 pas (~1 ms) : l'image est petite (40×30 par défaut) et la section n'est lancée que
+// sur demande (--kernels trace).
+static void RunTrace(const Options& o, std::vector<Result>& results) {
+    const float rs = 1.269e10f, camR = 6.34194e10f, elevation = 1.4f;
+    const CpuTracer::Sphere scene[] = {
+        { 4e11f, 0.0f, 0.0f, 4e10f, 1, 1, 0, 1 },
+        { 0.0f, 0.0f, 4e11f, 4e10f, 1, 0, 0, 1 },
+        { 0.0f, 0.0f, 0.0f, rs,     0, 0, 0, 1 },
+    };
+    const float camPos[3] = { camR * std::sin(elevation), camR * std::cos(elevation), 0.0f };
+    const float target[3] = { 0.0f, 0.0f, 0.0f };
+
+    CpuTracer::Frame f;
+    f.width = o.traceWidth;
+    f.height = o.traceWidth * 3 / 4;
+    CpuTracer::LookAt(f, camPos, target, 60.0f, 4.0f / 3.0f);
+    f.rs = rs;
+    f.diskR1 = 2.2f * rs;
+    f.diskR2 = 5.2f * rs;
+    f.objects = scene;
+    f.objectCount = 3;
+    std::vector<uint8_t> rgba(size_t(f.width) * f.height * 4);
+    f.rgba = rgba.data();
+
+    const size_t pixels = size_t(f.width) * f.height;
+    for (auto integrator : { CpuTracer::Integrator::Spherical, CpuTracer::Integrator::Cartesian })
+        for (bool disk : { false, true })
+            for (bool objects : { false, true }) {
+                const CpuTracer::Variant& v = CpuTracer::Select(integrator, disk, objects);
+                Result r{ "throughput", "trace", v.name, pixels, 4 * pixels, 0, {} };   // ns/élém = ns par pixel
+                r.ns = Measure([&] { v.trace(f, 0, f.height); }, o, r.iters);
+                DoNotOptimize(rgba[4 * (pixels / 2)]);
+                PrintRow(r);
+                results.push_back(r);
+            }
+}
+
+// ─── Sorties CSV / JSON ──────────────────────────────────────────────────────
+// Colonnes : par appel (médiane, MAD, min en ns), puis par élément et débits dérivés de la médiane
+static void WriteCsv(std::ostream& os, const std::vector<Result>& results) {
+    os << "kind,kernel,variant,n,bytes_per_call,iters_per_sample,median_ns_per_call,mad_ns_per_call,min_ns_per_call,"
+          "median_ns_per_elem,mad_ns_per_elem,gelem_per_s,gb_per_s\n";
+    os << std::defaultfloat << std::setprecision(6);
+    for (const auto& r : results)
+        os << r.kind << ',' << r.kernel << ',' << r.variant << ',' << r.n << ',' << r.bytes << ',' << r.iters << ','
+           << r.ns.median << ',' << r.ns.mad << ',' << r.ns.min << ','
+           << r.ns.median / double(r.n) << ',' << r.ns.mad / double(r.n) << ','
+           << double(r.n) / r.ns.median << ',' << double(r.bytes) / r.ns.median << '\n';
+}
+
+static void WriteJson(std::ostream& os, const std::vector<Result>& results, const Options& o) {
+    os << std::defaultfloat << std::setprecision(6);
+    os << "{\n  \"backend\": \"" << PhysicsASM::BackendName() << "\",\n"
+       << "  \"batch_isa\": \"" << PhysicsASM::BatchIsaName() << "\",\n"
+       << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+       << "  \"reps\": " << o.reps << ",\n  \"min_sample_ms\": " << o.minMs << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << "    { \"kind\": \"" << r.kind << "\", \"kernel\": \"" << r.kernel << "\", \"variant\": \"" << r.variant
+           << "\", \"n\": " << r.n << ", \"bytes_per_call\": " << r.bytes << ", \"iters_per_sample\": " << r.iters
+           << ", \"median_ns_per_call\": " << r.ns.median << ", \"mad_ns_per_call\": " << r.ns.mad
+           << ", \"min_ns_per_call\": " << r.ns.min
+           << ", \"gelem_per_s\": " << double(r.n) / r.ns.median
+           << ", \"gb_per_s\": " << double(r.bytes) / r.ns.median << " }"
+           << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+template <class W>
+static void WriteTo(const std::string& path, W&& write) {
+    if (path.empty()) return;
+    if (path == "-") { write(std::cout); return; }
+    std::ofstream f(path);
+    if (!f) { std::cerr << "Impossible d'écrire " << path << std::endl; return; }
+    write(f);
+    std::cout << "Résultats écrits dans " << path << std::endl;
+}
+
+// ─── Ligne de commande ───────────────────────────────────────────────────────
+// Liste séparée par des virgules, avec suffixes K / M pour les tailles : "1K,64K,16M"
+static std::vector<std::string> SplitList(const std::string& s) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos) end = s.size();
+        if (end > start) out.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return out;
+}
+
+static size_t ParseSize(const std::string& s) {
+    char* end = nullptr;
+    size_t v = std::strtoull(s.c_str(), &end, 10);
+    if (*end == 'K' || *end == 'k') v <<= 10;
+    else if (*end == 'M' || *end == 'm') v <<= 20;
+    return std::max<size_t>(1, v);
+}
+
+static Options ParseArgs(int argc, char* argv[]) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasNext = i + 1 < argc;
+        if (a == "--quick") { o.sizes = { 1u << 10, 1u << 14, 1u << 18, 1u << 20 }; o.reps = 5; o.minMs = 1.0; o.traceWidth = 16; }
+        else if (a == "--sizes" && hasNext) {
+            o.sizes.clear();
+            for (const auto& s : SplitList(argv[++i])) o.sizes.push_back(ParseSize(s));
+        }
+        else if (a == "--kernels" && hasNext) o.kernels = SplitList(argv[++i]);
+        else if (a == "--reps" && hasNext) o.reps = std::max(3, std::atoi(argv[++i]));
+        else if (a == "--min-ms" && hasNext) o.minMs = std::max(0.1, std::atof(argv[++i]));
+        else if (a == "--trace-width" && hasNext) o.traceWidth = std::max(4, std::atoi(argv[++i]));
+        else if (a == "--csv" && hasNext) o.csv = argv[++i];
+        else if (a == "--json" && hasNext) o.json = argv[++i];
+        else {
+            std::cerr << "Option inconnue : " << a << "\n"
+                      << "Usage : PhysicsASM_Bench [--quick] [--sizes 1K,64K,16M] [--reps N] [--min-ms X]\n"
+                         "                         [--kernels latency,distance_squared,accel_jerk,normalize3,axpy,trace]\n"
+                         "                         [--trace-width W]\n"
+                         "                         [--csv f.csv|-] [--json f.json|-]" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    return o;
+}
+
+int main(int argc, char* argv[]) {
+    Options o = ParseArgs(argc, argv);
+
+    std::cout << "   Suite de Benchmarks PhysicsASM" << std::endl;
+    std::cout << "   Backend : " << PhysicsASM::BackendName() << "   |  noyaux tableau sélectionnés : " << PhysicsASM::BatchIsaName()
+              << "   |  " << o.reps << " échantillons ≥ " << o.minMs << " ms, médiane ± MAD" << std::endl;
+    std::cout << "\n  " << std::left << std::setw(21) << "noyau" << std::setw(13) << "variante" << std::right
+              << std::setw(7) << "n" << std::setw(9) << "octets" << std::setw(13) << "ns/élém" << std::setw(9) << "MAD"
+              << std::setw(10) << "Gélém/s" << std::setw(9) << "Go/s" << std::endl;
+
+    std::vector<Result> results;
+    for (const auto& k : o.kernels) {
+        if (k == "latency") RunLatency(o, results);
+        else if (k == "distance_squared" || k == "accel_jerk" || k == "normalize3" || k == "axpy")
+            RunThroughput(k, o, results);
+        else if (k == "trace") RunTrace(o, results);
+        else std::cerr << "Noyau inconnu ignoré : " << k << std::endl;
+    }
+
+    WriteTo(o.csv,  [&](std::ostream& os) { WriteCsv(os, results); });
+    WriteTo(o.json, [&](std::ostream& os) { WriteJson(os, results, o); });
+    return 0;
+}
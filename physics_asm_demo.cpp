@@ -3,6 +3,10 @@
 #include <iomanip>
 #include <cmath>
 #include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
 
 // Ce programme valide la correction et mesure les performances des implémentations x86-64 écrites à la main
@@ -170,6 +174,175 @@ void TestVectorScale() {
     std::cout << "Correspondance : " << (match ? "✓" : "✗") << std::endl;
 }
 
+// Remplit x, y, z, vx, vy, vz et les masses de valeurs pseudo-aléatoires reproductibles
+static void FillBatchInputs(std::vector<float>* soa, size_t n) {
+    uint32_t seed = 12345u;
+    auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return float(seed >> 8) / float(1u << 24); };
+    for (int a = 0; a < 7; ++a) {
+        soa[a].resize(n);
+        for (size_t i = 0; i < n; ++i) soa[a][i] = (a == 6) ? 0.1f + 5.0f * next() : 20.0f * next() - 10.0f;
+    }
+}
+
+// Vérifie chaque jeu d'instructions supporté contre une référence scalaire en double,
+// avec des tailles qui tombent pile sur la largeur ou laissent une queue (1, 3, 7, 17...)
+void TestBatchKernels() {
+    std::cout << "\n=== Test des Noyaux Tableau (SoA) ===" << std::endl;
+    std::cout << "Sélection automatique : " << PhysicsASM::BatchIsaName() << std::endl;
+
+    const size_t sizes[] = { 1, 3, 4, 7, 8, 15, 16, 17, 33, 100 };
+    for (int isa = 0; isa < PhysicsASM::BATCH_ISA_COUNT; ++isa) {
+        const auto& k = PhysicsASM::BatchKernelsFor(PhysicsASM::BatchIsa(isa));
+        if (!PhysicsASM::BatchIsaSupported(PhysicsASM::BatchIsa(isa))) {
+            std::cout << "  " << k.name << " : non supporté par ce CPU" << std::endl;
+            continue;
+        }
+        double worst = 0.0;
+        for (size_t n : sizes) {
+            std::vector<float> v[7];
+            FillBatchInputs(v, n);
+            const float px = 1.5f, py = -2.0f, pz = 0.25f;
+
+            // Distance au carré
+            std::vector<float> d2(n);
+            k.distanceSquared(v[0].data(), v[1].data(), v[2].data(), px, py, pz, d2.data(), n);
+            for (size_t i = 0; i < n; ++i) {
+                double dx = v[0][i] - px, dy = v[1][i] - py, dz = v[2][i] - pz;
+                double ref = dx*dx + dy*dy + dz*dz;
+                worst = std::max(worst, std::abs(d2[i] - ref) / (ref + 1e-6));
+            }
+
+            // Accélération + jerk, cible = source 0 sans adoucissement (l'auto-interaction doit être ignorée)
+            PhysicsForceBatch b;
+            b.x = v[0].data(); b.y = v[1].data(); b.z = v[2].data();
+            b.vx = v[3].data(); b.vy = v[4].data(); b.vz = v[5].data();
+            b.mass = v[6].data(); b.count = n;
+            b.px = v[0][0]; b.py = v[1][0]; b.pz = v[2][0];
+            b.pvx = v[3][0]; b.pvy = v[4][0]; b.pvz = v[5][0];
+            b.k = 0.7f; b.eps2 = 0.0f; b.velScale = 0.3f;
+            float out[6];
+            k.accelJerk(&b, out);
+            double ref[6] = {};
+            for (size_t j = 1; j < n; ++j) {
+                double dx = v[0][j] - b.px, dy = v[1][j] - b.py, dz = v[2][j] - b.pz;
+                double dvx = (v[3][j] - b.pvx) * 0.3, dvy = (v[4][j] - b.pvy) * 0.3, dvz = (v[5][j] - b.pvz) * 0.3;
+                double invR2 = 1.0 / (dx*dx + dy*dy + dz*dz);
+                double km3 = 0.7 * v[6][j] * invR2 * std::sqrt(invR2);
+                double rv3 = 3.0 * (dx*dvx + dy*dvy + dz*dvz) * invR2;
+                ref[0] += km3 * dx; ref[1] += km3 * dy; ref[2] += km3 * dz;
+                ref[3] += km3 * (dvx - rv3 * dx); ref[4] += km3 * (dvy - rv3 * dy); ref[5] += km3 * (dvz - rv3 * dz);
+            }
+            for (int c = 0; c < 6; c += 3) {
+                double scale = std::max({ std::abs(ref[c]), std::abs(ref[c + 1]), std::abs(ref[c + 2]), 1e-9 });
+                for (int m = c; m < c + 3; ++m) worst = std::max(worst, std::abs(out[m] - ref[m]) / scale);
+            }
+
+            // Normalisation (un vecteur nul doit rester nul) puis axpy
+            std::vector<float> nx = v[0], ny = v[1], nz = v[2];
+            nx[0] = ny[0] = nz[0] = 0.0f;
+            k.normalize(nx.data(), ny.data(), nz.data(), n);
+            if (nx[0] != 0.0f || ny[0] != 0.0f || nz[0] != 0.0f) worst = 1.0;
+            for (size_t i = 1; i < n; ++i) {
+                double len = std::sqrt(double(v[0][i])*v[0][i] + double(v[1][i])*v[1][i] + double(v[2][i])*v[2][i]);
+                worst = std::max({ worst, std::abs(nx[i] - v[0][i] / len), std::abs(ny[i] - v[1][i] / len),
+                                   std::abs(nz[i] - v[2][i] / len) });
+            }
+            std::vector<float> yv = v[1];
+            k.axpy(0.37f, v[0].data(), yv.data(), n);
+            for (size_t i = 0; i < n; ++i)
+                worst = std::max(worst, std::abs(yv[i] - (v[1][i] + 0.37 * v[0][i])) / (1.0 + std::abs(yv[i])));
+        }
+        std::cout << "  " << std::setw(8) << std::left << k.name << std::right
+                  << " écart relatif max " << std::scientific << std::setprecision(2) << worst << std::fixed
+                  << "  Correspondance : " << (worst < 1e-3 ? "✓" : "✗") << std::endl;
+    }
+}
+
+// Remplit des paquets de rayons autour d'un trou noir de rayon rs (positions et vitesses variées)
+static void FillGeodesicPackets(std::vector<GeodesicPacket>& packets, float rs) {
+    uint32_t seed = 777u;
+    auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return float(seed >> 8) / float(1u << 24); };
+    for (auto& p : packets)
+        for (int l = 0; l < 4; ++l) {
+            p.r[l]      = rs * (2.0f + 30.0f * next());
+            p.theta[l]  = 0.1f + 2.9f * next();
+            p.phi[l]    = 12.0f * next() - 6.0f;
+            p.dr[l]     = 2.0f * next() - 1.0f;
+            p.dtheta[l] = (2.0f * next() - 1.0f) / p.r[l];
+            p.dphi[l]   = (2.0f * next() - 1.0f) / p.r[l];
+            p.E[l]      = 0.5f + next();
+        }
+}
+
+// Le pas RK4 en assembleur doit reproduire la référence C++ au bit près (mêmes opérations, même ordre)
+void TestGeodesicPacket() {
+    std::cout << "\n=== Test du Pas RK4 Géodésique (paquets de 4 rayons) ===" << std::endl;
+
+    const float rs = 1.269e10f, dL = 1e7f;
+    std::vector<GeodesicPacket> asm_packets(16);
+    FillGeodesicPackets(asm_packets, rs);
+    std::vector<GeodesicPacket> cpp_packets = asm_packets;
+
+    for (int step = 0; step < 100; ++step) {
+        PhysicsASM::GeodesicRK4(asm_packets.data(), asm_packets.size(), dL, rs);
+        PhysicsASM::GeodesicRK4Reference(cpp_packets.data(), cpp_packets.size(), dL, rs);
+    }
+    bool identical = std::memcmp(asm_packets.data(), cpp_packets.data(),
+                                 asm_packets.size() * sizeof(GeodesicPacket)) == 0;
+
+    // Précision du sinus/cosinus polynomial face à la libm (double)
+    double worst = 0.0;
+    for (int i = -10000; i <= 10000; ++i) {
+        float x = i * 0.01f, s, c;
+        PhysicsASM::SinCosPoly(x, s, c);
+        worst = std::max({ worst, std::abs(s - std::sin(double(x))), std::abs(c - std::cos(double(x))) });
+    }
+
+    std::cout << "r après 100 pas (rayon 0) : ASM " << asm_packets[0].r[0] << " / C++ " << cpp_packets[0].r[0] << std::endl;
+    std::cout << "sin/cos polynomial, écart max sur [-100, 100] : " << std::scientific << std::setprecision(2)
+              << worst << std::fixed << std::endl;
+    std::cout << "Correspondance : " << (identical && worst < 1e-6 ? "✓" : "✗") << std::endl;
+}
+
+// Les mêmes rayons sous forme cartésienne : position, direction et h² = |x × v|²
+static void FillCartesianPackets(std::vector<CartesianPacket>& packets, float rs) {
+    uint32_t seed = 4242u;
+    auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return float(seed >> 8) / float(1u << 24); };
+    for (auto& p : packets)
+        for (int l = 0; l < 4; ++l) {
+            p.x[l]  = rs * (30.0f * next() - 15.0f);
+            p.y[l]  = rs * (30.0f * next() - 15.0f);
+            p.z[l]  = rs * (3.0f + 20.0f * next());
+            p.vx[l] = next() - 0.5f;
+            p.vy[l] = next() - 0.5f;
+            p.vz[l] = -1.0f;
+            float hx = p.y[l] * p.vz[l] - p.z[l] * p.vy[l];
+            float hy = p.z[l] * p.vx[l] - p.x[l] * p.vz[l];
+            float hz = p.x[l] * p.vy[l] - p.y[l] * p.vx[l];
+            p.h2[l] = hx * hx + hy * hy + hz * hz;
+        }
+}
+
+// Le pas cartésien en assembleur doit lui aussi reproduire sa référence C++ au bit près
+void TestCartesianPacket() {
+    std::cout << "\n=== Test du Pas RK4 Cartésien (sans trigonométrie) ===" << std::endl;
+
+    const float rs = 1.269e10f, dL = 1e8f;
+    std::vector<CartesianPacket> asm_packets(16);
+    FillCartesianPackets(asm_packets, rs);
+    std::vector<CartesianPacket> cpp_packets = asm_packets;
+
+    for (int step = 0; step < 100; ++step) {
+        PhysicsASM::CartesianRK4(asm_packets.data(), asm_packets.size(), dL, rs);
+        PhysicsASM::CartesianRK4Reference(cpp_packets.data(), cpp_packets.size(), dL, rs);
+    }
+    bool identical = std::memcmp(asm_packets.data(), cpp_packets.data(),
+                                 asm_packets.size() * sizeof(CartesianPacket)) == 0;
+
+    std::cout << "z après 100 pas (rayon 0) : ASM " << asm_packets[0].z[0] << " / C++ " << cpp_packets[0].z[0] << std::endl;
+    std::cout << "Correspondance : " << (identical ? "✓" : "✗") << std::endl;
+}
+
 void TestPhysicsScenario() {
     std::cout << "\n=== Scénario de Simulation Physique ===" << std::endl;
     std::cout << "Calcul de l'interaction gravitationnelle entre deux objets massifs :" << std::endl;
@@ -347,13 +520,122 @@ void BenchmarkPerformance() {
     }
     
 
+    // Benchmark 5: Noyaux tableau, chaque jeu d'instructions supporté contre la boucle C++
+    {
+        const size_t N = 4096;
+        const int REPS = 200;
+        std::cout << "\n[5] Accélération + jerk, " << N << " sources (" << REPS << " cibles)" << std::endl;
+
+        std::vector<float> v[7];
+        FillBatchInputs(v, N);
+        PhysicsForceBatch b;
+        b.x = v[0].data(); b.y = v[1].data(); b.z = v[2].data();
+        b.vx = v[3].data(); b.vy = v[4].data(); b.vz = v[5].data();
+        b.mass = v[6].data(); b.count = N;
+        b.px = 0.5f; b.py = 0.5f; b.pz = 0.5f; b.pvx = b.pvy = b.pvz = 0.0f;
+        b.k = 1.0f; b.eps2 = 0.01f; b.velScale = 1.0f;
+        volatile float sink = 0.0f;
+
+        double cpp_time = 0.0;
+        {
+            ScopedTimer timer("C++ Scalaire", &cpp_time);
+            for (int r = 0; r < REPS; r++) {
+                float sax = 0, sjx = 0;
+                for (size_t j = 0; j < N; ++j) {
+                    float dx = v[0][j] - b.px, dy = v[1][j] - b.py, dz = v[2][j] - b.pz;
+                    float invR = 1.0f / std::sqrt(dx*dx + dy*dy + dz*dz + b.eps2);
+                    float invR2 = invR * invR;
+                    float km3 = b.k * v[6][j] * invR * invR2;
+                    float rv3 = 3.0f * (dx*v[3][j] + dy*v[4][j] + dz*v[5][j]) * invR2;
+                    sax += km3 * dx;
+                    sjx += km3 * (v[3][j] - rv3 * dx);
+                }
+                sink = sax + sjx;
+            }
+        }
+        std::cout << "  C++ Scalaire :     " << std::fixed << std::setprecision(3) << cpp_time << " ms" << std::endl;
+
+        for (int isa = 0; isa < PhysicsASM::BATCH_ISA_COUNT; ++isa) {
+            if (!PhysicsASM::BatchIsaSupported(PhysicsASM::BatchIsa(isa))) continue;
+            const auto& k = PhysicsASM::BatchKernelsFor(PhysicsASM::BatchIsa(isa));
+            double asm_time = 0.0;
+            {
+                ScopedTimer timer(k.name, &asm_time);
+                float out[6];
+                for (int r = 0; r < REPS; r++) {
+                    k.accelJerk(&b, out);
+                    sink = out[0] + out[3];
+                }
+            }
+            std::cout << "  " << std::setw(8) << std::left << k.name << std::right << " :        "
+                      << std::fixed << std::setprecision(3) << asm_time << " ms  ("
+                      << std::setprecision(2) << (cpp_time / asm_time) << "x)" << std::endl;
+        }
+        (void)sink;
+    }
+
+
+    // Benchmark 6: Pas RK4 géodésique, paquets SSE contre la référence C++
+    {
+        const float rs = 1.269e10f, dL = 1e7f;
+        const int STEPS = 200;
+        std::vector<GeodesicPacket> cpp_packets(256);
+        FillGeodesicPackets(cpp_packets, rs);
+        std::vector<GeodesicPacket> asm_packets = cpp_packets;
+        std::cout << "\n[6] Pas RK4 géodésique (" << cpp_packets.size() * 4 << " rayons × " << STEPS << " pas)" << std::endl;
+
+        double cpp_time = 0.0, asm_time = 0.0;
+        {
+            ScopedTimer timer("C++ Scalaire", &cpp_time);
+            for (int i = 0; i < STEPS; i++)
+                PhysicsASM::GeodesicRK4Reference(cpp_packets.data(), cpp_packets.size(), dL, rs);
+        }
+        {
+            ScopedTimer timer("Assembleur SIMD", &asm_time);
+            for (int i = 0; i < STEPS; i++)
+                PhysicsASM::GeodesicRK4(asm_packets.data(), asm_packets.size(), dL, rs);
+        }
+
+        std::cout << "  C++ Scalaire :     " << std::fixed << std::setprecision(3) << cpp_time << " ms" << std::endl;
+        std::cout << "  Assembleur SIMD :  " << std::fixed << std::setprecision(3) << asm_time << " ms" << std::endl;
+        std::cout << "  Accélération :        " << std::fixed << std::setprecision(2) << (cpp_time / asm_time) << "x" << std::endl;
+    }
+
+    // Benchmark 7: Pas RK4 cartésien (sans trigonométrie), mêmes dimensions que [6]
+    {
+        const float rs = 1.269e10f, dL = 1e7f;
+        const int STEPS = 200;
+        std::vector<CartesianPacket> cpp_packets(256);
+        FillCartesianPackets(cpp_packets, rs);
+        std::vector<CartesianPacket> asm_packets = cpp_packets;
+        std::cout << "\n[7] Pas RK4 cartésien (" << cpp_packets.size() * 4 << " rayons × " << STEPS << " pas)" << std::endl;
+
+        double cpp_time = 0.0, asm_time = 0.0;
+        {
+            ScopedTimer timer("C++ Scalaire", &cpp_time);
+            for (int i = 0; i < STEPS; i++)
+                PhysicsASM::CartesianRK4Reference(cpp_packets.data(), cpp_packets.size(), dL, rs);
+        }
+        {
+            ScopedTimer timer("Assembleur SIMD", &asm_time);
+            for (int i = 0; i < STEPS; i++)
+                PhysicsASM::CartesianRK4(asm_packets.data(), asm_packets.size(), dL, rs);
+        }
+
+        std::cout << "  C++ Scalaire :     " << std::fixed << std::setprecision(3) << cpp_time << " ms" << std::endl;
+        std::cout << "  Assembleur SIMD :  " << std::fixed << std::setprecision(3) << asm_time << " ms" << std::endl;
+        std::cout << "  Accélération :        " << std::fixed << std::setprecision(2) << (cpp_time / asm_time) << "x" << std::endl;
+    }
+
     std::cout << "           Benchmarks Terminés !                             " << std::endl;
+    std::cout << "\nPour des mesures répétées sur de vrais tableaux (médiane, MAD, CSV/JSON) : ./PhysicsASM_Bench" << std::endl;
 
 }
 
 int main(int argc, char* argv[]) {
     std::cout << "   Démo des Fonctions Physiques Optimisées en Assembleur      " << std::endl;
     std::cout << "   Assembleur x86-64 avec Instructions SIMD SSE              " << std::endl;
+    std::cout << "   Backend : " << PhysicsASM::BackendName() << " (CMake PHYSICS_BACKEND)" << std::endl;
 
     // Vérifier si le mode benchmark est demandé
     bool benchmark_mode = false;
@@ -372,6 +654,9 @@ int main(int argc, char* argv[]) {
         TestDotProduct();
         TestVectorAdd();
         TestVectorScale();
+        TestBatchKernels();
+        TestGeodesicPacket();
+        TestCartesianPacket();
         TestPhysicsScenario();
 
         std::cout << "             Tous les Tests se sont Terminés avec Succès !            " << std::endl;
@@ -0,0 +1,289 @@
+#ifndef PHYSICS_INTRIN_HPP
+#define PHYSICS_INTRIN_HPP
+
+// Header-only intrinsics backend for physics_asm.hpp (CMake: -DPHYSICS_BACKEND=intrinsics).
+//
+// Defines every function physics_asm.hpp declares — the six scalar helpers,
+// the batched SoA kernels and the Cartesian RK4 packet step — as inline C++
+// with compiler intrinsics instead of linking the assembly.  The bodies are
+// visible at every call site, so the compiler can inline them into the
+// gravity loops, keep values in registers between calls and, with LTO,
+// optimise across translation units.  physics_asm.hpp includes this file at
+// its end; do not include it directly.
+//
+// The batch width follows the compiler flags rather than run-time CPUID:
+// AVX2+FMA (8 lanes) when the target enables them (e.g. -march=native), SSE2
+// (4 lanes) otherwise on x86-64, NEON (4 lanes) on AArch64.  The scalar
+// helpers and the Cartesian step use the assembly's operation order, so
+// without FMA contraction they return the same floats.  GeodesicRK4 runs the
+// C++ reference with this backend.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+
+// ─── Scalar helpers ──────────────────────────────────────────────────────────
+
+inline float vector_distance_squared(float x1, float y1, float z1,
+                                     float x2, float y2, float z2) {
+    float dx = x2 - x1, dy = y2 - y1, dz = z2 - z1;
+    return (dx * dx + dy * dy) + dz * dz;
+}
+
+// F = ((G * m1) / r²) * m2, in that order to stay in float range
+inline float gravitational_force(float mass1, float mass2, float distance_squared) {
+    return ((6.67430e-11f * mass1) / distance_squared) * mass2;
+}
+
+inline void normalize_vector3(float* vector) {
+    float mag = std::sqrt((vector[0] * vector[0] + vector[1] * vector[1]) + vector[2] * vector[2]);
+    if (mag > 0.0f) {           // also skips NaN, like the assembly's ucomiss/je
+        vector[0] /= mag;
+        vector[1] /= mag;
+        vector[2] /= mag;
+    }
+}
+
+inline float dot_product3(const float* v1, const float* v2) {
+    return (v1[0] * v2[0] + v1[1] * v2[1]) + v1[2] * v2[2];
+}
+
+inline void vector_add3(const float* v1, const float* v2, float* result) {
+    result[0] = v1[0] + v2[0];
+    result[1] = v1[1] + v2[1];
+    result[2] = v1[2] + v2[2];
+}
+
+inline void vector_scale3(const float* v, float scalar, float* result) {
+    result[0] = v[0] * scalar;
+    result[1] = v[1] * scalar;
+    result[2] = v[2] * scalar;
+}
+
+// ─── SIMD layer ──────────────────────────────────────────────────────────────
+// Each kernel is written once against these traits (W lanes of float).
+
+namespace PhysicsIntrin {
+
+#if defined(__x86_64__) || defined(_M_X64)
+    struct Simd4 {
+        using V = __m128;
+        static constexpr size_t W = 4;
+        static V    Load(const float* p)          { return _mm_loadu_ps(p); }
+        static void Store(float* p, V v)          { _mm_storeu_ps(p, v); }
+        static V    Set1(float s)                 { return _mm_set1_ps(s); }
+        static V    Add(V a, V b)                 { return _mm_add_ps(a, b); }
+        static V    Sub(V a, V b)                 { return _mm_sub_ps(a, b); }
+        static V    Mul(V a, V b)                 { return _mm_mul_ps(a, b); }
+        static V    Div(V a, V b)                 { return _mm_div_ps(a, b); }
+        static V    Sqrt(V a)                     { return _mm_sqrt_ps(a); }
+        static V    MulAdd(V a, V b, V c)         { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static V    IfPositive(V c, V a, V b) {   // c > 0 ? a : b
+            V m = _mm_cmpgt_ps(c, _mm_setzero_ps());
+            return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+        }
+    };
+
+#if defined(__AVX2__) && defined(__FMA__)
+    struct Simd8 {
+        using V = __m256;
+        static constexpr size_t W = 8;
+        static V    Load(const float* p)          { return _mm256_loadu_ps(p); }
+        static void Store(float* p, V v)          { _mm256_storeu_ps(p, v); }
+        static V    Set1(float s)                 { return _mm256_set1_ps(s); }
+        static V    Add(V a, V b)                 { return _mm256_add_ps(a, b); }
+        static V    Sub(V a, V b)                 { return _mm256_sub_ps(a, b); }
+        static V    Mul(V a, V b)                 { return _mm256_mul_ps(a, b); }
+        static V    Div(V a, V b)                 { return _mm256_div_ps(a, b); }
+        static V    Sqrt(V a)                     { return _mm256_sqrt_ps(a); }
+        static V    MulAdd(V a, V b, V c)         { return _mm256_fmadd_ps(a, b, c); }
+        static V    IfPositive(V c, V a, V b) {
+            return _mm256_blendv_ps(b, a, _mm256_cmp_ps(c, _mm256_setzero_ps(), _CMP_GT_OQ));
+        }
+    };
+    using BatchSimd = Simd8;
+    static const char* const BatchName = "Intrinsics AVX2";
+#else
+    using BatchSimd = Simd4;
+    static const char* const BatchName = "Intrinsics SSE2";
+#endif
+
+#else
+    struct Simd4 {
+        using V = float32x4_t;
+        static constexpr size_t W = 4;
+        static V    Load(const float* p)          { return vld1q_f32(p); }
+        static void Store(float* p, V v)          { vst1q_f32(p, v); }
+        static V    Set1(float s)                 { return vdupq_n_f32(s); }
+        static V    Add(V a, V b)                 { return vaddq_f32(a, b); }
+        static V    Sub(V a, V b)                 { return vsubq_f32(a, b); }
+        static V    Mul(V a, V b)                 { return vmulq_f32(a, b); }
+        static V    Div(V a, V b)                 { return vdivq_f32(a, b); }
+        static V    Sqrt(V a)                     { return vsqrtq_f32(a); }
+        static V    MulAdd(V a, V b, V c)         { return vfmaq_f32(c, a, b); }
+        static V    IfPositive(V c, V a, V b)     { return vbslq_f32(vcgtq_f32(c, vdupq_n_f32(0.0f)), a, b); }
+    };
+    using BatchSimd = Simd4;
+    static const char* const BatchName = "Intrinsics NEON";
+#endif
+
+    // Lanes summed in a fixed order (lane 0 first), so results never depend on threading
+    template <class S>
+    inline float HSum(typename S::V v) {
+        alignas(32) float lanes[S::W];
+        S::Store(lanes, v);
+        float sum = 0.0f;
+        for (size_t l = 0; l < S::W; ++l) sum += lanes[l];
+        return sum;
+    }
+
+    // ─── Batched kernels ─────────────────────────────────────────────────────
+    // Same semantics as physics_asm_batch.s: full vectors first, then a scalar tail.
+
+    template <class S>
+    inline void DistanceSquared(const float* x, const float* y, const float* z,
+                                float px, float py, float pz, float* out, size_t n) {
+        using V = typename S::V;
+        const V vpx = S::Set1(px), vpy = S::Set1(py), vpz = S::Set1(pz);
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) {
+            V dx = S::Sub(S::Load(x + i), vpx), dy = S::Sub(S::Load(y + i), vpy), dz = S::Sub(S::Load(z + i), vpz);
+            S::Store(out + i, S::MulAdd(dz, dz, S::MulAdd(dy, dy, S::Mul(dx, dx))));
+        }
+        for (; i < n; ++i) {
+            float dx = x[i] - px, dy = y[i] - py, dz = z[i] - pz;
+            out[i] = dx * dx + dy * dy + dz * dz;
+        }
+    }
+
+    // A source at zero distance (r² + eps² == 0, i.e. the target itself) contributes nothing
+    template <class S>
+    inline void AccelJerk(const PhysicsForceBatch& b, float* out6) {
+        using V = typename S::V;
+        const V px = S::Set1(b.px), py = S::Set1(b.py), pz = S::Set1(b.pz);
+        const V pvx = S::Set1(b.pvx), pvy = S::Set1(b.pvy), pvz = S::Set1(b.pvz);
+        const V k = S::Set1(b.k), eps2 = S::Set1(b.eps2), vs = S::Set1(b.velScale);
+        const V one = S::Set1(1.0f), three = S::Set1(3.0f), zero = S::Set1(0.0f);
+        V ax = zero, ay = zero, az = zero, jx = zero, jy = zero, jz = zero;
+        size_t j = 0;
+        for (; j + S::W <= b.count; j += S::W) {
+            V dx = S::Sub(S::Load(b.x + j), px), dy = S::Sub(S::Load(b.y + j), py), dz = S::Sub(S::Load(b.z + j), pz);
+            V r2 = S::Add(S::MulAdd(dz, dz, S::MulAdd(dy, dy, S::Mul(dx, dx))), eps2);
+            V invR = S::IfPositive(r2, S::Div(one, S::Sqrt(r2)), zero);
+            V invR2 = S::Mul(invR, invR);
+            V km3 = S::Mul(S::Mul(S::Mul(k, S::Load(b.mass + j)), invR), invR2);
+            V dvx = S::Mul(S::Sub(S::Load(b.vx + j), pvx), vs);
+            V dvy = S::Mul(S::Sub(S::Load(b.vy + j), pvy), vs);
+            V dvz = S::Mul(S::Sub(S::Load(b.vz + j), pvz), vs);
+            V rv3 = S::Mul(S::Mul(three, S::MulAdd(dz, dvz, S::MulAdd(dy, dvy, S::Mul(dx, dvx)))), invR2);
+            ax = S::MulAdd(km3, dx, ax);  ay = S::MulAdd(km3, dy, ay);  az = S::MulAdd(km3, dz, az);
+            jx = S::MulAdd(km3, S::Sub(dvx, S::Mul(rv3, dx)), jx);
+            jy = S::MulAdd(km3, S::Sub(dvy, S::Mul(rv3, dy)), jy);
+            jz = S::MulAdd(km3, S::Sub(dvz, S::Mul(rv3, dz)), jz);
+        }
+        float sum[6] = { HSum<S>(ax), HSum<S>(ay), HSum<S>(az), HSum<S>(jx), HSum<S>(jy), HSum<S>(jz) };
+        for (; j < b.count; ++j) {
+            float dx = b.x[j] - b.px, dy = b.y[j] - b.py, dz = b.z[j] - b.pz;
+            float r2 = dx * dx + dy * dy + dz * dz + b.eps2;
+            float invR = r2 > 0.0f ? 1.0f / std::sqrt(r2) : 0.0f;
+            float invR2 = invR * invR;
+            float km3 = b.k * b.mass[j] * invR * invR2;
+            float dvx = (b.vx[j] - b.pvx) * b.velScale, dvy = (b.vy[j] - b.pvy) * b.velScale;
+            float dvz = (b.vz[j] - b.pvz) * b.velScale;
+            float rv3 = 3.0f * (dx * dvx + dy * dvy + dz * dvz) * invR2;
+            sum[0] += km3 * dx;  sum[1] += km3 * dy;  sum[2] += km3 * dz;
+            sum[3] += km3 * (dvx - rv3 * dx);  sum[4] += km3 * (dvy - rv3 * dy);  sum[5] += km3 * (dvz - rv3 * dz);
+        }
+        for (int c = 0; c < 6; ++c) out6[c] = sum[c];
+    }
+
+    // Zero-length vectors are left unchanged
+    template <class S>
+    inline void Normalize(float* x, float* y, float* z, size_t n) {
+        using V = typename S::V;
+        const V one = S::Set1(1.0f);
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) {
+            V vx = S::Load(x + i), vy = S::Load(y + i), vz = S::Load(z + i);
+            V len = S::Sqrt(S::MulAdd(vz, vz, S::MulAdd(vy, vy, S::Mul(vx, vx))));
+            len = S::IfPositive(len, len, one);
+            S::Store(x + i, S::Div(vx, len));  S::Store(y + i, S::Div(vy, len));  S::Store(z + i, S::Div(vz, len));
+        }
+        for (; i < n; ++i) {
+            float len = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+            len = len > 0.0f ? len : 1.0f;
+            x[i] /= len;  y[i] /= len;  z[i] /= len;
+        }
+    }
+
+    template <class S>
+    inline void Axpy(float a, const float* x, float* y, size_t n) {
+        const typename S::V va = S::Set1(a);
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::Store(y + i, S::MulAdd(va, S::Load(x + i), S::Load(y + i)));
+        for (; i < n; ++i) y[i] += a * x[i];
+    }
+
+} // namespace PhysicsIntrin
+
+inline void batch_distance_squared_intrin(const float* x, const float* y, const float* z,
+                                          float px, float py, float pz, float* out, size_t n) {
+    PhysicsIntrin::DistanceSquared<PhysicsIntrin::BatchSimd>(x, y, z, px, py, pz, out, n);
+}
+
+inline void batch_accel_jerk_intrin(const PhysicsForceBatch* batch, float* out6) {
+    PhysicsIntrin::AccelJerk<PhysicsIntrin::BatchSimd>(*batch, out6);
+}
+
+inline void batch_normalize3_intrin(float* x, float* y, float* z, size_t n) {
+    PhysicsIntrin::Normalize<PhysicsIntrin::BatchSimd>(x, y, z, n);
+}
+
+inline void batch_axpy_intrin(float a, const float* x, float* y, size_t n) {
+    PhysicsIntrin::Axpy<PhysicsIntrin::BatchSimd>(a, x, y, n);
+}
+
+namespace PhysicsASM {
+    inline const BatchKernels& BatchKernelsFor(BatchIsa) {
+        static const BatchKernels intrin = { PhysicsIntrin::BatchName, "intrin",
+                                             batch_distance_squared_intrin, batch_accel_jerk_intrin,
+                                             batch_normalize3_intrin,       batch_axpy_intrin };
+        return intrin;
+    }
+}
+
+// ─── Cartesian RK4 packets ───────────────────────────────────────────────────
+// CartesianRK4Reference with one ray per lane, same operations in the same order.
+
+inline void cartesian_rk4_intrin(CartesianPacket* packets, size_t count, float dL, float rs) {
+    using S = PhysicsIntrin::Simd4;
+    using V = S::V;
+    const V half = S::Set1(dL * 0.5f), full = S::Set1(dL), c = S::Set1(dL / 6.0f);
+    const V krs = S::Set1(-1.5f * rs), one = S::Set1(1.0f), two = S::Set1(2.0f);
+    for (size_t n = 0; n < count; ++n) {
+        CartesianPacket& p = packets[n];
+        float* const field[6] = { p.x, p.y, p.z, p.vx, p.vy, p.vz };
+        const V h2 = S::Load(p.h2);
+        V y0[6], k[6], acc[6], s[6];
+        for (int i = 0; i < 6; ++i) y0[i] = S::Load(field[i]);
+        auto eval = [&](const V* st) {
+            V invR2 = S::Div(one, S::Add(S::Add(S::Mul(st[0], st[0]), S::Mul(st[1], st[1])), S::Mul(st[2], st[2])));
+            V kf    = S::Mul(S::Mul(S::Mul(h2, invR2), S::Mul(krs, S::Sqrt(invR2))), invR2);
+            k[0] = st[3];  k[1] = st[4];  k[2] = st[5];
+            k[3] = S::Mul(kf, st[0]);  k[4] = S::Mul(kf, st[1]);  k[5] = S::Mul(kf, st[2]);
+        };
+        eval(y0);
+        for (int i = 0; i < 6; ++i) acc[i] = k[i];
+        for (int stage = 1; stage < 4; ++stage) {
+            const V h = stage < 3 ? half : full;
+            for (int i = 0; i < 6; ++i) s[i] = S::Add(y0[i], S::Mul(h, k[i]));
+            eval(s);
+            for (int i = 0; i < 6; ++i) acc[i] = S::Add(acc[i], stage < 3 ? S::Mul(two, k[i]) : k[i]);
+        }
+        for (int i = 0; i < 6; ++i) S::Store(field[i], S::Add(y0[i], S::Mul(c, acc[i])));
+    }
+}
+
+#endif // PHYSICS_INTRIN_HPP
@@ -0,0 +1,234 @@
+// predictor.hpp
+// Background trajectory prediction for the N-body simulation.
+//
+// A worker thread integrates a private copy of the body state ahead of the
+// live simulation and samples every body's position into fixed-size ring
+// buffers (one slot per sample, shared head index for all bodies).  The
+// integration uses the same deterministic block-timestep code as the live
+// run, so as long as nothing external touches the bodies the prediction is
+// exact; after a reset the worker just keeps stepping to stay `horizon`
+// frames ahead, overwriting the oldest samples.
+//
+// The render thread never waits on the worker:
+//   - request() hands over a new state with try_lock and reports failure
+//     instead of blocking (the caller retries next frame);
+//   - results are published through a lock-free triple buffer, poll() only
+//     swaps an index.
+// Collisions are not simulated ahead; the caller re-requests after contacts.
+
+#ifndef PREDICTOR_HPP
+#define PREDICTOR_HPP
+
+#include "nbody.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Predicted paths, body-major and oldest sample first:
+// body b owns points [b * capacity, b * capacity + count).
+struct PredictedPaths {
+    uint64_t              fromStep = 0;     // simulation step of the first sample
+    uint32_t              capacity = 0;     // samples per body
+    uint32_t              count    = 0;     // valid samples (same for every body)
+    std::vector<uint32_t> id;               // body ids, as in NBodySystem::id
+    std::vector<float>    xyz;              // bodies × capacity × 3
+};
+
+class TrajectoryPredictor {
+public:
+    // horizonFrames: how far ahead to look; sampleEvery: frames per trail point.
+    TrajectoryPredictor(uint32_t horizonFrames = 2000, uint32_t sampleEvery = 8)
+        : every(std::max(1u, sampleEvery)),
+          horizon(std::max(horizonFrames, std::max(1u, sampleEvery))),
+          capacity(horizon / every + 1) {
+        worker = std::thread([this] { run(); });
+    }
+
+    ~TrajectoryPredictor() {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    TrajectoryPredictor(const TrajectoryPredictor&) = delete;
+    TrajectoryPredictor& operator=(const TrajectoryPredictor&) = delete;
+
+    // Hands over the live state at `step`.  needsInit must be true when the
+    // live stepper is going to re-evaluate forces before its next step
+    // (BlockTimestepper::needsInit()).  Returns false if the worker is busy
+    // taking a previous request — keep the request pending and retry.
+    bool request(const NBodySystem& s, const NBodyParams& p, uint64_t step, bool needsInit) {
+        std::unique_lock<std::mutex> lk(mtx, std::try_to_lock);
+        if (!lk.owns_lock()) return false;
+        pending       = s;
+        pendingParams = p;
+        pendingStep   = step;
+        pendingInit   = needsInit;
+        hasPending    = true;
+        lk.unlock();
+        wake.notify_one();
+        return true;
+    }
+
+    // Tells the worker how far the live simulation has got.
+    void advanceTo(uint64_t step) {
+        liveStep.store(step, std::memory_order_relaxed);
+        wake.notify_one();
+    }
+
+    // Latest complete result, or nullptr when nothing new was published since
+    // the previous call.  The pointer stays valid until the next poll().
+    const PredictedPaths* poll() {
+        if (!(ready.load(std::memory_order_relaxed) & FRESH)) return nullptr;
+        front = ready.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+        return &slots[front];
+    }
+
+    uint32_t horizonFrames() const { return horizon; }
+
+private:
+    static constexpr unsigned FRESH = 4;
+
+    void run() {
+        NBodySystem      state;
+        NBodyParams      params;
+        BlockTimestepper stepper;          // serial: the render thread owns the pool
+        uint64_t         step = 0;
+        bool             active = false;
+
+        std::vector<float>    ring;        // capacity × bodies × 3, slot-major
+        std::vector<uint64_t> ringStep;    // simulation step of each slot
+        uint32_t              head = 0, filled = 0;
+        auto                  lastPublish = std::chrono::steady_clock::now();
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                wake.wait_for(lk, std::chrono::milliseconds(50), [&] {
+                    return stopping || hasPending ||
+                           (active && step < liveStep.load(std::memory_order_relaxed) + horizon);
+                });
+                if (stopping) return;
+                if (hasPending) {
+                    state  = std::move(pending);
+                    params = pendingParams;
+                    step   = pendingStep;
+                    if (pendingInit) stepper.invalidate();
+                    else             stepper.adopt(state);
+                    hasPending = false;
+                    active     = true;
+
+                    ring.assign(size_t(capacity) * state.size() * 3, 0.0f);
+                    ringStep.assign(capacity, 0);
+                    head = filled = 0;
+                    sample(state, step, ring, ringStep, head, filled);
+                }
+            }
+            if (!active) continue;
+
+            // Catch up to liveStep + horizon, bailing out early for a new request.
+            bool dirty = false;
+            while (step < liveStep.load(std::memory_order_relaxed) + horizon) {
+                stepper.step(state, params);
+                ++step;
+                if (step % every == 0) {
+                    sample(state, step, ring, ringStep, head, filled);
+                    dirty = true;
+                }
+                if (hasPendingRelaxed()) break;
+                auto now = std::chrono::steady_clock::now();
+                if (dirty && now - lastPublish > std::chrono::milliseconds(33)) {
+                    publish(state, ring, ringStep, head, filled);
+                    lastPublish = now;
+                    dirty = false;
+                }
+            }
+            if (dirty || filled == 1) {
+                publish(state, ring, ringStep, head, filled);
+                lastPublish = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+    bool hasPendingRelaxed() {
+        std::lock_guard<std::mutex> lk(mtx);
+        return hasPending || stopping;
+    }
+
+    void sample(const NBodySystem& s, uint64_t atStep, std::vector<float>& ring,
+                std::vector<uint64_t>& ringStep, uint32_t& head, uint32_t& filled) {
+        float* dst = ring.data() + size_t(head) * s.size() * 3;
+        for (size_t b = 0; b < s.size(); ++b) {
+            dst[b * 3 + 0] = s.x[b];
+            dst[b * 3 + 1] = s.y[b];
+            dst[b * 3 + 2] = s.z[b];
+        }
+        ringStep[head] = atStep;
+        head = (head + 1) % capacity;
+        filled = std::min(filled + 1, capacity);
+    }
+
+    // Linearises the ring (oldest first, dropping samples the live run has
+    // already passed) into the back buffer and publishes it.
+    void publish(const NBodySystem& s, const std::vector<float>& ring,
+                 const std::vector<uint64_t>& ringStep, uint32_t head, uint32_t filled) {
+        PredictedPaths& out = slots[back];
+        const size_t    n   = s.size();
+        const uint64_t  now = liveStep.load(std::memory_order_relaxed);
+
+        uint32_t first = (head + capacity - filled) % capacity;
+        uint32_t skip  = 0;
+        while (skip + 1 < filled && ringStep[(first + skip + 1) % capacity] <= now) ++skip;
+        first = (first + skip) % capacity;
+
+        out.capacity = capacity;
+        out.count    = filled - skip;
+        out.fromStep = ringStep[first];
+        out.id.assign(s.id.begin(), s.id.end());
+        out.xyz.resize(n * capacity * 3);
+        for (uint32_t k = 0; k < out.count; ++k) {
+            const float* src = ring.data() + size_t((first + k) % capacity) * n * 3;
+            for (size_t b = 0; b < n; ++b) {
+                float* dst = out.xyz.data() + (b * capacity + k) * 3;
+                dst[0] = src[b * 3 + 0];
+                dst[1] = src[b * 3 + 1];
+                dst[2] = src[b * 3 + 2];
+            }
+        }
+        back = ready.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    }
+
+    const uint32_t every;
+    const uint32_t horizon;
+    const uint32_t capacity;
+
+    // Hand-over from the render thread.
+    std::mutex              mtx;
+    std::condition_variable wake;
+    NBodySystem             pending;
+    NBodyParams             pendingParams;
+    uint64_t                pendingStep = 0;
+    bool                    pendingInit = true;
+    bool                    hasPending  = false;
+    bool                    stopping    = false;
+    std::atomic<uint64_t>   liveStep{0};
+
+    // Triple buffer: worker fills `back`, render reads `front`, `ready`
+    // holds the third index plus the FRESH bit.
+    PredictedPaths        slots[3];
+    unsigned              back  = 0;
+    unsigned              front = 1;
+    std::atomic<unsigned> ready{2};
+
+    std::thread worker;
+};
+
+#endif // PREDICTOR_HPP
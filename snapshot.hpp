@@ -0,0 +1,300 @@
+// snapshot.hpp
+// Append-only binary snapshot stream for N-body runs, read back via mmap.
+//
+// Layout (little-endian, native float/double):
+//
+//   SnapshotFileHeader                       64 bytes, once
+//   { SnapshotFrameHeader                    32 bytes
+//     uint32 id[n]
+//     float  x[n] y[n] z[n] vx[n] vy[n] vz[n] mass[n] radius[n]
+//     padding to 8 bytes }*                  one record per snapshot
+//
+// Every record is self-describing (body count and payload size), so the body
+// count may change between snapshots (merges).  The writer flushes after each
+// record; the reader only indexes records that are complete, and refresh()
+// picks up records appended since the last scan, so a run can be inspected
+// while it is still being written.
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "nbody.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static constexpr char     SNAPSHOT_MAGIC[8]    = { 'N','B','S','N','A','P','\0','\1' };
+static constexpr uint32_t SNAPSHOT_VERSION     = 1;
+static constexpr uint32_t SNAPSHOT_FRAME_MAGIC = 0x454D5246u;   // "FRME"
+static constexpr uint32_t SNAPSHOT_ARRAYS      = 9;              // id + 8 float arrays
+
+struct SnapshotFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    float    lengthToSI;      // NBodyParams used for the run
+    float    kickScale;
+    float    driftScale;
+    float    sizeRatio;       // scene radius scale (Gravity_Grid)
+    uint32_t initialBodies;
+    uint32_t snapshotEvery;   // steps between records
+    uint32_t reserved[6];
+};
+static_assert(sizeof(SnapshotFileHeader) == 64, "snapshot header layout");
+
+struct SnapshotFrameHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t step;
+    double   time;            // simulated time, in frames
+    uint64_t payloadBytes;
+};
+static_assert(sizeof(SnapshotFrameHeader) == 32, "snapshot frame layout");
+
+// Read-only SoA view of one snapshot — either into a mapped file or into a
+// live NBodySystem.
+struct SnapshotFrame {
+    uint64_t        step  = 0;
+    double          time  = 0.0;
+    uint32_t        count = 0;
+    const uint32_t* id    = nullptr;
+    const float*    x  = nullptr; const float* y  = nullptr; const float* z  = nullptr;
+    const float*    vx = nullptr; const float* vy = nullptr; const float* vz = nullptr;
+    const float*    mass   = nullptr;
+    const float*    radius = nullptr;
+};
+
+inline SnapshotFrame FrameView(const NBodySystem& s, uint64_t step, double time) {
+    SnapshotFrame f;
+    f.step = step;  f.time = time;  f.count = uint32_t(s.size());
+    f.id = s.id.data();
+    f.x  = s.x.data();  f.y  = s.y.data();  f.z  = s.z.data();
+    f.vx = s.vx.data(); f.vy = s.vy.data(); f.vz = s.vz.data();
+    f.mass = s.mass.data(); f.radius = s.radius.data();
+    return f;
+}
+
+inline uint64_t SnapshotPayloadBytes(uint32_t count) {
+    return (uint64_t(count) * 4u * SNAPSHOT_ARRAYS + 7u) & ~uint64_t(7);
+}
+
+// ─── Writer ──────────────────────────────────────────────────────────────────
+class SnapshotWriter {
+public:
+    ~SnapshotWriter() { close(); }
+
+    bool open(const char* path, const SnapshotFileHeader& meta) {
+        close();
+        file = std::fopen(path, "wb");
+        if (!file) {
+            std::cerr << "[Snapshot] cannot create " << path << std::endl;
+            return false;
+        }
+        SnapshotFileHeader h = meta;
+        std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+        h.version    = SNAPSHOT_VERSION;
+        h.headerSize = sizeof(SnapshotFileHeader);
+        return write(&h, sizeof(h)) && flush();
+    }
+
+    bool append(const SnapshotFrame& f) {
+        if (!file) return false;
+        SnapshotFrameHeader h;
+        h.magic        = SNAPSHOT_FRAME_MAGIC;
+        h.count        = f.count;
+        h.step         = f.step;
+        h.time         = f.time;
+        h.payloadBytes = SnapshotPayloadBytes(f.count);
+
+        const size_t n = f.count;
+        const void* arrays[SNAPSHOT_ARRAYS] = { f.id, f.x, f.y, f.z, f.vx, f.vy, f.vz, f.mass, f.radius };
+        bool ok = write(&h, sizeof(h));
+        for (const void* a : arrays) ok = ok && write(a, n * 4);
+        static const uint8_t pad[8] = {};
+        ok = ok && write(pad, size_t(h.payloadBytes - n * 4 * SNAPSHOT_ARRAYS));
+        bytes += sizeof(h) + h.payloadBytes;
+        return ok && flush();   // readers never see half a record header
+    }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = nullptr;
+    }
+
+    uint64_t bytesWritten() const { return bytes; }
+
+private:
+    bool write(const void* p, size_t n) {
+        if (n == 0 || std::fwrite(p, 1, n, file) == n) return true;
+        std::cerr << "[Snapshot] write failed (disk full?)" << std::endl;
+        return false;
+    }
+    bool flush() { return std::fflush(file) == 0; }
+
+    FILE*    file  = nullptr;
+    uint64_t bytes = 0;
+};
+
+// ─── Reader ──────────────────────────────────────────────────────────────────
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+    ~SnapshotReader() { unmap(); }
+
+    bool open(const char* path) {
+        unmap();
+        filePath = path;
+        offsets.clear();
+        scanPos = sizeof(SnapshotFileHeader);
+        if (!map()) return false;
+        if (size < sizeof(SnapshotFileHeader) ||
+            std::memcmp(base, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+            std::cerr << "[Snapshot] " << path << " is not a snapshot file" << std::endl;
+            unmap();
+            return false;
+        }
+        std::memcpy(&meta, base, sizeof(meta));
+        if (meta.version != SNAPSHOT_VERSION) {
+            std::cerr << "[Snapshot] unsupported version " << meta.version << std::endl;
+            unmap();
+            return false;
+        }
+        scanPos = meta.headerSize;
+        scan();
+        return true;
+    }
+
+    // Re-maps the file if it grew and indexes the new complete records.
+    // Returns true when new frames became available.
+    bool refresh() {
+        if (!base) return false;
+        size_t before = offsets.size();
+#ifndef _WIN32
+        struct stat st;
+        if (::stat(filePath.c_str(), &st) == 0 && size_t(st.st_size) > size) {
+            unmap();
+            if (!map()) return false;
+        }
+#endif
+        scan();
+        return offsets.size() > before;
+    }
+
+    size_t                    frameCount() const { return offsets.size(); }
+    const SnapshotFileHeader& header()     const { return meta; }
+
+    SnapshotFrame frame(size_t i) const {
+        const uint8_t* p = base + offsets[i];
+        SnapshotFrameHeader h;
+        std::memcpy(&h, p, sizeof(h));
+        const uint8_t* d = p + sizeof(h);
+        const size_t   a = size_t(h.count) * 4;
+
+        SnapshotFrame f;
+        f.step = h.step;  f.time = h.time;  f.count = h.count;
+        f.id   = reinterpret_cast<const uint32_t*>(d);
+        f.x    = reinterpret_cast<const float*>(d + 1 * a);
+        f.y    = reinterpret_cast<const float*>(d + 2 * a);
+        f.z    = reinterpret_cast<const float*>(d + 3 * a);
+        f.vx   = reinterpret_cast<const float*>(d + 4 * a);
+        f.vy   = reinterpret_cast<const float*>(d + 5 * a);
+        f.vz   = reinterpret_cast<const float*>(d + 6 * a);
+        f.mass   = reinterpret_cast<const float*>(d + 7 * a);
+        f.radius = reinterpret_cast<const float*>(d + 8 * a);
+        return f;
+    }
+
+private:
+    // Walks the records after scanPos; stops at the first incomplete one.
+    void scan() {
+        while (scanPos + sizeof(SnapshotFrameHeader) <= size) {
+            SnapshotFrameHeader h;
+            std::memcpy(&h, base + scanPos, sizeof(h));
+            if (h.magic != SNAPSHOT_FRAME_MAGIC ||
+                h.payloadBytes != SnapshotPayloadBytes(h.count))
+                break;
+            size_t end = scanPos + sizeof(h) + size_t(h.payloadBytes);
+            if (end > size) break;
+            offsets.push_back(scanPos);
+            scanPos = end;
+        }
+    }
+
+#ifndef _WIN32
+    bool map() {
+        // stdio + fileno rather than open()/close(): <unistd.h> would drag
+        // pause() etc. into every includer's global namespace.
+        FILE* f = std::fopen(filePath.c_str(), "rb");
+        if (!f) {
+            std::cerr << "[Snapshot] cannot open " << filePath << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fileno(f), &st) != 0 || st.st_size == 0) {
+            std::fclose(f);
+            std::cerr << "[Snapshot] " << filePath << " is empty" << std::endl;
+            return false;
+        }
+        size = size_t(st.st_size);
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fileno(f), 0);
+        std::fclose(f);   // the mapping keeps the file referenced
+        if (p == MAP_FAILED) {
+            std::cerr << "[Snapshot] mmap failed for " << filePath << std::endl;
+            size = 0;
+            return false;
+        }
+        base = static_cast<const uint8_t*>(p);
+        return true;
+    }
+
+    void unmap() {
+        if (base) ::munmap(const_cast<uint8_t*>(base), size);
+        base = nullptr;
+        size = 0;
+    }
+#else
+    // No mmap on Windows builds: read the file once into memory.
+    bool map() {
+        FILE* f = std::fopen(filePath.c_str(), "rb");
+        if (!f) {
+            std::cerr << "[Snapshot] cannot open " << filePath << std::endl;
+            return false;
+        }
+        std::fseek(f, 0, SEEK_END);
+        buffer.resize(size_t(std::ftell(f)));
+        std::fseek(f, 0, SEEK_SET);
+        size = std::fread(buffer.data(), 1, buffer.size(), f);
+        std::fclose(f);
+        base = buffer.data();
+        return size > 0;
+    }
+
+    void unmap() {
+        buffer.clear();
+        base = nullptr;
+        size = 0;
+    }
+
+    std::vector<uint8_t> buffer;
+#endif
+
+    std::string         filePath;
+    const uint8_t*      base    = nullptr;
+    size_t              size    = 0;
+    size_t              scanPos = 0;
+    std::vector<size_t> offsets;
+    SnapshotFileHeader  meta    = {};
+};
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,167 @@
+// space_scene.hpp
+// Scene, camera and N-body state shared by the 3-D ray tracers
+// (BlackHole_space and BlackHole_space_cpu).
+//
+// Sagittarius A*, two stars and an optional shell of massless background
+// stars.  The programs differ only in the Tracer backend (tracer.hpp) and in
+// what they draw around its frame: frame() and policy() turn the scene and
+// the camera into the CpuTracer::Frame and TracePolicy every backend renders.
+//
+// Keys: G gravity, I integrator (spherical RK4 / trig-free Cartesian),
+// D accretion disk, O objects.
+
+#ifndef SPACE_SCENE_HPP
+#define SPACE_SCENE_HPP
+
+#include "common.hpp"
+#include "cpu_tracer.hpp"
+#include "nbody.hpp"
+#include "thread_pool.hpp"
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Orbit camera around the hole, at the scale of the scene (metres)
+struct SpaceCamera : public OrbitCamera {
+    SpaceCamera() : OrbitCamera(vec3(0.0f), 6.34194e10f, 1e10f, 1e12f, 60.0f) {
+        elevation  = float(M_PI) / 2.0f;
+        orbitSpeed = 0.01f;
+        zoomSpeed  = 25e9f;
+    }
+};
+
+struct SpaceObject {
+    vec4  posRadius;               // centre xyz, radius w
+    vec4  color;
+    float mass;                    // 0: background star, no gravity and no grid
+    vec3  velocity = vec3(0.0f);
+};
+
+class SpaceScene {
+public:
+    static constexpr float RS       = 1.269e10f;   // rs of the tracers' step and horizon
+    static constexpr float D_LAMBDA = 1e7f;
+    static constexpr float ESCAPE_R = 1e30f;
+    static constexpr double SAGA_MASS = 8.54e36;
+
+    const double sagARs = PhysicsUtils::CalculateSchwarzschildRadius(SAGA_MASS);
+
+    // The N-body bodies come first; background stars follow and never move
+    std::vector<SpaceObject> objects = {
+        { vec4(4e11f, 0.0f, 0.0f, 4e10f), vec4(1, 1, 0, 1), 1.98892e30f },              // yellow star
+        { vec4(0.0f, 0.0f, 4e11f, 4e10f), vec4(1, 0, 0, 1), 1.98892e30f },              // red star
+        { vec4(0.0f, 0.0f, 0.0f, float(sagARs)), vec4(0, 0, 0, 1), float(SAGA_MASS) },  // Sgr A* itself
+    };
+
+    bool gravity     = false;
+    bool cartesian   = false;
+    bool disk        = true;
+    bool showObjects = true;
+
+    uint64_t   version = 1;   // bumped whenever `objects` changes
+    ThreadPool pool;          // N-body forces, free for the programs' own loops in between
+
+    SpaceScene() {
+        siParams.lengthToSI = 1.0f;
+        siParams.kickScale  = 1.0f;
+        siParams.driftScale = 1.0f;
+        for (const auto& o : objects)
+            bodies.add(o.posRadius.x, o.posRadius.y, o.posRadius.z,
+                       o.velocity.x, o.velocity.y, o.velocity.z, o.mass, 0.0f, o.posRadius.w);
+    }
+
+    // Massless spheres on a shell from 8e11 to 3e12 m, uniform directions
+    void addStarField(int count) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (int i = 0; i < count; ++i) {
+            float r = 8e11f + 2.2e12f * unit(rng);
+            float z = 2.0f * unit(rng) - 1.0f;
+            float a = 2.0f * float(M_PI) * unit(rng);
+            float s = std::sqrt(1.0f - z * z);
+            vec3  p = r * vec3(s * std::cos(a), z, s * std::sin(a));
+            float t = unit(rng);   // red to blue-white
+            vec4  color = vec4(1.0f, 0.6f + 0.4f * t, 0.4f + 0.6f * t, 1.0f);
+            objects.push_back({ vec4(p, 5e9f + 1.5e10f * unit(rng)), color, 0.0f });
+        }
+        ++version;
+    }
+
+    // Forces are split over the pool in fixed chunks, so trajectories are
+    // bitwise identical for any thread count
+    void step(float dt) {
+        if (!gravity) return;
+        StepUniform(bodies, siParams, dt, forceTargets, &pool);
+        for (size_t i = 0; i < std::min(objects.size(), bodies.size()); ++i) {
+            objects[i].posRadius.x = bodies.x[i];
+            objects[i].posRadius.y = bodies.y[i];
+            objects[i].posRadius.z = bodies.z[i];
+            objects[i].velocity    = vec3(bodies.vx[i], bodies.vy[i], bodies.vz[i]);
+        }
+        ++version;
+    }
+
+    void processKey(int key, int action) {
+        if (action != GLFW_PRESS) return;
+        if (key == GLFW_KEY_G) {
+            gravity = !gravity;
+            std::cout << "[Scene] Gravity " << (gravity ? "ON" : "OFF") << "\n";
+        } else if (key == GLFW_KEY_I) {
+            cartesian = !cartesian;
+            std::cout << "[Scene] Integrator: " << (cartesian ? "Cartesian (trig-free)" : "spherical RK4") << "\n";
+        } else if (key == GLFW_KEY_D) {
+            disk = !disk;
+            std::cout << "[Scene] Disk " << (disk ? "ON" : "OFF") << "\n";
+        } else if (key == GLFW_KEY_O) {
+            showObjects = !showObjects;
+            std::cout << "[Scene] Objects " << (showObjects ? "ON" : "OFF") << "\n";
+        }
+    }
+
+    // Camera and scene as every tracer backend reads them; size and rgba are left to the caller
+    CpuTracer::Frame frame(const OrbitCamera& cam, float aspect) {
+        if (spheresVersion != version) {
+            spheres.clear();
+            for (const auto& o : objects)
+                spheres.push_back({ o.posRadius.x, o.posRadius.y, o.posRadius.z, o.posRadius.w,
+                                    o.color.r, o.color.g, o.color.b, o.color.a });
+            spheresVersion = version;
+        }
+
+        vec3 camPos = cam.position();
+        CpuTracer::Frame f;
+        CpuTracer::LookAt(f, &camPos.x, &cam.target.x, cam.fov, aspect);
+        f.rs             = RS;
+        f.diskR1         = float(sagARs * 2.2);
+        f.diskR2         = float(sagARs * 5.2);
+        f.escapeR        = ESCAPE_R;
+        f.dLambda        = D_LAMBDA;
+        f.objects        = spheres.data();
+        f.objectCount    = int(spheres.size());
+        f.objectsVersion = version;
+        return f;
+    }
+
+    // Integrator, disk and objects are fixed for the frame: the tracer picks the
+    // kernel built for them once, instead of testing them at every step
+    TracePolicy policy() const {
+        TracePolicy p;
+        p.integrator = cartesian ? CpuTracer::Integrator::Cartesian : CpuTracer::Integrator::Spherical;
+        p.disk       = disk;
+        p.objects    = showObjects && !objects.empty();
+        return p;
+    }
+
+private:
+    NBodySystem                    bodies;
+    NBodyParams                    siParams;
+    std::vector<uint32_t>          forceTargets;
+    std::vector<CpuTracer::Sphere> spheres;          // `objects` as the kernels read them
+    uint64_t                       spheresVersion = 0;
+};
+
+#endif // SPACE_SCENE_HPP
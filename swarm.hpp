@@ -0,0 +1,246 @@
+// swarm.hpp
+// Massless test particles orbiting a fixed central mass.
+//
+// Particles feel only the central attraction, so a step is O(N) and every
+// particle is independent: SoA arrays, 4 particles per SIMD iteration (SSE on
+// x86-64, NEON on ARM64, scalar elsewhere), fixed-size chunks on the
+// ThreadPool.  The step can write the render data — (x, y, z, speed) per
+// particle — straight into a mapped GL buffer, so positions are streamed
+// without an extra pass over memory.
+//
+// Integration matches the N-body code (nbody.hpp): one frame applies
+// v += a·kick, then x += v·drift.  Particles that fall inside the capture
+// radius are re-injected at the outer edge of the disk, keeping the
+// accretion flow going.
+
+#ifndef SWARM_HPP
+#define SWARM_HPP
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define SWARM_SSE 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SWARM_NEON 1
+#endif
+
+struct SwarmConfig {
+    float mu        = 1.0f;      // G·M of the central mass, scene units (length²·accel)
+    float kick      = 1.0f;      // Δv per unit acceleration per frame
+    float drift     = 1.0f;      // Δx per unit velocity per frame
+    float softening = 0.0f;      // ε, scene units
+    float capture   = 0.0f;      // particles inside this radius are re-injected
+    float rIn       = 1.0f;      // initial disk, scene units
+    float rOut      = 2.0f;
+    float thickness = 0.0f;      // half-height of the disk
+    float dispersion = 0.05f;    // relative random velocity
+};
+
+class ParticleSwarm {
+public:
+    static constexpr size_t CHUNK = 16384;
+
+    std::vector<float> x, y, z, vx, vy, vz;
+
+    size_t size() const { return x.size(); }
+
+    // Fills a thin disk with n particles on near-circular orbits.
+    void seed(size_t n, const SwarmConfig& c, uint32_t seedValue = 1) {
+        cfg  = c;
+        salt = seedValue;
+        for (auto* v : { &x, &y, &z, &vx, &vy, &vz }) v->resize(n);
+        for (size_t i = 0; i < n; ++i) spawn(i, cfg.rIn, cfg.rOut, 0);
+        // Speed normalisation for colouring: circular speed at the inner edge.
+        vRef = circularSpeed(cfg.rIn);
+    }
+
+    // Advances every particle by one frame.  If `out` is not null it receives
+    // size() × (x, y, z, |v|/vRef) floats.  Returns the number of particles
+    // captured (and re-injected) during this step.
+    size_t step(ThreadPool& pool, float* out) {
+        ++frame;
+        if (captured.size() < pool.size()) captured.resize(pool.size());
+        for (auto& c : captured) c.n = 0;
+        pool.parallelFor(size(), CHUNK, [&](size_t b, size_t e, unsigned w) {
+            captured[w].n += stepRange(b, e, out);
+        });
+        size_t total = 0;
+        for (const auto& c : captured) total += c.n;
+        return total;
+    }
+
+private:
+    // ─── Kernel ──────────────────────────────────────────────────────────────
+    size_t stepRange(size_t b, size_t e, float* out) {
+        const float k     = -cfg.mu * cfg.kick;
+        const float eps2  = cfg.softening * cfg.softening;
+        const float cap2  = cfg.capture * cfg.capture;
+        const float invV  = vRef > 0.0f ? 1.0f / vRef : 0.0f;
+        size_t      nCap  = 0;
+        size_t      i     = b;
+
+#if SWARM_SSE
+        const __m128 vk    = _mm_set1_ps(k);
+        const __m128 vEps2 = _mm_set1_ps(eps2);
+        const __m128 vCap2 = _mm_set1_ps(cap2);
+        const __m128 vDrft = _mm_set1_ps(cfg.drift);
+        const __m128 vInvV = _mm_set1_ps(invV);
+        const __m128 half  = _mm_set1_ps(0.5f);
+        const __m128 three = _mm_set1_ps(3.0f);
+        for (; i + 4 <= e; i += 4) {
+            __m128 px = _mm_loadu_ps(&x[i]),  py = _mm_loadu_ps(&y[i]),  pz = _mm_loadu_ps(&z[i]);
+            __m128 qx = _mm_loadu_ps(&vx[i]), qy = _mm_loadu_ps(&vy[i]), qz = _mm_loadu_ps(&vz[i]);
+
+            __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)),
+                                   _mm_add_ps(_mm_mul_ps(pz, pz), vEps2));
+            // rsqrt (12 bits) + one Newton step: inv = inv·(3 − r²·inv²)/2
+            __m128 inv = _mm_rsqrt_ps(r2);
+            inv = _mm_mul_ps(_mm_mul_ps(half, inv),
+                             _mm_sub_ps(three, _mm_mul_ps(r2, _mm_mul_ps(inv, inv))));
+            __m128 f = _mm_mul_ps(vk, _mm_mul_ps(inv, _mm_mul_ps(inv, inv)));
+
+            qx = _mm_add_ps(qx, _mm_mul_ps(f, px));
+            qy = _mm_add_ps(qy, _mm_mul_ps(f, py));
+            qz = _mm_add_ps(qz, _mm_mul_ps(f, pz));
+            px = _mm_add_ps(px, _mm_mul_ps(qx, vDrft));
+            py = _mm_add_ps(py, _mm_mul_ps(qy, vDrft));
+            pz = _mm_add_ps(pz, _mm_mul_ps(qz, vDrft));
+
+            _mm_storeu_ps(&x[i], px);  _mm_storeu_ps(&y[i], py);  _mm_storeu_ps(&z[i], pz);
+            _mm_storeu_ps(&vx[i], qx); _mm_storeu_ps(&vy[i], qy); _mm_storeu_ps(&vz[i], qz);
+
+            if (out) {
+                __m128 s = _mm_mul_ps(vInvV, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx),
+                                                                               _mm_mul_ps(qy, qy)),
+                                                                    _mm_mul_ps(qz, qz))));
+                _MM_TRANSPOSE4_PS(px, py, pz, s);   // SoA → 4 × (x, y, z, speed)
+                _mm_storeu_ps(out + (i + 0) * 4, px);
+                _mm_storeu_ps(out + (i + 1) * 4, py);
+                _mm_storeu_ps(out + (i + 2) * 4, pz);
+                _mm_storeu_ps(out + (i + 3) * 4, s);
+            }
+
+            if (int m = _mm_movemask_ps(_mm_cmplt_ps(r2, vCap2))) {
+                for (int l = 0; l < 4; ++l)
+                    if (m & (1 << l)) { capture(i + l, out, invV); ++nCap; }
+            }
+        }
+#elif SWARM_NEON
+        const float32x4_t vk    = vdupq_n_f32(k);
+        const float32x4_t vEps2 = vdupq_n_f32(eps2);
+        const float32x4_t vCap2 = vdupq_n_f32(cap2);
+        const float32x4_t vDrft = vdupq_n_f32(cfg.drift);
+        const float32x4_t vInvV = vdupq_n_f32(invV);
+        for (; i + 4 <= e; i += 4) {
+            float32x4_t px = vld1q_f32(&x[i]),  py = vld1q_f32(&y[i]),  pz = vld1q_f32(&z[i]);
+            float32x4_t qx = vld1q_f32(&vx[i]), qy = vld1q_f32(&vy[i]), qz = vld1q_f32(&vz[i]);
+
+            float32x4_t r2 = vfmaq_f32(vfmaq_f32(vfmaq_f32(vEps2, px, px), py, py), pz, pz);
+            // vrsqrte (8 bits) + two Newton steps
+            float32x4_t inv = vrsqrteq_f32(r2);
+            inv = vmulq_f32(inv, vrsqrtsq_f32(vmulq_f32(r2, inv), inv));
+            inv = vmulq_f32(inv, vrsqrtsq_f32(vmulq_f32(r2, inv), inv));
+            float32x4_t f = vmulq_f32(vk, vmulq_f32(inv, vmulq_f32(inv, inv)));
+
+            qx = vfmaq_f32(qx, f, px);  qy = vfmaq_f32(qy, f, py);  qz = vfmaq_f32(qz, f, pz);
+            px = vfmaq_f32(px, qx, vDrft);  py = vfmaq_f32(py, qy, vDrft);  pz = vfmaq_f32(pz, qz, vDrft);
+
+            vst1q_f32(&x[i], px);  vst1q_f32(&y[i], py);  vst1q_f32(&z[i], pz);
+            vst1q_f32(&vx[i], qx); vst1q_f32(&vy[i], qy); vst1q_f32(&vz[i], qz);
+
+            if (out) {
+                float32x4x4_t o;
+                o.val[0] = px;  o.val[1] = py;  o.val[2] = pz;
+                o.val[3] = vmulq_f32(vInvV, vsqrtq_f32(vfmaq_f32(vfmaq_f32(vmulq_f32(qx, qx), qy, qy), qz, qz)));
+                vst4q_f32(out + i * 4, o);   // interleaving store: SoA → (x, y, z, speed)
+            }
+
+            uint32x4_t m = vcltq_f32(r2, vCap2);
+            if (vmaxvq_u32(m)) {
+                uint32_t lanes[4];
+                vst1q_u32(lanes, m);
+                for (int l = 0; l < 4; ++l)
+                    if (lanes[l]) { capture(i + l, out, invV); ++nCap; }
+            }
+        }
+#endif
+        // Scalar tail (and the whole range without SIMD).
+        for (; i < e; ++i) {
+            float r2  = x[i]*x[i] + y[i]*y[i] + z[i]*z[i] + eps2;
+            float inv = 1.0f / std::sqrt(r2);
+            float f   = k * inv * inv * inv;
+            vx[i] += f * x[i];  vy[i] += f * y[i];  vz[i] += f * z[i];
+            x[i]  += vx[i] * cfg.drift;  y[i] += vy[i] * cfg.drift;  z[i] += vz[i] * cfg.drift;
+            if (out) writeOut(i, out, invV);
+            if (r2 < cap2) { capture(i, out, invV); ++nCap; }
+        }
+        return nCap;
+    }
+
+    void writeOut(size_t i, float* out, float invV) const {
+        float* o = out + i * 4;
+        o[0] = x[i];  o[1] = y[i];  o[2] = z[i];
+        o[3] = std::sqrt(vx[i]*vx[i] + vy[i]*vy[i] + vz[i]*vz[i]) * invV;
+    }
+
+    void capture(size_t i, float* out, float invV) {
+        spawn(i, cfg.rOut * 0.9f, cfg.rOut, frame);
+        if (out) writeOut(i, out, invV);
+    }
+
+    // ─── Seeding ─────────────────────────────────────────────────────────────
+    float circularSpeed(float r) const {
+        // Per frame the position moves by v·drift while v gains a·kick, so the
+        // circular orbit needs (v·drift)²/r = (mu/r²)·kick·drift
+        //   →  v = sqrt(mu·kick / (r·drift))
+        return std::sqrt(cfg.mu * cfg.kick / (r * cfg.drift));
+    }
+
+    // Deterministic per-(particle, frame) random numbers, so re-injection does
+    // not depend on which thread handles the particle.
+    static uint64_t mix(uint64_t v) {
+        v += 0x9E3779B97F4A7C15ull;
+        v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ull;
+        v = (v ^ (v >> 27)) * 0x94D049BB133111EBull;
+        return v ^ (v >> 31);
+    }
+    static float unit(uint64_t& state) {
+        state = mix(state);
+        return float(state >> 40) * (1.0f / 16777216.0f);
+    }
+
+    void spawn(size_t i, float r0, float r1, uint64_t when) {
+        uint64_t st  = (uint64_t(i) << 20) ^ (when * 0x100000001B3ull) ^ salt;
+        float    u   = unit(st);
+        float    r   = std::sqrt(r0 * r0 + u * (r1 * r1 - r0 * r0));   // uniform in area
+        float    ang = unit(st) * 6.28318530718f;
+        float    c = std::cos(ang), s = std::sin(ang);
+        float    v = circularSpeed(r);
+        float    d = cfg.dispersion * v;
+
+        x[i]  = r * c;
+        y[i]  = (unit(st) * 2.0f - 1.0f) * cfg.thickness;
+        z[i]  = r * s;
+        vx[i] = -s * v + (unit(st) * 2.0f - 1.0f) * d;
+        vy[i] =          (unit(st) * 2.0f - 1.0f) * d * 0.2f;
+        vz[i] =  c * v + (unit(st) * 2.0f - 1.0f) * d;
+    }
+
+    struct alignas(64) Counter { size_t n = 0; };   // one cache line per worker
+
+    SwarmConfig          cfg;
+    float                vRef  = 1.0f;
+    uint64_t             frame = 0;
+    uint64_t             salt  = 1;
+    std::vector<Counter> captured;
+};
+
+#endif // SWARM_HPP
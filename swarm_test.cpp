@@ -0,0 +1,76 @@
+// swarm_test.cpp
+// Checks of ParticleSwarm, run by ctest: a particle seeded with no velocity
+// dispersion sits on a circular orbit and keeps its radius, with the scene
+// values Gravity_Grid uses for --swarm.
+//
+// Build target: Swarm_Test
+
+#include "swarm.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                          \
+        }                                                                        \
+    } while (0)
+
+// MakeSwarmConfig() in gravity_grid.cpp, without the disk thickness and the
+// random velocities
+static SwarmConfig CircularConfig(float r) {
+    SwarmConfig c;
+    c.mu         = 6.67430e-11f * 4.0e26f / (1000.0f * 1000.0f);
+    c.kick       = 1.0f / 96.0f;
+    c.drift      = 1.0f / 94.0f;
+    c.softening  = 0.0f;
+    c.capture    = 100.0f;
+    c.rIn        = r;
+    c.rOut       = r;
+    c.thickness  = 0.0f;
+    c.dispersion = 0.0f;
+    return c;
+}
+
+static float Radius(const ParticleSwarm& s, size_t i) {
+    return std::sqrt(s.x[i] * s.x[i] + s.y[i] * s.y[i] + s.z[i] * s.z[i]);
+}
+
+// About nine orbits at the inner disk radius, one at the outer: the radius must stay
+// within 2 % of the seeded one, and nothing may be captured.
+static void TestCircularOrbit(float r0, int frames) {
+    ThreadPool    pool(1);
+    ParticleSwarm swarm;
+    swarm.seed(8, CircularConfig(r0));
+
+    float rMin = r0, rMax = r0;
+    size_t captured = 0;
+    for (int f = 0; f < frames; ++f) {
+        captured += swarm.step(pool, nullptr);
+        for (size_t i = 0; i < swarm.size(); ++i) {
+            rMin = std::min(rMin, Radius(swarm, i));
+            rMax = std::max(rMax, Radius(swarm, i));
+        }
+    }
+    CHECK(captured == 0);
+    CHECK(rMin > 0.98f * r0);
+    CHECK(rMax < 1.02f * r0);
+    if (failures) std::fprintf(stderr, "r0 = %g: radius in [%g, %g]\n", r0, rMin, rMax);
+}
+
+int main() {
+    TestCircularOrbit(2500.0f, 4000);
+    TestCircularOrbit(16000.0f, 8000);
+
+    if (failures) {
+        std::fprintf(stderr, "swarm: %d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("swarm: all checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+// thread_pool.hpp
+// Persistent worker pool for the CPU-side simulation loops.
+//
+// Workers are spawned once and parked on a condition variable; each
+// parallelFor() call hands them a type-erased job without allocating.
+// Work is split into fixed-size chunks whose boundaries depend only on
+// (count, chunk) — never on the number of threads — so any kernel that
+// writes per-index results is bitwise reproducible for every pool size.
+//
+// The calling thread participates as worker 0.  parallelFor() must not be
+// called re-entrantly from inside a job.
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+public:
+    // numThreads == 0 → one thread per hardware core.
+    explicit ThreadPool(unsigned numThreads = 0) {
+        if (numThreads == 0)
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        workers.reserve(numThreads - 1);
+        for (unsigned id = 1; id < numThreads; ++id)
+            workers.emplace_back([this, id] { workerLoop(id); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+            ++generation;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Total number of threads that execute jobs (workers + caller).
+    unsigned size() const { return unsigned(workers.size()) + 1; }
+
+    // Calls fn(begin, end, worker) for every chunk [begin, end) of [0, count).
+    // `worker` is in [0, size()) and may be used to index per-thread scratch.
+    template <class F>
+    void parallelFor(size_t count, size_t chunk, F&& fn) {
+        if (count == 0) return;
+        chunk = std::max<size_t>(1, chunk);
+        size_t numChunks = (count + chunk - 1) / chunk;
+
+        using Fn = std::remove_reference_t<F>;
+        if (numChunks == 1 || workers.empty()) {
+            for (size_t c = 0; c < numChunks; ++c)
+                fn(c * chunk, std::min(count, (c + 1) * chunk), 0u);
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            idle.wait(lk, [&] { return active == 0; });
+            job.invoke = [](void* ctx, size_t b, size_t e, unsigned w) {
+                (*static_cast<Fn*>(ctx))(b, e, w);
+            };
+            job.ctx       = const_cast<void*>(static_cast<const void*>(std::addressof(fn)));
+            job.count     = count;
+            job.chunk     = chunk;
+            job.numChunks = numChunks;
+            nextChunk.store(0, std::memory_order_relaxed);
+            pending.store(numChunks, std::memory_order_relaxed);
+            ++generation;
+        }
+        wake.notify_all();
+
+        runChunks(0);
+
+        std::unique_lock<std::mutex> lk(mtx);
+        idle.wait(lk, [&] {
+            return pending.load(std::memory_order_acquire) == 0 && active == 0;
+        });
+    }
+
+private:
+    struct Job {
+        void (*invoke)(void*, size_t, size_t, unsigned) = nullptr;
+        void*  ctx       = nullptr;
+        size_t count     = 0;
+        size_t chunk     = 1;
+        size_t numChunks = 0;
+    };
+
+    void workerLoop(unsigned id) {
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                wake.wait(lk, [&] { return generation != seen; });
+                seen = generation;
+                if (stopping) return;
+                ++active;
+            }
+            runChunks(id);
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                --active;
+            }
+            idle.notify_all();
+        }
+    }
+
+    void runChunks(unsigned id) {
+        for (;;) {
+            size_t c = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (c >= job.numChunks) break;
+            size_t b = c * job.chunk;
+            size_t e = std::min(job.count, b + job.chunk);
+            job.invoke(job.ctx, b, e, id);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lk(mtx);
+                idle.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex               mtx;
+    std::condition_variable  wake;
+    std::condition_variable  idle;
+    size_t                   generation = 0;
+    unsigned                 active     = 0;
+    bool                     stopping   = false;
+
+    Job                      job;
+    std::atomic<size_t>      nextChunk{0};
+    std::atomic<size_t>      pending{0};
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,366 @@
+// tracer.hpp
+// Interchangeable ray-tracing backends for the 3-D black hole programs.
+//
+// Every backend renders the same CpuTracer::Frame (camera basis, scene and
+// RGBA8 target) with the same kernel policies.  The CPU ones differ only in
+// how the pixels are stepped and spread over the cores; GlCompute runs the
+// GLSL compute shaders.  The backends are rows of a table (name, availability
+// test, factory), like the instruction-set table of PhysicsASM::Batch().  At
+// startup Calibrate() renders a short frame with each available backend and
+// measures rays/s; the fastest one is used unless --tracer names another.
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include "common.hpp"
+#include "cpu_tracer.hpp"
+#include "object_grid.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Kernel policies, fixed for a frame
+struct TracePolicy {
+    CpuTracer::Integrator integrator = CpuTracer::Integrator::Spherical;
+    bool disk = true;
+    bool objects = true;
+};
+
+class Tracer {
+public:
+    virtual ~Tracer() = default;
+
+    // Renders every pixel of the frame; returns the name of the kernel used.
+    // A backend with a texture() may be given a frame without rgba.
+    virtual const char* render(const CpuTracer::Frame& frame, const TracePolicy& policy) = 0;
+
+    // Threads working on a frame, for the console
+    virtual unsigned threads() const { return 1; }
+
+    // GL texture the last frame was rendered into, or 0 if only rgba holds it
+    virtual GLuint texture() const { return 0; }
+};
+
+struct TracerBackend {
+    const char* name;
+    const char* description;
+    bool (*available)();
+    std::unique_ptr<Tracer> (*create)();
+};
+
+namespace TracerBackends {
+
+// One thread, every lane stepped through the plain C++ RK4 (PhysicsASM::*Reference)
+class Scalar : public Tracer {
+public:
+    const char* render(const CpuTracer::Frame& f, const TracePolicy& p) override {
+        const auto& v = CpuTracer::Select(p.integrator, p.disk, p.objects, false);
+        v.trace(f, 0, f.height);
+        return v.name;
+    }
+};
+
+// One thread, four rays per PhysicsASM packet step
+class Simd : public Tracer {
+public:
+    const char* render(const CpuTracer::Frame& f, const TracePolicy& p) override {
+        const auto& v = CpuTracer::Select(p.integrator, p.disk, p.objects);
+        v.trace(f, 0, f.height);
+        return v.name;
+    }
+};
+
+// Packet steps on every core.  Rows go out in small chunks: a row through the
+// shadow finishes long before one that escapes, so fixed bands would idle.
+class Threaded : public Tracer {
+public:
+    static constexpr int ROWS_PER_CHUNK = 2;
+
+    const char* render(const CpuTracer::Frame& f, const TracePolicy& p) override {
+        const auto& v = CpuTracer::Select(p.integrator, p.disk, p.objects);
+        pool.parallelFor(size_t(f.height), ROWS_PER_CHUNK, [&](size_t yS, size_t yE, unsigned) {
+            v.trace(f, int(yS), int(yE));
+        });
+        return v.name;
+    }
+    unsigned threads() const override { return pool.size(); }
+
+private:
+    ThreadPool pool;
+};
+
+// One GPU invocation per pixel (geodesic.comp, needs a current GL 4.3
+// context).  geodesic_tiles.comp first writes the 16×16 tiles whose rays
+// provably all escape or all fall in, then geodesic.comp integrates the mixed
+// ones through an indirect dispatch; the tile test follows the spherical step,
+// so with the Cartesian integrator every tile is integrated.  The frame lands
+// in texture(), and is read back into rgba only when the frame has one.
+class GlCompute : public Tracer {
+public:
+    static bool Available() { return GLEW_VERSION_4_3; }
+
+    GlCompute() {
+        integrateProgram.reset(ShaderUtils::LoadComputeShader("geodesic.comp"));
+        tileProgram.reset(ShaderUtils::LoadComputeShader("geodesic_tiles.comp"));
+        shadowBlockedLoc = tileProgram.uniform("shadowBlocked");
+        glGenBuffers(1, &tileBuffer);
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // Camera (binding 1) and scene (2) UBOs, objects and their grid (3, 4, 5) in SSBOs
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlign);
+        uboStream.create(4096);
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssboAlign);
+        objectStream.create(64 * 1024);
+    }
+
+    ~GlCompute() override {
+        glDeleteBuffers(1, &tileBuffer);
+        glDeleteTextures(1, &tex);
+    }
+
+    // Times the two passes as these stages of the caller's GpuTimer
+    void setTimer(GpuTimer* t, int tilesStage, int integrateStage) {
+        timer = t;
+        timerTiles = tilesStage;
+        timerIntegrate = integrateStage;
+    }
+
+    const char* render(const CpuTracer::Frame& f, const TracePolicy& p) override {
+        const bool cartesian = p.integrator == CpuTracer::Integrator::Cartesian;
+        const GLuint groupsX = GLuint(f.width + 15) / 16, groupsY = GLuint(f.height + 15) / 16;
+
+        // The texture and the tile list are reallocated only when the size changes
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileBuffer);
+        if (f.width != texWidth || f.height != texHeight) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, f.width, f.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            texWidth = f.width;
+            texHeight = f.height;
+
+            GLuint args[4] = { 0, 1, 1, 0 };   // num_groups_x, y, z + padding, then one entry per tile
+            glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(args) + groupsX * groupsY * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(args), args);
+        }
+
+        uploadCamera(f);
+        uploadScene(f, p, cartesian);
+        uploadObjects(f, p.objects ? f.objectCount : 0);
+
+        glBindImageTexture(0, tex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, tileBuffer);
+
+        // Pass 1: num_groups_x is reset on the GPU and each mixed tile adds itself; the others are written directly
+        if (timer) timer->begin(timerTiles);
+        GLuint zero = 0;
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glUseProgram(tileProgram);
+        float camR = std::sqrt(f.camPos[0] * f.camPos[0] + f.camPos[1] * f.camPos[1] + f.camPos[2] * f.camPos[2]);
+        glUniform1i(shadowBlockedLoc, objectInnerR < camR);
+        glDispatchCompute(groupsX, groupsY, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+        if (timer) timer->end(timerTiles);
+
+        // Pass 2: RK4 over the mixed tiles only, as many groups as pass 1 counted
+        if (timer) timer->begin(timerIntegrate);
+        glUseProgram(integrateProgram);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, tileBuffer);
+        glDispatchComputeIndirect(0);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+        if (timer) timer->end(timerIntegrate);
+
+        // The dispatches were the only readers of this frame's regions
+        uboStream.endFrame();
+        objectStream.endFrame();
+
+        if (f.rgba) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, f.rgba);
+        }
+
+        static const char* const names[2][2][2] = {
+            { { "sph+tiles/glsl",  "sph+tiles+obj/glsl"  }, { "sph+tiles+disk/glsl", "sph+tiles+disk+obj/glsl" } },
+            { { "cart/glsl",       "cart+obj/glsl"       }, { "cart+disk/glsl",      "cart+disk+obj/glsl"      } },
+        };
+        return names[cartesian][p.disk][p.objects];
+    }
+
+    GLuint texture() const override { return tex; }
+
+private:
+    void uploadCamera(const CpuTracer::Frame& f) {
+        struct CameraUBO {   // std140, as the Camera block of both shaders
+            float pos[3];   float _pad0;
+            float right[3]; float _pad1;
+            float up[3];    float _pad2;
+            float fwd[3];   float _pad3;
+            float tanHalfFov, aspect;
+            int32_t moving, _pad4;
+        } data = {};
+        std::memcpy(data.pos, f.camPos, sizeof data.pos);
+        std::memcpy(data.right, f.right, sizeof data.right);
+        std::memcpy(data.up, f.up, sizeof data.up);
+        std::memcpy(data.fwd, f.fwd, sizeof data.fwd);
+        data.tanHalfFov = f.tanHFov;
+        data.aspect     = f.aspect;
+
+        GLintptr offset = uboStream.upload(&data, sizeof data, size_t(uboAlign));
+        glBindBufferRange(GL_UNIFORM_BUFFER, 1, uboStream.id(), offset, sizeof data);
+    }
+
+    void uploadScene(const CpuTracer::Frame& f, const TracePolicy& p, bool cartesian) {
+        struct SceneUBO {    // std140, as the Scene block of both shaders
+            float   diskR1, diskR2, diskNum, thickness;
+            float   rs, dLambda, escapeR;
+            int32_t maxSteps, cartesian, _pad[3];
+        } data = {};
+        if (p.disk) {
+            data.diskR1 = f.diskR1;
+            data.diskR2 = f.diskR2;
+        }
+        data.diskNum   = 2.0f;
+        data.thickness = 1e9f;
+        data.rs        = f.rs;
+        data.dLambda   = f.dLambda;
+        data.escapeR   = f.escapeR;
+        data.maxSteps  = f.maxSteps;
+        data.cartesian = cartesian;
+
+        GLintptr offset = uboStream.upload(&data, sizeof data, size_t(uboAlign));
+        glBindBufferRange(GL_UNIFORM_BUFFER, 2, uboStream.id(), offset, sizeof data);
+    }
+
+    // Objects (binding 3), their grid (4) and its indices (5).  Sent again only
+    // when the frame's objectsVersion changes, otherwise the bound ranges stay.
+    void uploadObjects(const CpuTracer::Frame& f, int count) {
+        static_assert(sizeof(CpuTracer::Sphere) == 32, "Sphere must match SceneObject (std430, 2 × vec4)");
+        if (uploaded && f.objectsVersion != 0 && f.objectsVersion == objectsVersion && count == objectCount) return;
+        uploaded       = true;
+        objectsVersion = f.objectsVersion;
+        objectCount    = count;
+
+        // For the tile pass: a captured ray never climbs back above the camera, so only objects
+        // closer to the centre than it can be hit on the way down.  The opaque black marker inside
+        // the horizon has the hole's own colour and is ignored.
+        objectInnerR = INFINITY;
+        for (int i = 0; i < count; ++i) {
+            const CpuTracer::Sphere& o = f.objects[i];
+            float d = std::sqrt(o.x * o.x + o.y * o.y + o.z * o.z);
+            bool blackMarker = d + o.radius <= f.rs * 1.001f && o.r == 0.0f && o.g == 0.0f && o.b == 0.0f && o.a == 1.0f;
+            if (!blackMarker) objectInnerR = std::min(objectInnerR, d - o.radius);
+        }
+
+        sceneGrid.build(count ? &f.objects[0].x : nullptr, size_t(count), sizeof(CpuTracer::Sphere) / sizeof(float));
+
+        // One map for [grid | objects | indices], each aligned for glBindBufferRange.
+        // A zero-sized SSBO is not allowed, hence the max.
+        const SceneGridHeader& hdr = sceneGrid.header();
+        const auto& cells   = sceneGrid.cells();
+        const auto& indices = sceneGrid.indices();
+        auto alignUp = [&](size_t n) { return (n + size_t(ssboAlign) - 1) / size_t(ssboAlign) * size_t(ssboAlign); };
+        size_t gridBytes  = sizeof(hdr) + std::max<size_t>(cells.size(), 2) * sizeof(uint32_t);
+        size_t objBytes   = size_t(std::max(count, 1)) * sizeof(CpuTracer::Sphere);
+        size_t indexBytes = std::max<size_t>(indices.size(), 1) * sizeof(uint32_t);
+        size_t objStart   = alignUp(gridBytes);
+        size_t indexStart = objStart + alignUp(objBytes);
+
+        uint8_t* dst = static_cast<uint8_t*>(objectStream.map(indexStart + indexBytes, size_t(ssboAlign)));
+        std::memset(dst, 0, indexStart + indexBytes);
+        std::memcpy(dst, &hdr, sizeof(hdr));
+        if (!cells.empty()) std::memcpy(dst + sizeof(hdr), cells.data(), cells.size() * sizeof(uint32_t));
+        if (count) std::memcpy(dst + objStart, f.objects, size_t(count) * sizeof(CpuTracer::Sphere));
+        if (!indices.empty()) std::memcpy(dst + indexStart, indices.data(), indices.size() * sizeof(uint32_t));
+        GLintptr base = objectStream.unmap();
+
+        GLuint id = objectStream.id();
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, id, base + objStart, objBytes);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, id, base, gridBytes);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 5, id, base + indexStart, indexBytes);
+    }
+
+    ShaderProgram   integrateProgram, tileProgram;
+    GLint           shadowBlockedLoc = -1;
+    GLuint          tileBuffer = 0;
+    GLuint          tex = 0;
+    int             texWidth = 0, texHeight = 0;
+    StreamingBuffer uboStream, objectStream;
+    GLint           uboAlign = 256, ssboAlign = 256;
+    SceneGrid       sceneGrid;
+    bool            uploaded = false;
+    uint64_t        objectsVersion = 0;
+    int             objectCount = 0;
+    float           objectInnerR = INFINITY;   // smallest |centre| − radius of the objects a captured ray could hit
+    GpuTimer*       timer = nullptr;
+    int             timerTiles = -1, timerIntegrate = -1;
+};
+
+inline const std::vector<TracerBackend>& All() {
+    static const std::vector<TracerBackend> table = {
+        { "cpu-scalar",  "1 thread, scalar C++ RK4",
+          [] { return true; }, [] { return std::unique_ptr<Tracer>(new Scalar); } },
+        { "cpu-simd",    "1 thread, 4-ray SIMD packets",
+          [] { return true; }, [] { return std::unique_ptr<Tracer>(new Simd); } },
+        { "cpu-threads", "SIMD packets on every core",
+          [] { return true; }, [] { return std::unique_ptr<Tracer>(new Threaded); } },
+        { "gl-compute",  "GLSL compute shaders, tile early-out (OpenGL 4.3)",
+          &GlCompute::Available, [] { return std::unique_ptr<Tracer>(new GlCompute); } },
+    };
+    return table;
+}
+
+inline const TracerBackend* Find(const std::string& name) {
+    for (const auto& b : All())
+        if (name == b.name) return &b;
+    return nullptr;
+}
+
+struct Measurement {
+    const TracerBackend* backend;
+    double raysPerSecond;
+};
+
+// Renders a width × height frame of the scene with at most maxSteps steps per
+// ray on each available backend, after one warm-up frame (thread start-up,
+// caches).  Only the ratios matter: escaping rays are cut at maxSteps.
+inline std::vector<Measurement> Calibrate(CpuTracer::Frame scene, const TracePolicy& policy,
+                                          int width = 48, int height = 36, int maxSteps = 1500) {
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    scene.width    = width;
+    scene.height   = height;
+    scene.maxSteps = maxSteps;
+    scene.rgba     = rgba.data();
+
+    std::vector<Measurement> out;
+    for (const auto& b : All()) {
+        if (!b.available()) continue;
+        std::unique_ptr<Tracer> t = b.create();
+        t->render(scene, policy);
+        auto t0 = std::chrono::steady_clock::now();
+        t->render(scene, policy);
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        out.push_back({ &b, double(width) * height / std::max(s, 1e-9) });
+    }
+    return out;
+}
+
+// Highest rays/s.  A backend later in the table must win by 5 % to replace an
+// earlier, simpler one, so timing noise does not pick the pool on one core.
+inline const TracerBackend* Fastest(const std::vector<Measurement>& m) {
+    const Measurement* best = nullptr;
+    for (const auto& x : m)
+        if (!best || x.raysPerSecond > 1.05 * best->raysPerSecond) best = &x;
+    return best ? best->backend : nullptr;
+}
+
+} // namespace TracerBackends
+
+#endif // TRACER_HPP